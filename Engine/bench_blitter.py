@@ -0,0 +1,30 @@
+import argparse
+
+import mygameengine
+
+
+def main():
+    """
+    \brief Compares the CPU SpriteRasterizer with SDL's software renderer across sprite counts.
+    """
+    parser = argparse.ArgumentParser(description="ms/frame: SDL software renderer vs SpriteRasterizer")
+    parser.add_argument("--sprites", type=int, nargs="+", default=[500, 2000, 8000])
+    parser.add_argument("--frames", type=int, default=60)
+    parser.add_argument("--threads", type=int, default=0, help="threads of the threaded run; 0 uses one per core")
+    parser.add_argument("--width", type=int, default=640)
+    parser.add_argument("--height", type=int, default=480)
+    parser.add_argument("--size", type=int, default=32, help="sprite width and height in pixels")
+    args = parser.parse_args()
+
+    header = f"{'sprites':>7} {'SDL':>9} {'scalar':>9} {'simd':>9} {'threaded':>9} {'speedup':>8} {'diff':>6}"
+    print(header)
+    for sprites in args.sprites:
+        r = mygameengine.benchmark_blitter(sprites, args.frames, args.threads, args.width, args.height, args.size)
+        print(f"{sprites:>7} {r['software_ms']:9.3f} {r['scalar_ms']:9.3f} {r['simd_ms']:9.3f} "
+              f"{r['simd_threaded_ms']:9.3f} {r['software_ms'] / r['simd_threaded_ms']:7.1f}x {r['mean_abs_difference']:6.2f}")
+    print(f"ms per frame; kernels {r['kernels']}, {r['threads']} threads; diff is the mean absolute channel "
+          "difference to SDL's pixels")
+
+
+if __name__ == "__main__":
+    main()
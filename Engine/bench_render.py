@@ -0,0 +1,93 @@
+import argparse
+import os
+import sys
+import time
+
+import numpy as np
+
+os.environ.setdefault("SDL_AUDIODRIVER", "dummy")
+
+import mygameengine
+
+
+def make_app(args):
+    """
+    \brief Creates an engine that renders offscreen at a fixed resolution.
+    """
+    app = mygameengine.Application(args.width, args.height)
+    app.dynamic_resolution = False
+    app.offscreen = True
+    if args.cpu:
+        app.set_cpu_rasterizer(True, args.threads)
+    return app
+
+
+def bench(app, frames, capture, wait):
+    """
+    \brief Renders frames one tick apart and measures the throughput.
+    \param capture Whether frames are captured and read by the caller.
+    \param wait Whether every capture waits for its frame, or takes the latest one while the next is rendered.
+    \return Frames per second.
+    """
+    app.frame_capture = capture
+    checksum = 0
+    start = time.perf_counter()
+    for _ in range(frames):
+        app.step(1, render=True)
+        if capture:
+            frame = app.capture(wait)
+            if frame is not None:
+                checksum += int(frame["pixels"][::64, ::64].sum())
+    app.capture(True)
+    return frames / (time.perf_counter() - start)
+
+
+def golden(app, path, ticks, tolerance):
+    """
+    \brief Compares the frame after a number of ticks with a saved golden image, or saves it if there is none.
+    \return True if the frame matches.
+    """
+    app.frame_capture = True
+    app.step(ticks, render=True)
+    pixels = np.array(app.capture(True)["pixels"])
+    if not os.path.exists(path):
+        np.save(path, pixels)
+        print(f"saved golden image {path} {pixels.shape}")
+        return True
+    expected = np.load(path)
+    if expected.shape != pixels.shape:
+        print(f"golden image {path} is {expected.shape}, frame is {pixels.shape}")
+        return False
+    difference = np.abs(expected.astype(np.int16) - pixels.astype(np.int16))
+    changed = np.count_nonzero(difference.max(axis=2) > tolerance)
+    print(f"golden image {path}: {changed} pixels differ by more than {tolerance}, max difference {difference.max()}")
+    return changed == 0
+
+
+def main():
+    """
+    \brief Measures offscreen render throughput with and without frame capture, or checks a golden image.
+    """
+    parser = argparse.ArgumentParser(description="Offscreen frames/sec and golden-image checks")
+    parser.add_argument("--frames", type=int, default=600)
+    parser.add_argument("--width", type=int, default=640)
+    parser.add_argument("--height", type=int, default=480)
+    parser.add_argument("--cpu", action="store_true", help="render with the CPU rasterizer, without SDL")
+    parser.add_argument("--threads", type=int, default=0, help="threads of the CPU rasterizer; 0 uses one per core")
+    parser.add_argument("--golden", help="compare the frame after --ticks ticks with this .npy file, saving it if missing")
+    parser.add_argument("--ticks", type=int, default=120)
+    parser.add_argument("--tolerance", type=int, default=0, help="largest channel difference still matching")
+    args = parser.parse_args()
+
+    app = make_app(args)
+    if args.golden:
+        sys.exit(0 if golden(app, args.golden, args.ticks, args.tolerance) else 1)
+
+    bench(app, 30, False, True)
+    for label, capture, wait in (("render only", False, True), ("capture, blocking", True, True),
+                                 ("capture, pipelined", True, False)):
+        print(f"{label:20} {bench(app, args.frames, capture, wait):9.1f} frames/s")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,25 @@
+import argparse
+
+import mygameengine
+
+
+def main():
+    """
+    \brief Compares resource lookups in the sharded ResourceIndex with a locked map, across thread counts.
+    """
+    parser = argparse.ArgumentParser(
+        description="Lookups/sec under a concurrent writer: ResourceIndex vs mutex vs shared_mutex")
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    parser.add_argument("--lookups", type=int, default=1000000, help="lookups per thread")
+    parser.add_argument("--keys", type=int, default=256)
+    args = parser.parse_args()
+
+    print(f"{'threads':>7} {'index':>12} {'mutex':>12} {'shared_mutex':>13}   (million lookups/s)")
+    for threads in args.threads:
+        result = mygameengine.benchmark_resource_lookups(threads, args.lookups, args.keys)
+        print(f"{threads:>7} {result['index_lookups_per_s'] / 1e6:12.1f} "
+              f"{result['mutex_lookups_per_s'] / 1e6:12.1f} {result['shared_mutex_lookups_per_s'] / 1e6:13.1f}")
+
+
+if __name__ == "__main__":
+    main()
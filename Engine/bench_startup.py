@@ -0,0 +1,80 @@
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+
+# Runs in a fresh interpreter per sample, so nothing of an earlier start is cached in the process
+CHILD = """
+import time
+start = time.perf_counter()
+import mygameengine
+app = mygameengine.Application(640, 480)
+print(app.startup_ms, (time.perf_counter() - start) * 1000.0)
+"""
+
+
+def drop_page_cache():
+    """
+    \brief Evicts file data from the OS page cache so the next start reads assets from disk.
+    \return True if the cache was dropped; that needs root on Linux and sudo for purge on macOS.
+    """
+    try:
+        if sys.platform.startswith("linux"):
+            os.sync()
+            with open("/proc/sys/vm/drop_caches", "w") as f:
+                f.write("3\n")
+            return True
+        if sys.platform == "darwin":
+            return subprocess.run(["purge"], capture_output=True).returncode == 0
+    except OSError:
+        pass
+    return False
+
+
+def start(pack, cold):
+    """
+    \brief Starts the engine once in a child process.
+    \param pack The pack to mount, or "" for loose files.
+    \param cold Whether to drop the page cache first.
+    \return The engine's own startup time and the whole process startup time, in milliseconds.
+    """
+    if cold:
+        drop_page_cache()
+    env = dict(os.environ, GAMEENGINE_ASSET_PACK=pack)
+    env.setdefault("SDL_VIDEODRIVER", "dummy")
+    env.setdefault("SDL_RENDER_DRIVER", "software")
+    env.setdefault("SDL_AUDIODRIVER", "dummy")
+    output = subprocess.run([sys.executable, "-c", CHILD], env=env, capture_output=True, text=True, check=True).stdout
+    engine_ms, process_ms = output.split()[-2:]
+    return float(engine_ms), float(process_ms)
+
+
+def main():
+    """
+    \brief Compares engine startup from the memory-mapped asset pack with startup from loose files.
+    """
+    parser = argparse.ArgumentParser(description="Cold and warm startup: asset pack vs loose files")
+    parser.add_argument("--pack", default="assets.pack", help="pack written by pack_assets.py")
+    parser.add_argument("--runs", type=int, default=10)
+    args = parser.parse_args()
+
+    if not os.path.exists(args.pack):
+        sys.exit(f"{args.pack} not found; build it with: python3 pack_assets.py --output {args.pack}")
+
+    can_drop = drop_page_cache()
+    if not can_drop:
+        print("cannot drop the page cache (needs root); cold runs are skipped")
+
+    for mode in ("warm", "cold") if can_drop else ("warm",):
+        print(f"{mode} start, median of {args.runs} runs:")
+        for label, pack in (("loose files", ""), ("asset pack", args.pack)):
+            start(pack, False)
+            samples = [start(pack, mode == "cold") for _ in range(args.runs)]
+            engine = statistics.median(s[0] for s in samples)
+            process = statistics.median(s[1] for s in samples)
+            print(f"  {label:12} engine {engine:8.2f} ms   process {process:8.2f} ms")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,49 @@
+import argparse
+import time
+
+import numpy as np
+
+import mygameengine
+
+
+def bench(num_envs, num_threads, steps, ticks):
+    """
+    \brief Measures the throughput of a VectorEnv.
+    \param num_envs The number of environments.
+    \param num_threads The number of threads stepping them.
+    \param steps The number of batched steps to time.
+    \param ticks The number of ticks per step.
+    \return Environment ticks simulated per second.
+    """
+    env = mygameengine.VectorEnv(num_envs, 0, num_threads)
+    rng = np.random.default_rng(0)
+    actions = rng.integers(0, 8, size=(steps, num_envs), dtype=np.uint8)
+    env.reset()
+    env.step(actions[0], ticks)
+
+    start = time.perf_counter()
+    for i in range(steps):
+        env.step(actions[i], ticks)
+    elapsed = time.perf_counter() - start
+    return num_envs * steps * ticks / elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Env-steps/sec of VectorEnv across thread counts")
+    parser.add_argument("--envs", type=int, default=256)
+    parser.add_argument("--steps", type=int, default=500)
+    parser.add_argument("--ticks", type=int, default=4)
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    args = parser.parse_args()
+
+    baseline = None
+    for threads in args.threads:
+        rate = bench(args.envs, threads, args.steps, args.ticks)
+        baseline = baseline or rate
+        print(f"{threads:3d} threads: {rate:12.0f} env-steps/s "
+              f"({rate / baseline:5.2f}x)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,325 @@
+#pragma once
+#include "ConfigManager.h"
+#include "SceneSnapshot.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \struct AnimationClip
+ * \brief A run of equally sized frames in a spritesheet, laid out left to right and top to bottom.
+ */
+struct AnimationClip
+{
+    SDL_Rect firstFrame{0, 0, 0, 0}; //!< Position and size of the first frame in the sheet.
+    Uint16 frameCount{1};
+    Uint16 columns{1};               //!< Frames per row before wrapping to the next row.
+    float frameDuration{0.1f};       //!< Seconds each frame is shown.
+    bool loop{true};                 //!< Whether the clip restarts after its last frame or holds it.
+};
+
+/*!
+ * \class AnimationSystem
+ * \brief The AnimationSystem plays spritesheet clips for many sprites and advances all of them in one pass.
+ *
+ * Clips are loaded once per texture from a sidecar file next to it, e.g. "assets/hero.anim" for "assets/hero.bmp", in
+ * the key=value format of ConfigManager:
+ *
+ *     run_x=0        run_y=32       run_w=32       run_h=32
+ *     run_frames=6   run_columns=6  run_fps=12     run_loop=1
+ *
+ * A clip is defined by its "<name>_frames" key; the other keys default to 0 (x, y), one row (columns), 10 fps and
+ * looping. The playback state of every sprite lives in parallel arrays indexed by a player handle, and Update writes
+ * the source rect of each player whose frame changed. Sprites only read their source rect when recording a draw.
+ */
+class AnimationSystem
+{
+public:
+    static constexpr Uint16 kNoClip = 0xFFFF;
+
+    /*!
+     * \brief Loads the clips of a texture from its sidecar file. Loading the same texture again does nothing.
+     * \param texturePath The path of the spritesheet texture.
+     * \return The number of clips defined for the texture; 0 if there is no sidecar file.
+     */
+    size_t LoadClips(const std::string &texturePath)
+    {
+        auto loaded = mLoadedTextures.find(texturePath);
+        if (loaded != mLoadedTextures.end())
+        {
+            return loaded->second;
+        }
+
+        ConfigManager configManager;
+        std::unordered_map<std::string, int> config = configManager.LoadConfig(GetSidecarPath(texturePath));
+        const std::string suffix = "_frames";
+        std::vector<std::string> names;
+        for (const auto &entry : config)
+        {
+            const std::string &key = entry.first;
+            if (key.size() > suffix.size() && key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0)
+            {
+                names.push_back(key.substr(0, key.size() - suffix.size()));
+            }
+        }
+        // The map is unordered; sort so clip indices do not depend on hashing
+        std::sort(names.begin(), names.end());
+
+        for (const std::string &name : names)
+        {
+            auto value = [&](const char *field, int fallback)
+            {
+                auto it = config.find(name + "_" + field);
+                return it != config.end() ? it->second : fallback;
+            };
+            AnimationClip clip;
+            clip.firstFrame = SDL_Rect{value("x", 0), value("y", 0), value("w", 0), value("h", 0)};
+            clip.frameCount = static_cast<Uint16>(std::max(1, value("frames", 1)));
+            clip.columns = static_cast<Uint16>(std::max(1, value("columns", clip.frameCount)));
+            clip.frameDuration = 1.0f / static_cast<float>(std::max(1, value("fps", 10)));
+            clip.loop = value("loop", 1) != 0;
+            AddClip(texturePath, name, clip);
+        }
+        mLoadedTextures[texturePath] = names.size();
+        return names.size();
+    }
+
+    /*!
+     * \brief Adds or replaces a clip of a texture.
+     * \param texturePath The path of the spritesheet texture.
+     * \param name The clip name.
+     * \param clip The clip.
+     * \return The clip index.
+     */
+    Uint16 AddClip(const std::string &texturePath, const std::string &name, const AnimationClip &clip)
+    {
+        std::string key = texturePath + "#" + name;
+        auto it = mClipIndices.find(key);
+        if (it != mClipIndices.end())
+        {
+            mClips[it->second] = clip;
+            return it->second;
+        }
+        Uint16 index = static_cast<Uint16>(mClips.size());
+        mClips.push_back(clip);
+        mClipIndices.emplace(key, index);
+        return index;
+    }
+
+    /*!
+     * \brief Looks up a clip by texture and name.
+     * \return The clip index, or kNoClip if the texture has no such clip.
+     */
+    Uint16 FindClip(const std::string &texturePath, const std::string &name) const
+    {
+        auto it = mClipIndices.find(texturePath + "#" + name);
+        return it != mClipIndices.end() ? it->second : kNoClip;
+    }
+
+    /*!
+     * \brief Gets a clip by index.
+     */
+    const AnimationClip &GetClip(Uint16 clip) const
+    {
+        return mClips[clip];
+    }
+
+    /*!
+     * \brief Creates the playback state of one sprite.
+     * \param clip The clip to start playing; kNoClip to start idle.
+     * \return A handle to the player.
+     */
+    Uint32 CreatePlayer(Uint16 clip = kNoClip)
+    {
+        Uint32 player;
+        if (!mFreePlayers.empty())
+        {
+            player = mFreePlayers.back();
+            mFreePlayers.pop_back();
+        }
+        else
+        {
+            player = static_cast<Uint32>(mClip.size());
+            mClip.push_back(kNoClip);
+            mFrame.push_back(0);
+            mTime.push_back(0.0f);
+            mSpeed.push_back(1.0f);
+            mSource.push_back(SDL_Rect{0, 0, 0, 0});
+        }
+        mSpeed[player] = 1.0f;
+        Play(player, clip, true);
+        return player;
+    }
+
+    /*!
+     * \brief Destroys a player; its handle may be reused by the next CreatePlayer.
+     */
+    void DestroyPlayer(Uint32 player)
+    {
+        mClip[player] = kNoClip;
+        mSource[player] = SDL_Rect{0, 0, 0, 0};
+        mFreePlayers.push_back(player);
+    }
+
+    /*!
+     * \brief Switches a player to a clip.
+     * \param player The player.
+     * \param clip The clip; kNoClip stops the player and clears its source rect.
+     * \param restart If false and the clip is already playing, it continues where it is.
+     */
+    void Play(Uint32 player, Uint16 clip, bool restart = false)
+    {
+        if (clip == mClip[player] && !restart)
+        {
+            return;
+        }
+        mClip[player] = clip;
+        mFrame[player] = 0;
+        mTime[player] = 0.0f;
+        mSource[player] = clip == kNoClip ? SDL_Rect{0, 0, 0, 0} : mClips[clip].firstFrame;
+    }
+
+    /*!
+     * \brief Sets the playback speed of a player; 1 is normal speed and 0 pauses.
+     */
+    void SetSpeed(Uint32 player, float speed)
+    {
+        mSpeed[player] = speed;
+    }
+
+    /*!
+     * \brief Gets the clip a player is playing, or kNoClip.
+     */
+    Uint16 GetClip(Uint32 player) const
+    {
+        return mClip[player];
+    }
+
+    /*!
+     * \brief Gets the frame a player is showing, counted from the start of its clip.
+     */
+    Uint16 GetFrame(Uint32 player) const
+    {
+        return mFrame[player];
+    }
+
+    /*!
+     * \brief Checks whether a non-looping clip reached its last frame.
+     */
+    bool IsFinished(Uint32 player) const
+    {
+        Uint16 clip = mClip[player];
+        return clip != kNoClip && !mClips[clip].loop && mFrame[player] + 1 >= mClips[clip].frameCount;
+    }
+
+    /*!
+     * \brief Gets the part of the spritesheet a player shows. Empty (w == 0) if it plays no clip, meaning the whole
+     * texture.
+     */
+    const SDL_Rect &GetSource(Uint32 player) const
+    {
+        return mSource[player];
+    }
+
+    /*!
+     * \brief Advances every player and updates the source rects of those whose frame changed.
+     * \param deltaTime The time since the last update.
+     */
+    void Update(float deltaTime)
+    {
+        size_t count = mClip.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            Uint16 clipIndex = mClip[i];
+            if (clipIndex == kNoClip)
+            {
+                continue;
+            }
+            const AnimationClip &clip = mClips[clipIndex];
+            float time = mTime[i] + deltaTime * mSpeed[i];
+            if (time < clip.frameDuration)
+            {
+                mTime[i] = time;
+                continue;
+            }
+
+            // Large steps may skip several frames at once
+            float steps = std::floor(time / clip.frameDuration);
+            time -= steps * clip.frameDuration;
+            Uint32 frame = mFrame[i] + static_cast<Uint32>(steps);
+            if (frame >= clip.frameCount)
+            {
+                if (clip.loop)
+                {
+                    frame %= clip.frameCount;
+                }
+                else
+                {
+                    frame = clip.frameCount - 1u;
+                    time = 0.0f;
+                }
+            }
+            mTime[i] = time;
+            if (frame == mFrame[i])
+            {
+                continue;
+            }
+            mFrame[i] = static_cast<Uint16>(frame);
+            mSource[i].x = clip.firstFrame.x + static_cast<int>(frame % clip.columns) * clip.firstFrame.w;
+            mSource[i].y = clip.firstFrame.y + static_cast<int>(frame / clip.columns) * clip.firstFrame.h;
+        }
+    }
+
+    /*!
+     * \brief Appends the playback state of every player to a snapshot. Clips are not saved.
+     */
+    void Save(SceneSnapshot &snapshot) const
+    {
+        snapshot.WriteArray(mClip);
+        snapshot.WriteArray(mFrame);
+        snapshot.WriteArray(mTime);
+        snapshot.WriteArray(mSpeed);
+        snapshot.WriteArray(mSource);
+        snapshot.WriteArray(mFreePlayers);
+    }
+
+    /*!
+     * \brief Restores the state saved by Save, into a system with the same clips.
+     * \return False if the snapshot is malformed.
+     */
+    bool Restore(SnapshotReader &reader)
+    {
+        return reader.ReadArray(mClip) && reader.ReadArray(mFrame) && reader.ReadArray(mTime) && reader.ReadArray(mSpeed) &&
+               reader.ReadArray(mSource) && reader.ReadArray(mFreePlayers) && mFrame.size() == mClip.size() &&
+               mTime.size() == mClip.size() && mSpeed.size() == mClip.size() && mSource.size() == mClip.size();
+    }
+
+private:
+    /*!
+     * \brief Gets the path of the clip file of a texture: the texture path with its extension replaced by ".anim".
+     */
+    static std::string GetSidecarPath(const std::string &texturePath)
+    {
+        size_t dot = texturePath.find_last_of('.');
+        size_t slash = texturePath.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        {
+            return texturePath + ".anim";
+        }
+        return texturePath.substr(0, dot) + ".anim";
+    }
+
+    std::vector<AnimationClip> mClips;
+    std::unordered_map<std::string, Uint16> mClipIndices;
+    std::unordered_map<std::string, size_t> mLoadedTextures;
+
+    std::vector<Uint16> mClip;
+    std::vector<Uint16> mFrame;
+    std::vector<float> mTime;
+    std::vector<float> mSpeed;
+    std::vector<SDL_Rect> mSource;
+    std::vector<Uint32> mFreePlayers;
+};
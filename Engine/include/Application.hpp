@@ -1,16 +1,34 @@
 #pragma once
 #include "Component.h"
 #include "ResourceManager.h"
-#include "EnemyGameEntity.h"
+#include "AudioMixer.h"
 #include "PlayerGameEntity.h"
 #include "SpriteComponent.h"
 #include "SceneManager.h"
 #include "Level1Scene.h"
+#include "Logger.h"
+#include "FrameProfiler.h"
+#include "PerfOverlay.h"
+#include "RenderThread.h"
+#include "ResolutionScaler.h"
 #include <SDL2/SDL.h>
 #include <cstdlib>
 #include <vector>
 #include <memory>
 
+/*!
+ *  \struct StepOutputs
+ *  \brief Caller-owned arrays that Application::Step writes one entry per tick into. Any pointer may be null.
+ */
+struct StepOutputs
+{
+    float *player = nullptr; //!< Player x, y per tick (2 floats per tick).
+    float *score = nullptr;  //!< Score after the tick.
+    float *reward = nullptr; //!< Score gained during the tick.
+    Uint8 *win = nullptr;    //!< 1 if the level was won during or before the tick.
+    Uint8 *lose = nullptr;   //!< 1 if the player died during or before the tick.
+};
+
 /*!
  *  \class Application
  *  \brief The Application class is responsible for initializing, running, and shutting down the game application.
@@ -27,11 +45,15 @@ public:
      *  \param h The height of the game window.
      *
      *  This constructor initializes SDL, creates the game window and renderer, and switches to the initial game scene.
+     *  The time all of this takes, including loading the first scene's assets, is kept for GetStartupMs.
      */
     Application(int w, int h)
     {
+        Uint64 start = SDL_GetPerformanceCounter();
         StartUp(w, h);
         sceneManager.SwitchScene(std::make_unique<Level1Scene>(mRenderer, mWindow));
+        renderThread.Flush();
+        mStartupMs = static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
     }
     /*!
      *  \brief Destructor that shuts down the game application.
@@ -48,41 +70,70 @@ public:
      *  \param w The width of the game window.
      *  \param h The height of the game window.
      *
-     *  This method initializes SDL and sets up the game window and renderer. If SDL cannot be initialized or the renderer cannot be created, it logs an error.
+     *  This method initializes SDL and sets up the game window. The renderer is created on, and owned by, the render thread.
+     *  If SDL cannot be initialized or the renderer cannot be created, it logs an error. Assets are served from the pack
+     *  "assets.pack" if it exists; the environment variable GAMEENGINE_ASSET_PACK names another pack, or loose files
+     *  only when it is empty.
      */
     void StartUp(int w, int h)
     {
+        Logger::GetInstance().StartUp();
         if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0)
         {
-            SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
+            LOG_ERROR("Unable to initialize SDL: %s", SDL_GetError());
         }
         // Create our window
         mWindow = SDL_CreateWindow("Food chain", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, w, h, 0);
-        mRenderer = SDL_CreateRenderer(mWindow, NULL, SDL_RENDERER_ACCELERATED);
+        mRenderer = renderThread.StartUp(mWindow, SDL_RENDERER_ACCELERATED);
         if (nullptr == mRenderer)
         {
-            SDL_Log("Error creating renderer");
+            LOG_ERROR("Error creating renderer");
+        }
+        ResourceManager::GetInstance().SetRenderThread(&renderThread);
+        const char *packPath = std::getenv("GAMEENGINE_ASSET_PACK");
+        if (packPath == nullptr)
+        {
+            packPath = "assets.pack";
+        }
+        if (*packPath != '\0' && !ResourceManager::GetInstance().MountPack(packPath))
+        {
+            LOG_INFO("No asset pack at %s, loading loose files", packPath);
         }
+        AudioMixer::GetInstance().StartUp();
+        mWidth = w;
+        overlay.Load(mRenderer);
     }
 
     /*!
      *  \brief Shuts down the game application, releasing all resources.
      *
-     *  This method deallocates all allocated resources, destroys the game window, and quits SDL.
+     *  This method stops the audio mixer, waits for the render thread to finish, deallocates all allocated resources,
+     *  stops the render thread, destroys the game window, quits SDL and flushes the logger.
      */
     void Shutdown()
     {
+        AudioMixer::GetInstance().ShutDown();
+        renderThread.Flush();
         ResourceManager &manager = ResourceManager::GetInstance();
+        PrototypeRegistry::GetInstance().Clear();
         manager.ShutDown();
+        manager.SetRenderThread(nullptr);
+        renderThread.ShutDown();
         SDL_DestroyWindow(mWindow);
         SDL_Quit();
+        Logger::GetInstance().ShutDown();
     }
 
     /*!
      *  \brief Runs the main loop of the game application.
      *  \param targetFPS The target frames per second (FPS) the game tries to maintain.
      *
-     *  This method runs the game's main loop, which includes updating the game state, handling input, rendering, and regulating the game's frame rate.
+     *  This method runs the game's main loop, which includes handling input, updating the game state, rendering, and regulating the game's frame rate.
+     *  The frame-cap sleep happens at the start of a frame, before input is sampled, so that input is read as late as
+     *  possible and is applied in the same frame's update and present. Rendering only records a frame packet; drawing
+     *  and presenting happen on the render thread while the next frame is simulated. F3 shows or hides the perf overlay.
+     *  The render time of every presented frame drives the dynamic resolution, whose budget defaults to the frame time
+     *  of targetFPS.
      */
     void Loop(float targetFPS)
     {
@@ -92,35 +143,63 @@ public:
 
         // Record our 'starting time'
         lastTime = SDL_GetTicks();
-        Uint64 framesElapsed = 0;
         float deltaTime = 1.0f / targetFPS;
+        double frameMs = 1000.0 / targetFPS;
+        double nextFrame = static_cast<double>(SDL_GetTicks());
+        if (scaler.GetBudget() <= 0.0)
+        {
+            scaler.SetBudget(frameMs);
+        }
         while (sceneManager.GetCurrentScene()->IsCompleted() == false)
         {
-            Uint64 startOfFrame = SDL_GetTicks();
-            // We want, input/update/render to take 16ms
-            sceneManager.Update(deltaTime);
+            // Insert a 'frame cap' so that our program
+            // does not run too fast. Sleeping before sampling input keeps the sleep
+            // out of the input-to-present path.
+            double sleptMs = 0.0;
+            double now = static_cast<double>(SDL_GetTicks());
+            if (now < nextFrame)
+            {
+                sleptMs = nextFrame - now;
+                SDL_Delay(static_cast<Uint32>(sleptMs));
+            }
+            nextFrame = std::max(nextFrame, now) + frameMs;
+
+            profiler.BeginFrame(sleptMs);
             sceneManager.HandleInput(deltaTime);
-            sceneManager.Render();
-            Uint64 elapsedTime = SDL_GetTicks() - startOfFrame;
-            framesElapsed++;
+            bool toggleDown = SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_F3] != 0;
+            if (toggleDown && !mOverlayKeyDown)
+            {
+                overlay.SetVisible(!overlay.IsVisible());
+            }
+            mOverlayKeyDown = toggleDown;
+            profiler.MarkInputSampled(sceneManager.GetCurrentScene()->GetInputTimestamp());
+            sceneManager.Update(deltaTime);
 
-            // Time keeping code - for frames elapsed
-            currentTime = SDL_GetTicks();
-            // Insert a 'frame cap' so that our program
-            // does not run too fast.
-            if (elapsedTime < (1000 / targetFPS))
+            // Record this frame while the render thread is still drawing the previous one
+            FramePacket &packet = renderThread.BeginFrame();
+            profiler.FillTiming(packet.timing);
+            packet.SetRenderScale(scaler.GetScale());
+            sceneManager.Render(packet);
+            RenderOverlay(packet);
+            renderThread.Submit();
+            profiler.MarkSubmitted();
+            overlay.AddFrame(profiler.GetLastFrameMs());
+
+            FrameTiming presented;
+            if (renderThread.TakePresentedTiming(presented))
             {
-                Uint64 delay = (1000 / targetFPS) - elapsedTime;
-                SDL_Delay(delay);
-                //                SDL_Log("elaspedTime: %li",elapsedTime);
-                //                SDL_Log("delaying by: %li",delay);
+                profiler.MarkPresented(presented);
+                scaler.AddSample(presented.renderMs);
             }
-            // If 1 second passes,              enemies[i]->report how many frames
-            // have been executed.
+
+            // Time keeping code - if 1 second passes, report
+            // how many frames have been executed.
+            currentTime = SDL_GetTicks();
             if (currentTime > lastTime + 1000)
             {
-                deltaTime = 1.0f / framesElapsed;
-                framesElapsed = 0;
+                Uint64 frames = profiler.Report();
+                overlay.SetFps(frames);
+                deltaTime = 1.0f / frames;
                 lastTime = SDL_GetTicks();
             }
             if (sceneManager.GetCurrentScene()->IsWin())
@@ -134,14 +213,315 @@ public:
         }
     }
 
+    /*!
+     *  \brief Advances the current level by a number of fixed ticks, driven by scripted actions.
+     *  \param ticks The number of ticks to simulate.
+     *  \param render Whether to record and submit a frame after every tick.
+     *  \param deltaTime The length of a tick in seconds.
+     *  \param actions Player actions (PlayerActionFlags), one per tick; a single action is repeated for all ticks.
+     *  \param actionCount The number of actions: 0, 1 or ticks.
+     *  \param outputs Where to write the observations of each tick.
+     *  \return The number of ticks simulated; fewer than requested if the level was won or lost.
+     *
+     *  Unlike Loop, this neither polls SDL events nor sleeps, so it runs as fast as the simulation allows. Without
+     *  rendering it does not touch SDL at all and may be called with the Python GIL released.
+     */
+    int Step(int ticks, bool render, float deltaTime, const Uint8 *actions, size_t actionCount, const StepOutputs &outputs)
+    {
+        BaseScene *scene = dynamic_cast<BaseScene *>(sceneManager.GetCurrentScene());
+        if (scene == nullptr)
+        {
+            return 0;
+        }
+
+        int tick = 0;
+        for (; tick < ticks && !scene->IsCompleted(); tick++)
+        {
+            Uint8 action = PLAYER_ACTION_NONE;
+            if (actionCount > 0)
+            {
+                action = actions[actionCount == 1 ? 0 : tick];
+            }
+
+            float scoreBefore = scene->GetScore();
+            scene->Step(deltaTime, action);
+            if (render)
+            {
+                FramePacket &packet = renderThread.BeginFrame();
+                packet.SetRenderScale(scaler.GetScale());
+                sceneManager.Render(packet);
+                renderThread.Submit();
+            }
+
+            if (outputs.player)
+            {
+                SDL_FRect player = scene->GetPlayerRectangle();
+                outputs.player[2 * tick] = player.x;
+                outputs.player[2 * tick + 1] = player.y;
+            }
+            if (outputs.score)
+            {
+                outputs.score[tick] = scene->GetScore();
+            }
+            if (outputs.reward)
+            {
+                outputs.reward[tick] = scene->GetScore() - scoreBefore;
+            }
+            if (outputs.win)
+            {
+                outputs.win[tick] = scene->IsWin() ? 1 : 0;
+            }
+            if (outputs.lose)
+            {
+                outputs.lose[tick] = scene->IsLost() ? 1 : 0;
+            }
+        }
+        return tick;
+    }
+
+    /*!
+     *  \brief Restarts the current level, e.g. after the player lost.
+     *
+     *  The level's state is restored from the snapshot taken when it was loaded; call Loop again to keep playing.
+     */
+    void Restart()
+    {
+        sceneManager.RestartLevel();
+    }
+
+    /*!
+     *  \brief Gets an instance group of the current scene.
+     *  \param group "enemy" or "food".
+     *  \return The instance list, or nullptr if the group or the scene does not exist.
+     */
+    SpriteInstances *GetInstances(const std::string &group)
+    {
+        BaseScene *scene = dynamic_cast<BaseScene *>(sceneManager.GetCurrentScene());
+        return scene ? scene->GetInstances(group) : nullptr;
+    }
+
+    /*!
+     *  \brief Gets the scene graph of the current scene.
+     *  \return The scene graph, or nullptr if there is no scene.
+     */
+    SceneGraph *GetSceneGraph()
+    {
+        BaseScene *scene = dynamic_cast<BaseScene *>(sceneManager.GetCurrentScene());
+        return scene ? &scene->GetSceneGraph() : nullptr;
+    }
+
+    /*!
+     *  \brief Gets the prototype index new instances of a group of the current scene are spawned with.
+     *  \param group "enemy" or "food".
+     *  \return The prototype index, or -1 if the group or the scene does not exist.
+     */
+    int GetGroupPrototype(const std::string &group) const
+    {
+        const BaseScene *scene = dynamic_cast<const BaseScene *>(sceneManager.GetCurrentScene());
+        return scene ? scene->GetGroupPrototype(group) : -1;
+    }
+
+    /*!
+     *  \brief Gets the particle effects of the current scene.
+     *  \return The particle system, or nullptr if there is no scene.
+     */
+    ParticleSystem *GetParticles()
+    {
+        BaseScene *scene = dynamic_cast<BaseScene *>(sceneManager.GetCurrentScene());
+        return scene ? &scene->GetParticles() : nullptr;
+    }
+
+    /*!
+     *  \brief Gets the index of a particle emitter of the current scene.
+     *  \param name "pickup" or "death".
+     *  \return The emitter index, or -1 if the emitter or the scene does not exist.
+     */
+    int GetEmitter(const std::string &name) const
+    {
+        const BaseScene *scene = dynamic_cast<const BaseScene *>(sceneManager.GetCurrentScene());
+        return scene ? scene->GetEmitter(name) : -1;
+    }
+
+    /*!
+     *  \brief Shows or hides the perf overlay: fps, a frame-time graph and entity and draw-call counts.
+     */
+    void SetPerfOverlay(bool visible)
+    {
+        overlay.SetVisible(visible);
+    }
+
+    /*!
+     *  \brief Checks whether the perf overlay is shown.
+     */
+    bool IsPerfOverlayVisible() const
+    {
+        return overlay.IsVisible();
+    }
+
+    /*!
+     *  \brief Gets the milliseconds the constructor took to start the engine and load the first scene.
+     */
+    double GetStartupMs() const
+    {
+        return mStartupMs;
+    }
+
+    /*!
+     *  \brief Sets the render time per frame that the dynamic resolution holds.
+     *  \param budgetMs Milliseconds of render thread time per frame; 0 uses the frame time of the loop's target FPS.
+     */
+    void SetRenderBudget(double budgetMs)
+    {
+        scaler.SetBudget(budgetMs);
+    }
+
+    /*!
+     *  \brief Gets the render time budget in milliseconds; 0 until set or until the loop starts.
+     */
+    double GetRenderBudget() const
+    {
+        return scaler.GetBudget();
+    }
+
+    /*!
+     *  \brief Turns dynamic resolution on or off. Off, the scene is rendered at the highest allowed scale.
+     */
+    void SetDynamicResolution(bool enabled)
+    {
+        scaler.SetEnabled(enabled);
+    }
+
+    /*!
+     *  \brief Checks whether dynamic resolution is on.
+     */
+    bool IsDynamicResolution() const
+    {
+        return scaler.IsEnabled();
+    }
+
+    /*!
+     *  \brief Sets the range of the render scale; equal limits fix it.
+     *  \param minScale The lowest fraction of the window's resolution.
+     *  \param maxScale The highest fraction, at most 1.
+     */
+    void SetRenderScaleLimits(float minScale, float maxScale)
+    {
+        scaler.SetLimits(minScale, maxScale);
+    }
+
+    /*!
+     *  \brief Gets the fraction of the window's resolution the scene is currently rendered at.
+     */
+    float GetRenderScale() const
+    {
+        return scaler.GetScale();
+    }
+
+    /*!
+     *  \brief Gets the smoothed render thread time per frame in milliseconds.
+     */
+    double GetRenderMs() const
+    {
+        return scaler.GetAverageMs();
+    }
+
+    /*!
+     *  \brief Rasterizes the scene layer on the CPU with the SpriteRasterizer instead of SDL's renderer.
+     *  \param enabled Whether to use the CPU rasterizer, e.g. on machines without a GPU.
+     *  \param threads The threads it rasterizes with; 0 uses one per core.
+     */
+    void SetCpuRasterizer(bool enabled, size_t threads = 0)
+    {
+        renderThread.SetCpuRasterizer(enabled, threads);
+    }
+
+    /*!
+     *  \brief Checks whether the scene layer is rasterized on the CPU.
+     */
+    bool IsCpuRasterizer() const
+    {
+        return renderThread.IsCpuRasterizer();
+    }
+
+    /*!
+     *  \brief Turns capturing every rendered frame on or off, for CaptureFrame.
+     */
+    void SetFrameCapture(bool enabled)
+    {
+        renderThread.SetFrameCapture(enabled);
+    }
+
+    /*!
+     *  \brief Checks whether rendered frames are captured.
+     */
+    bool IsFrameCapture() const
+    {
+        return renderThread.IsFrameCapture();
+    }
+
+    /*!
+     *  \brief Turns presenting frames to the window off or on, e.g. to measure render throughput without a display.
+     *
+     *  Combined with the CPU rasterizer, frames are drawn entirely in memory.
+     */
+    void SetOffscreen(bool offscreen)
+    {
+        renderThread.SetOffscreen(offscreen);
+    }
+
+    /*!
+     *  \brief Checks whether frames are rendered without being presented.
+     */
+    bool IsOffscreen() const
+    {
+        return renderThread.IsOffscreen();
+    }
+
+    /*!
+     *  \brief Gets the most recently captured frame.
+     *  \param wait Whether to wait for the last submitted frame. Without waiting the simulation keeps running ahead
+     *  while the render thread draws and reads back, and the frame returned is usually the one before.
+     *  \return The frame, or nullptr if frame capture is off or nothing was rendered since it was turned on.
+     */
+    std::shared_ptr<const CapturedFrame> CaptureFrame(bool wait)
+    {
+        if (wait)
+        {
+            renderThread.Flush();
+        }
+        return renderThread.GetCapturedFrame();
+    }
+
 private:
-    // Enemy sprites
-    std::vector<std::unique_ptr<EnemyGameEntity>> enemies;
-    // Main Character
-    std::unique_ptr<PlayerGameEntity> mainCharacter;
+    /*!
+     *  \brief Updates the overlay counts from the recorded frame and records the overlay on top of it.
+     */
+    void RenderOverlay(FramePacket &packet)
+    {
+        if (!overlay.IsVisible())
+        {
+            return;
+        }
+        BaseScene *scene = dynamic_cast<BaseScene *>(sceneManager.GetCurrentScene());
+        size_t entities = scene ? scene->GetEntityCount() : 0;
+        size_t particles = scene ? scene->GetParticles().GetLiveCount() : 0;
+        // Every sprite is one copy and every batch one geometry call, counting the overlay's own batch and the upscale
+        size_t drawCalls = packet.GetSprites().size() + packet.GetBatches().size() + (packet.GetRenderScale() < 1.0f ? 2 : 1);
+        overlay.SetCounts(entities, particles, drawCalls, packet.GetRenderScale());
+        packet.BeginOverlay();
+        overlay.Render(packet, mWidth - PerfOverlay::GetWidth() - 8.0f, 8.0f);
+    }
+
     SceneManager sceneManager;
+    FrameProfiler profiler;
+    PerfOverlay overlay;
+    ResolutionScaler scaler;
+    RenderThread renderThread;
     bool mRun{true};
     float mPoints{0.0f};
+    int mWidth{0};
+    double mStartupMs{0.0};
+    bool mOverlayKeyDown{false};
     SDL_Window *mWindow;
     SDL_Renderer *mRenderer;
 };
@@ -0,0 +1,147 @@
+#pragma once
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+/*!
+ * \class AssetPack
+ * \brief Gives read access to the files of a single asset pack, mapped into memory once at startup.
+ *
+ * A pack is written by pack_assets.py. It starts with a header and an open-addressing hash table of entries keyed by
+ * the FNV-1a hash of the normalized file name (lowercase, forward slashes), followed by the names and the file
+ * contents. Every content blob starts on a kAlignment boundary and is stored either as is or as an LZ4 block.
+ *
+ * Mount maps the whole file read-only, so opening an entry costs a hash lookup and an SDL_RWFromConstMem over the
+ * mapping: the bytes are paged in by the kernel on first touch and are never copied. Compressed entries are
+ * decompressed into a caller-owned scratch buffer instead. All integers are little-endian.
+ */
+class AssetPack
+{
+public:
+    static constexpr Uint32 kVersion = 1;
+    static constexpr Uint32 kAlignment = 64;
+    static constexpr Uint16 kFlagLZ4 = 1; //!< The entry is stored as an LZ4 block.
+
+    AssetPack() = default;
+    AssetPack(const AssetPack &) = delete;
+    AssetPack &operator=(const AssetPack &) = delete;
+
+    ~AssetPack()
+    {
+        Unmount();
+    }
+
+    /*!
+     * \brief Maps a pack file and checks its header and entry table.
+     * \param path The path of the pack.
+     * \return True if the pack is mounted. A pack that is missing or malformed leaves nothing mounted.
+     */
+    bool Mount(const std::string &path);
+
+    /*!
+     * \brief Unmaps the pack. Any SDL_RWops opened over it must be closed first.
+     */
+    void Unmount();
+
+    /*!
+     * \brief Checks whether a pack is mounted.
+     */
+    bool IsMounted() const
+    {
+        return mBase != nullptr;
+    }
+
+    /*!
+     * \brief Checks whether the pack holds a file.
+     * \param name The file name, e.g. "assets/hero.bmp"; case and separators don't matter.
+     */
+    bool Contains(const std::string &name) const;
+
+    /*!
+     * \brief Opens a file of the pack as an SDL stream.
+     * \param name The file name, e.g. "assets/hero.bmp"; case and separators don't matter.
+     * \param scratch Receives the decompressed bytes of a compressed entry; it must outlive the stream.
+     * \return A read-only stream over the mapped or decompressed bytes, or nullptr if the pack has no such file.
+     */
+    SDL_RWops *Open(const std::string &name, std::vector<Uint8> &scratch) const;
+
+    /*!
+     * \brief Gets the number of files in the pack.
+     */
+    Uint32 GetEntryCount() const
+    {
+        return mEntryCount;
+    }
+
+    /*!
+     * \brief Computes the hash the entry table is keyed by.
+     * \param name The file name; it is normalized first.
+     */
+    static Uint64 Hash(const std::string &name);
+
+    /*!
+     * \brief Decompresses an LZ4 block.
+     * \param source The compressed bytes.
+     * \param sourceSize The number of compressed bytes.
+     * \param destination Receives exactly destinationSize bytes.
+     * \param destinationSize The size of the original data.
+     * \return True if the block was well formed and decompressed to exactly destinationSize bytes.
+     */
+    static bool DecompressLZ4(const Uint8 *source, size_t sourceSize, Uint8 *destination, size_t destinationSize);
+
+private:
+    /*!
+     * \brief The header at the start of a pack.
+     */
+    struct Header
+    {
+        char magic[4];      //!< "GEPK".
+        Uint32 version;     //!< kVersion.
+        Uint32 slotCount;   //!< Size of the entry table, a power of two.
+        Uint32 entryCount;  //!< Number of used slots.
+        Uint64 namesOffset; //!< Start of the names, from the start of the pack.
+        Uint64 namesSize;   //!< Total length of the names.
+    };
+
+    /*!
+     * \brief A slot of the entry table. A hash of 0 marks an empty slot.
+     */
+    struct Entry
+    {
+        Uint64 hash;
+        Uint64 offset;      //!< Start of the content, from the start of the pack.
+        Uint32 size;        //!< Size of the original file.
+        Uint32 storedSize;  //!< Size of the content as stored.
+        Uint32 nameOffset;  //!< Start of the normalized name, from the start of the names.
+        Uint16 nameLength;
+        Uint16 flags;
+    };
+
+    static_assert(sizeof(Header) == 32 && sizeof(Entry) == 32, "pack layout must match pack_assets.py");
+
+    /*!
+     * \brief Lowercases a name and turns backslashes into forward slashes.
+     */
+    static std::string Normalize(const std::string &name);
+
+    /*!
+     * \brief Finds the entry of a file, or nullptr.
+     */
+    const Entry *Find(const std::string &name) const;
+
+    const Uint8 *mBase = nullptr;
+    size_t mSize = 0;
+    const Entry *mEntries = nullptr;
+    const char *mNames = nullptr;
+    Uint32 mSlotCount = 0;
+    Uint32 mEntryCount = 0;
+#ifdef _WIN32
+    void *mFile = nullptr;
+    void *mMapping = nullptr;
+#endif
+};
+
+#endif // ASSET_PACK_H
@@ -0,0 +1,168 @@
+#pragma once
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include "ResourceManager.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <string>
+
+/*!
+ * \struct AudioStats
+ * \brief Timing of the audio callback, for spotting glitches.
+ */
+struct AudioStats
+{
+    Uint64 callbacks{0};       //!< Buffers mixed since StartUp.
+    Uint64 underruns{0};       //!< Callbacks that came late or took longer than their buffer lasts.
+    Uint64 droppedCommands{0}; //!< Commands lost because the queue was full.
+    float lastMixMicros{0.0f};
+    float maxMixMicros{0.0f};
+    float averageMixMicros{0.0f};
+    float bufferMicros{0.0f}; //!< How long one buffer plays; the callback's deadline.
+    int activeVoices{0};
+};
+
+/*!
+ * \class AudioMixer
+ * \brief Plays cached sounds on the SDL audio device from a callback with a fixed pool of voices.
+ *
+ * The AudioMixer follows the Singleton design pattern, like ResourceManager. Gameplay never touches the voices; it
+ * pushes commands into a bounded lock-free queue that the audio callback drains before mixing each buffer, so the
+ * callback never waits on a lock held by a frame that is running late. Sounds are decoded to the device format once,
+ * by the ResourceManager, so mixing is a multiply-add per sample. Without StartUp, e.g. in headless scenes, every call
+ * does nothing. Set SDL_AUDIODRIVER to "dummy" or "disk" to run without a sound card.
+ */
+class AudioMixer
+{
+public:
+    static constexpr int kMaxVoices = 32;
+    static constexpr size_t kQueueCapacity = 256; //!< Must be a power of two.
+
+    /*!
+     * \brief Retrieves the singleton instance of AudioMixer.
+     */
+    static AudioMixer &GetInstance();
+
+    /*!
+     * \brief Opens the default audio device and starts mixing. SDL_INIT_AUDIO must have been initialized.
+     * \param frequency The sample rate.
+     * \param bufferFrames Frames per callback; smaller buffers lower the latency and raise the risk of underruns.
+     * \return 0 on success, -1 if no device could be opened.
+     */
+    int StartUp(int frequency = 48000, int bufferFrames = 256);
+
+    /*!
+     * \brief Stops mixing and closes the device. Logs the callback statistics.
+     */
+    int ShutDown();
+
+    /*!
+     * \brief Checks whether the device is open.
+     */
+    bool IsRunning() const
+    {
+        return mDevice != 0;
+    }
+
+    /*!
+     * \brief Loads a WAV file into the ResourceManager at the mixer's rate.
+     * \param filename The path to the WAV file.
+     * \return The sound, or nullptr if the mixer is not running or the file cannot be loaded.
+     */
+    const SoundBuffer *LoadSound(const std::string &filename);
+
+    /*!
+     * \brief Starts playing a sound on a free voice, or on the voice closest to finishing if all are busy.
+     * \param sound The sound; may be null, which does nothing.
+     * \param volume The gain, 1 for full volume.
+     * \param pan -1 for left, 0 for center, 1 for right.
+     * \return False if the mixer is not running or the command queue is full.
+     *
+     * May be called from any thread.
+     */
+    bool Play(const SoundBuffer *sound, float volume = 1.0f, float pan = 0.0f);
+
+    /*!
+     * \brief Stops every voice.
+     */
+    bool StopAll();
+
+    /*!
+     * \brief Sets the gain applied to the whole mix.
+     */
+    bool SetMasterVolume(float volume);
+
+    /*!
+     * \brief Gets the callback statistics. Values are read without stopping the callback.
+     */
+    AudioStats GetStats() const;
+
+private:
+    AudioMixer();
+    AudioMixer(AudioMixer const &);
+    void operator=(AudioMixer const &);
+
+    enum class CommandType : Uint8
+    {
+        Play,
+        StopAll,
+        SetMasterVolume
+    };
+
+    struct Command
+    {
+        CommandType type;
+        const SoundBuffer *sound;
+        float left;
+        float right;
+    };
+
+    /*!
+     * \brief A slot of the command queue. The sequence number says whether the slot is free or holds a command.
+     */
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Command command;
+    };
+
+    struct Voice
+    {
+        const SoundBuffer *sound{nullptr};
+        size_t position{0}; //!< Next frame to play.
+        float left{0.0f};
+        float right{0.0f};
+    };
+
+    static void Callback(void *userdata, Uint8 *stream, int length);
+    void Mix(float *out, int frames);
+    void Apply(const Command &command);
+    bool Push(const Command &command);
+    bool Pop(Command &command);
+
+    SDL_AudioDeviceID mDevice{0};
+    int mFrequency{0};
+    float mBufferMicros{0.0f};
+
+    // Command queue: a bounded multi-producer, single-consumer queue after Dmitry Vyukov's design
+    Cell mCells[kQueueCapacity];
+    std::atomic<size_t> mEnqueuePosition{0};
+    size_t mDequeuePosition{0};
+
+    // Owned by the audio callback
+    Voice mVoices[kMaxVoices];
+    float mMasterVolume{1.0f};
+    Uint64 mLastCallbackCounter{0};
+
+    // Written by the audio callback, read by GetStats
+    std::atomic<Uint64> mCallbacks{0};
+    std::atomic<Uint64> mUnderruns{0};
+    std::atomic<Uint64> mDroppedCommands{0};
+    std::atomic<Uint64> mTotalMixCounter{0};
+    std::atomic<Uint64> mLastMixCounter{0};
+    std::atomic<Uint64> mMaxMixCounter{0};
+    std::atomic<int> mActiveVoices{0};
+};
+
+#endif // AUDIO_MIXER_H
@@ -31,7 +31,7 @@ struct BackGroundGameEntity : public GameEntity
         }
     }
 
-    virtual void Render(SDL_Renderer *renderer) override
+    virtual void Render(FramePacket &packet) override
     {
         if (!mRenderable)
         {
@@ -41,7 +41,7 @@ struct BackGroundGameEntity : public GameEntity
         auto spriteComponent = this->GetComponent<SpriteComponent>();
         if (spriteComponent)
         {
-            spriteComponent->Render(renderer);
+            spriteComponent->Render(packet);
         }
     }
 
@@ -1,11 +1,23 @@
 #pragma once
 #include "SceneManager.h"
-#include "EnemyGameEntity.h"
 #include "GroundGameEntity.h"
 #include "PlayerGameEntity.h"
 #include "BackGroundGameEntity.h"
 #include "SpriteComponent.h"
-#include "FoodGameEntity.h"
+#include "SpriteInstances.h"
+#include "PhysicsWorld.h"
+#include "CollisionSystem.h"
+#include "NavGraph.h"
+#include "EnemyAgents.h"
+#include "ParticleSystem.h"
+#include "ScriptScheduler.h"
+#include "TimerWheel.h"
+#include "AudioMixer.h"
+#include "BitmapFont.h"
+#include "PrototypeRegistry.h"
+#include "SceneGraph.h"
+#include "ConfigManager.h"
+#include <cstdio>
 
 /*!
  * \struct BaseScene
@@ -13,12 +25,41 @@
  *
  * This structure manages a collection of game entities and implements common scene behaviors such as initialization,
  * input handling, updating state, and rendering. It serves as a base for more specific scene implementations in the game.
+ * Enemies and foods are lightweight SpriteInstances of the "enemy" and "food" prototypes rather than full entities.
+ * The player and any instances given a body are moved by the scene's PhysicsWorld, with the grounds as static geometry.
+ * Pickups and hazards are handled by CollisionSystem handlers registered in StartUp. Groups of sprites that move
+ * together, such as a platform carrying food, are nodes of the scene's SceneGraph; they are drawn and collided like
+ * instances of their prototypes.
  */
 struct BaseScene : public Scene
 {
 protected:
-    std::vector<std::shared_ptr<EnemyGameEntity>> enemies;
-    std::vector<std::shared_ptr<FoodGameEntity>> foods;
+    static constexpr Uint32 kPlayerGroup = 0;
+    static constexpr Uint32 kEnemyGroup = 1;
+    static constexpr Uint32 kFoodGroup = 2;
+    static constexpr Uint32 kGraphGroup = 3;
+
+    PhysicsWorld physics;
+    AnimationSystem animations;
+    CollisionSystem collisions;
+    ParticleSystem particles;
+    NavGraph navigation;
+    EnemyAgents agents;
+    ScriptScheduler scripts;
+    TimerWheel timers;
+    SpriteInstances enemies;
+    SpriteInstances foods;
+    SceneGraph graph;
+    Uint16 mEnemyPrototype = 0;
+    Uint16 mFoodPrototype = 0;
+    Uint16 mChaserPrototype = 0;
+    size_t mPickupEmitter = 0;
+    size_t mDeathEmitter = 0;
+    const SoundBuffer *mEatSound = nullptr;
+    const SoundBuffer *mDeathSound = nullptr;
+    const SoundBuffer *mWinSound = nullptr;
+    BitmapFont mFont;
+    TextLabel mScoreLabel;
     std::unique_ptr<PlayerGameEntity> mainCharacter;
     std::vector<std::shared_ptr<GroundGameEntity>> Grounds;
     std::unique_ptr<BackGroundGameEntity> backGround;
@@ -28,6 +69,9 @@ protected:
     SDL_Renderer *mRenderer = nullptr;
     bool isCompleted = false;
     bool isWin = false;
+    bool isLost = false;
+    Uint32 mInputTimestamp = 0;
+    SceneSnapshot mInitialSnapshot;
 
 public:
     /*!
@@ -68,10 +112,26 @@ public:
     {
         ResourceManager &manager = ResourceManager::GetInstance();
         manager.StartUp();
-        mainCharacter = std::make_unique<PlayerGameEntity>(mRenderer);
+        PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+        mEnemyPrototype = registry.Register("enemy", mRenderer, "assets/enemy.bmp", 45.0f, 45.0f, PROTOTYPE_HAZARD);
+        mFoodPrototype = registry.Register("food", mRenderer, "assets/food.bmp", 45.0f, 45.0f, PROTOTYPE_COLLECTIBLE);
+        mChaserPrototype = registry.Register("chaser", mRenderer, "assets/enemy.bmp", 45.0f, 45.0f, PROTOTYPE_HAZARD | PROTOTYPE_CHASER);
+        registry.SetCollisionFilter(mEnemyPrototype, COLLISION_LAYER_HAZARD, COLLISION_LAYER_PLAYER);
+        registry.SetCollisionFilter(mChaserPrototype, COLLISION_LAYER_HAZARD, COLLISION_LAYER_PLAYER);
+        registry.SetCollisionFilter(mFoodPrototype, COLLISION_LAYER_PICKUP, COLLISION_LAYER_PLAYER);
+        RegisterParticleEmitters();
+        LoadSounds();
+        mFont.Load(mRenderer);
+        mScoreLabel.SetScale(2.0f);
+        RegisterCollisionHandlers();
+
+        enemies.SetPhysics(&physics, kEnemyGroup);
+        foods.SetPhysics(&physics, kFoodGroup);
+
+        mainCharacter = std::make_unique<PlayerGameEntity>(mRenderer, physics, animations);
         backGround = std::make_unique<BackGroundGameEntity>(mRenderer);
 
-        mainCharacter->GetComponent<SpriteComponent>()->Move(220, 460);
+        mainCharacter->Teleport(220, 460);
         backGround->GetComponent<SpriteComponent>()->Move(0, 0);
 
         auto ground1 = std::make_unique<GroundGameEntity>(mRenderer, 640, 20);
@@ -100,8 +160,17 @@ public:
         Grounds.push_back(std::move(ground6));
         Grounds.push_back(std::move(ground7));
         Grounds.push_back(std::move(ground8));
+        std::vector<SDL_FRect> platforms;
+        for (auto &ground : Grounds)
+        {
+            platforms.push_back(ground->GetComponent<SpriteComponent>()->GetRectangle());
+            physics.AddStatic(platforms.back());
+        }
+        BuildNavigation(platforms);
 
         SetupLevel();
+        StartScripts();
+        SaveSnapshot(mInitialSnapshot);
     }
 
     /*!
@@ -131,21 +200,264 @@ public:
         return isWin;
     }
 
+    /*!
+     * \brief Gets one of the scene's instance groups by name.
+     * \param group "enemy" or "food".
+     * \return The instance list, or nullptr for an unknown group.
+     */
+    SpriteInstances *GetInstances(const std::string &group)
+    {
+        if (group == "enemy")
+        {
+            return &enemies;
+        }
+        if (group == "food")
+        {
+            return &foods;
+        }
+        return nullptr;
+    }
+
+    /*!
+     * \brief Gets the prototype index new instances of a group are spawned with.
+     * \param group "enemy" or "food".
+     * \return The prototype index, or -1 for an unknown group.
+     */
+    int GetGroupPrototype(const std::string &group) const
+    {
+        if (group == "enemy")
+        {
+            return mEnemyPrototype;
+        }
+        if (group == "food")
+        {
+            return mFoodPrototype;
+        }
+        return -1;
+    }
+
+    /*!
+     * \brief Gets the scene graph of the scene.
+     */
+    SceneGraph &GetSceneGraph()
+    {
+        return graph;
+    }
+
+    /*!
+     * \brief Gets the particle effects of the scene.
+     */
+    ParticleSystem &GetParticles()
+    {
+        return particles;
+    }
+
+    /*!
+     * \brief Gets the index of a particle emitter of the scene.
+     * \param name "pickup" or "death".
+     * \return The emitter index, or -1 if the emitter does not exist.
+     */
+    int GetEmitter(const std::string &name) const
+    {
+        if (name == "pickup")
+        {
+            return static_cast<int>(mPickupEmitter);
+        }
+        if (name == "death")
+        {
+            return static_cast<int>(mDeathEmitter);
+        }
+        return -1;
+    }
+
+    /*!
+     * \brief Saves the complete simulation state of the scene.
+     * \param snapshot The snapshot to overwrite.
+     *
+     * Captures player position, ground positions, every physics body, the animation playback state, the collision
+     * contacts, every enemy and food instance, the scene graph, the score and the win/lose flags.
+     */
+    void SaveSnapshot(SceneSnapshot &snapshot) const override
+    {
+        snapshot.Clear();
+        snapshot.Write(SceneSnapshot::kMagic);
+        snapshot.Write(SceneSnapshot::kVersion);
+
+        auto playerSprite = mainCharacter->GetComponent<SpriteComponent>();
+        snapshot.Write(playerSprite->GetRectangle());
+
+        snapshot.Write(static_cast<Uint64>(Grounds.size()));
+        for (const auto &ground : Grounds)
+        {
+            snapshot.Write(ground->GetComponent<SpriteComponent>()->GetRectangle());
+        }
+
+        physics.Save(snapshot);
+        animations.Save(snapshot);
+        collisions.Save(snapshot);
+        agents.Save(snapshot);
+        enemies.Save(snapshot);
+        foods.Save(snapshot);
+        graph.Save(snapshot);
+
+        snapshot.Write(mPoints);
+        snapshot.Write(mRun);
+        snapshot.Write(isWin);
+        snapshot.Write(isLost);
+        snapshot.Write(isCompleted);
+    }
+
+    /*!
+     * \brief Restores the simulation state saved by SaveSnapshot, in place.
+     * \param snapshot A snapshot of this scene.
+     * \return False if the snapshot does not belong to this scene; the scene may then be partially restored.
+     *
+     * Entities are not recreated: every entity and instance gets its saved state back, so pointers and indices
+     * stay valid across a restore.
+     */
+    bool RestoreSnapshot(const SceneSnapshot &snapshot) override
+    {
+        SnapshotReader reader(snapshot);
+        Uint32 magic = 0;
+        Uint32 version = 0;
+        if (!reader.Read(magic) || !reader.Read(version) || magic != SceneSnapshot::kMagic || version != SceneSnapshot::kVersion)
+        {
+            LOG_WARN("Not a scene snapshot");
+            return false;
+        }
+
+        SDL_FRect playerRectangle;
+        reader.Read(playerRectangle);
+        auto playerSprite = mainCharacter->GetComponent<SpriteComponent>();
+        playerSprite->Move(playerRectangle.x, playerRectangle.y);
+        playerSprite->SetSize(playerRectangle.w, playerRectangle.h);
+
+        Uint64 groundCount = 0;
+        if (!reader.Read(groundCount) || groundCount != Grounds.size())
+        {
+            LOG_WARN("Snapshot has %llu grounds, scene has %llu", static_cast<unsigned long long>(groundCount), static_cast<unsigned long long>(Grounds.size()));
+            return false;
+        }
+        for (auto &ground : Grounds)
+        {
+            SDL_FRect rectangle;
+            reader.Read(rectangle);
+            auto groundSprite = ground->GetComponent<SpriteComponent>();
+            groundSprite->Move(rectangle.x, rectangle.y);
+            groundSprite->SetSize(rectangle.w, rectangle.h);
+        }
+
+        if (!physics.Restore(reader) || !animations.Restore(reader) || !collisions.Restore(reader) || !agents.Restore(reader) ||
+            !enemies.Restore(reader) || !foods.Restore(reader) || !graph.Restore(reader))
+        {
+            LOG_WARN("Malformed body or instance data in snapshot");
+            return false;
+        }
+
+        reader.Read(mPoints);
+        reader.Read(mRun);
+        reader.Read(isWin);
+        reader.Read(isLost);
+        reader.Read(isCompleted);
+        if (!reader.IsOk())
+        {
+            return false;
+        }
+
+        // Scripts and timers are not part of the snapshot: start them over from the restored state
+        scripts.CancelAll();
+        timers.Clear();
+        StartScripts();
+        return true;
+    }
+
+    /*!
+     * \brief Restarts the level by restoring the state captured at the end of StartUp.
+     *
+     * Nothing is reloaded or reconstructed, so a restart costs a few memory copies.
+     */
+    void Restart() override
+    {
+        RestoreSnapshot(mInitialSnapshot);
+    }
+
+    /*!
+     * \brief Checks if the player has lost the scene by touching an enemy.
+     * \return True if the player has lost, false otherwise.
+     */
+    bool IsLost() const
+    {
+        return isLost;
+    }
+
+    /*!
+     * \brief Gets the player's score.
+     */
+    float GetScore() const
+    {
+        return mPoints;
+    }
+
+    /*!
+     * \brief Gets the number of live entities: the player, the background, the grounds, every live instance and every
+     * scene graph node.
+     */
+    size_t GetEntityCount() const
+    {
+        return 2 + Grounds.size() + enemies.GetLiveCount() + foods.GetLiveCount() + graph.Size();
+    }
+
+    /*!
+     * \brief Gets the player's rectangle.
+     */
+    SDL_FRect GetPlayerRectangle() const
+    {
+        return mainCharacter->GetComponent<SpriteComponent>()->GetRectangle();
+    }
+
+    /*!
+     * \brief Advances the simulation by one tick with a scripted player action instead of SDL input.
+     * \param deltaTime The length of the tick.
+     * \param action A combination of PlayerActionFlags.
+     *
+     * Does not poll SDL events, so it can run on any thread and without a window.
+     */
+    void Step(float deltaTime, Uint8 action)
+    {
+        mainCharacter->ApplyAction(action, deltaTime);
+        Update(deltaTime);
+    }
+
+    /*!
+     * \brief Gets the timestamp of the oldest input event consumed by the last HandleInput call.
+     * \return The SDL timestamp in milliseconds, or 0 if no keyboard event was consumed.
+     */
+    Uint32 GetInputTimestamp() const override
+    {
+        return mInputTimestamp;
+    }
+
     /*!
      * \brief Handles player input for the scene.
      * \param deltaTime The time since the last update.
      *
-     * Processes SDL events and updates player states based on input.
+     * Processes SDL events and updates player states based on input. Remembers the timestamp of the oldest
+     * keyboard event consumed, for latency measurement.
      */
     void HandleInput(float deltaTime) override
     {
         SDL_Event event;
+        mInputTimestamp = 0;
         // Processing input
         while (SDL_PollEvent(&event))
         {
+            if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && mInputTimestamp == 0)
+            {
+                mInputTimestamp = event.key.timestamp;
+            }
             if (event.type == SDL_QUIT)
             {
-                SDL_Log("Program quit %u", event.quit.timestamp);
+                LOG_INFO("Program quit %u", event.quit.timestamp);
                 mRun = false;
             }
         }
@@ -157,128 +469,250 @@ public:
     /*!
      * \brief Renders all entities in the scene.
      *
-     * Draws the background, player, enemies, food, and grounds to the screen.
+     * Records the background, enemies, food, scene graph, player, grounds, particles and the score HUD into the frame packet. The
+     * packet is drawn and presented by the render thread. The score label is only laid out again when the score changes.
+     * \param packet The frame packet to record into.
      */
-    void Render() override
+    void Render(FramePacket &packet) override
     {
-        SDL_SetRenderDrawColor(mRenderer, 0, 64, 255, SDL_ALPHA_OPAQUE);
-        SDL_RenderClear(mRenderer);
-        backGround->Render(mRenderer);
-
-        SDL_SetRenderDrawColor(mRenderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+        packet.SetClearColor(0, 64, 255, SDL_ALPHA_OPAQUE);
+        backGround->Render(packet);
 
-        for (int i = 0; i < enemies.size(); i++)
-        {
-            enemies[i]->Render(mRenderer);
-        }
-        for (int i = 0; i < foods.size(); i++)
-        {
-            foods[i]->Render(mRenderer);
-        }
-        mainCharacter->Render(mRenderer);
+        enemies.Render(packet);
+        foods.Render(packet);
+        graph.Render(packet);
+        mainCharacter->Render(packet);
         for (int i = 0; i < Grounds.size(); i++)
         {
-            Grounds[i]->Render(mRenderer);
+            Grounds[i]->Render(packet);
         }
+        particles.Render(packet);
 
-        SDL_RenderPresent(mRenderer);
+        // The HUD is drawn at full resolution even when the scene is rendered scaled down
+        packet.BeginOverlay();
+        char score[32];
+        std::snprintf(score, sizeof(score), "SCORE %d", static_cast<int>(mPoints));
+        mScoreLabel.SetText(score);
+        mScoreLabel.Render(packet, mFont, 10.0f, 10.0f, SDL_Color{255, 255, 255, 255});
     }
 
     /*!
      * \brief Updates the state of the scene.
      * \param deltaTime The time since the last update.
      *
-     * Updates the positions and states of all entities in the scene. Handles gameplay logic such as collisions
-     * and scoring.
+     * Fires the timers and runs the scripts due this tick, then steps the physics world, which moves the player and every instance with a
+     * body and lands them on the grounds, and brings the world transforms of moved scene graph nodes up to date.
+     * Then submits the player, all instances and the scene graph nodes to the collision system, whose handlers deal with pickups, hazards
+     * and scoring, and checks whether every food was eaten.
      */
     void Update(float deltaTime) override
     {
         auto playerSprite = mainCharacter->GetComponent<SpriteComponent>();
         if (!playerSprite)
         {
-            SDL_Log("Player sprite component not found.");
+            LOG_WARN_RATE(1, "Player sprite component not found.");
             return;
         }
 
-        float playerBottomY = playerSprite->GetY() + playerSprite->GetHeight();
-        bool onGround = false;
+        timers.Advance();
+        scripts.Update();
+        agents.Update(enemies, physics, playerSprite->GetRectangle(), mainCharacter->IsOnGround());
+        physics.Step(deltaTime);
+        mainCharacter->Update(deltaTime);
+        animations.Update(deltaTime);
+        particles.Update(deltaTime);
+        enemies.SyncBodies();
+        foods.SyncBodies();
+        graph.Update();
 
-        for (auto &ground : Grounds)
+        collisions.BeginFrame();
+        collisions.AddCollider(playerSprite->GetRectangle(), COLLISION_LAYER_PLAYER, COLLISION_LAYER_PICKUP | COLLISION_LAYER_HAZARD,
+                               CollisionSystem::MakeId(kPlayerGroup, 0));
+        enemies.AddColliders(collisions, kEnemyGroup);
+        foods.AddColliders(collisions, kFoodGroup);
+        graph.AddColliders(collisions, kGraphGroup);
+        collisions.Update();
+
+        if (foods.Size() > 0 && foods.GetLiveCount() == 0)
         {
-            if (mainCharacter->Intersects(ground.get()))
+            AudioMixer::GetInstance().Play(mWinSound);
+            if (!IsHeadless())
             {
-                mainCharacter->SetShouldFall(false);
-                onGround = true;
-                auto groundSprite = ground->GetComponent<SpriteComponent>();
-                if (groundSprite)
-                {
-                    float groundY = groundSprite->GetY();
-                    if (playerBottomY > groundY)
-                    {
-                        mainCharacter->SetOnGround(groundY - playerSprite->GetHeight());
-                    }
-                }
-                break;
+                LOG_INFO("YOU WIN!");
+                LOG_INFO("Your score is %f", mPoints);
             }
+            mRun = false;
+            isWin = true;
         }
-        mainCharacter->Update(deltaTime);
+    }
+
+    /*!
+     * \brief Sets up the level-specific entities and logic.
+     *
+     * This method must be implemented by derived classes to create a specific level's layout and gameplay elements.
+     */
+    virtual void SetupLevel() = 0;
+
+    /*!
+     * \brief Spawns the level's scripts and schedules its timers. Called after SetupLevel and again after every snapshot
+     * restore, once the previous scripts and timers were cancelled, so it must only read the scene's state, not create
+     * entities.
+     */
+    virtual void StartScripts()
+    {
+    }
+
+protected:
+    /*!
+     * \brief Adds the particle effects of pickups and of the player's death.
+     */
+    void RegisterParticleEmitters()
+    {
+        ParticleEmitter pickup;
+        pickup.capacity = 1024;
+        pickup.color = SDL_Color{255, 220, 60, 255};
+        mPickupEmitter = particles.AddEmitter(pickup);
 
-        for (int i = 0; i < foods.size(); i++)
+        ParticleEmitter death;
+        death.capacity = 1024;
+        death.life = 1.0f;
+        death.minSpeed = 120.0f;
+        death.maxSpeed = 320.0f;
+        death.size = 6.0f;
+        death.color = SDL_Color{230, 40, 40, 255};
+        mDeathEmitter = particles.AddEmitter(death);
+    }
+
+    /*!
+     * \brief Loads the sounds of pickups, death and winning. Headless scenes play no sound and load nothing.
+     */
+    void LoadSounds()
+    {
+        if (mRenderer == nullptr)
         {
-            if (!foods[i])
-            {
-                continue;
-            }
-            foods[i]->Update(deltaTime);
+            return;
+        }
+        AudioMixer &mixer = AudioMixer::GetInstance();
+        mEatSound = mixer.LoadSound("assets/eat.wav");
+        mDeathSound = mixer.LoadSound("assets/death.wav");
+        mWinSound = mixer.LoadSound("assets/win.wav");
+    }
 
-            bool playerHitsFood = mainCharacter->Intersects(foods[i].get());
+    /*!
+     * \brief Checks whether the scene runs without a renderer, like the environments of a VectorEnv.
+     *
+     * Headless scenes skip the gameplay logs: thousands of episodes would flood the console, and with the Logger not
+     * started every line is a synchronous write that the stepping threads queue up on.
+     */
+    bool IsHeadless() const
+    {
+        return mRenderer == nullptr;
+    }
 
-            if (playerHitsFood && foods[i]->IsRenderable())
+    /*!
+     * \brief Registers the scene's reactions to the player touching pickups and hazards.
+     */
+    void RegisterCollisionHandlers()
+    {
+        collisions.AddHandler(CollisionEventType::Enter, COLLISION_LAYER_PLAYER, COLLISION_LAYER_PICKUP, [this](const CollisionEvent &event)
+                              {
+            if (CollisionSystem::GetGroup(event.b) == kGraphGroup)
             {
-                foods[i]->SetRenderable(false);
-                mPoints += 10.0f;
-                SDL_Log("Food eaten. Your score is %f", mPoints);
+                // A pickup carried by the scene graph is eaten with everything attached to it
+                Uint32 node = CollisionSystem::GetIndex(event.b);
+                if (graph.IsAlive(node))
+                {
+                    SDL_FRect box = graph.GetRectangle(node);
+                    particles.Emit(mPickupEmitter, box.x + box.w * 0.5f, box.y + box.h * 0.5f, 48);
+                    graph.Remove(node);
+                    AudioMixer::GetInstance().Play(mEatSound, 0.8f, box.x / 320.0f - 1.0f);
+                    mPoints += 10.0f;
+                }
+                return;
             }
-
-            bool allFoodsDestroyed = true;
-            for (auto &food : foods)
+            if (CollisionSystem::GetGroup(event.b) != kFoodGroup)
+            {
+                return;
+            }
+            size_t food = CollisionSystem::GetIndex(event.b);
+            if (food < foods.Size() && foods.IsAlive(food))
             {
-                if (food && food->IsRenderable())
+                SDL_FRect box = foods.GetRectangle(food);
+                particles.Emit(mPickupEmitter, box.x + box.w * 0.5f, box.y + box.h * 0.5f, 48);
+                foods.Kill(food);
+                AudioMixer::GetInstance().Play(mEatSound, 0.8f, box.x / 320.0f - 1.0f);
+                mPoints += 10.0f;
+                if (!IsHeadless())
                 {
-                    allFoodsDestroyed = false;
-                    break;
+                    LOG_INFO("Food eaten. Your score is %f", mPoints);
                 }
-            }
-
-            if (allFoodsDestroyed)
+            } });
+        collisions.AddHandler(CollisionEventType::Enter, COLLISION_LAYER_PLAYER, COLLISION_LAYER_HAZARD, [this](const CollisionEvent &)
+                              {
+            SDL_FRect box = mainCharacter->GetComponent<SpriteComponent>()->GetRectangle();
+            particles.Emit(mDeathEmitter, box.x + box.w * 0.5f, box.y + box.h * 0.5f, 256);
+            AudioMixer::GetInstance().Play(mDeathSound);
+            if (!IsHeadless())
             {
-                SDL_Log("YOU WIN!");
-                SDL_Log("Your score is %f", mPoints);
-                mRun = false;
-                isWin = true;
+                LOG_INFO("YOU LOSE!");
             }
+            mRun = false;
+            isLost = true; });
+        // Scripts waiting on a collider with ScriptScheduler::Event(id) wake up when it touches something
+        collisions.AddHandler(CollisionEventType::Enter, ~0u, ~0u, [this](const CollisionEvent &event)
+                              {
+            scripts.Notify(event.a, event.b);
+            scripts.Notify(event.b, event.a); });
+    }
+
+    /*!
+     * \brief Spawns instances at the positions listed in a level configuration.
+     * \param config The loaded level configuration.
+     * \param prefix The key prefix, e.g. "enemy" for enemy1_x, enemy1_y, enemy2_x, ...
+     * \param prototype The prototype index of the spawned instances.
+     * \param instances The instance list to spawn into.
+     *
+     * Positions are gathered first and spawned with a single SpawnMany call.
+     */
+    void SpawnFromConfig(std::unordered_map<std::string, int> &config, const std::string &prefix, Uint16 prototype, SpriteInstances &instances)
+    {
+        std::vector<float> xs;
+        std::vector<float> ys;
+        int index = 1;
+        while (config.find(prefix + std::to_string(index) + "_x") != config.end())
+        {
+            xs.push_back(static_cast<float>(config[prefix + std::to_string(index) + "_x"]));
+            ys.push_back(static_cast<float>(config[prefix + std::to_string(index) + "_y"]));
+            index++;
         }
-        for (int i = 0; i < enemies.size(); i++)
+        std::vector<Uint32> indices(xs.size());
+        instances.SpawnMany(prototype, xs.data(), ys.data(), xs.size(), indices.data());
+        if (PrototypeRegistry::GetInstance().Get(prototype).flags & PROTOTYPE_CHASER)
         {
-
-            bool playerDies = mainCharacter->Intersects(enemies[i].get());
-
-            if (playerDies)
+            // Chasers need a body to walk and jump
+            for (Uint32 index : indices)
             {
-                SDL_Log("YOU LOSE!");
-                mRun = false;
+                instances.EnablePhysics(index, 1.0f);
             }
         }
-        if (!onGround)
-        {
-            mainCharacter->SetShouldFall(true);
-        }
     }
 
     /*!
-     * \brief Sets up the level-specific entities and logic.
+     * \brief Builds the navigation graph of the level once, for enemies that chase the player.
+     * \param platforms The grounds of the level.
      *
-     * This method must be implemented by derived classes to create a specific level's layout and gameplay elements.
+     * Bodies that hit a platform from below are popped onto it, so a jump reaches a platform whose bottom the agent's
+     * head can touch, not only one whose top its feet clear.
      */
-    virtual void SetupLevel() = 0;
+    void BuildNavigation(const std::vector<SDL_FRect> &platforms)
+    {
+        const float speed = 90.0f;
+        const float jumpSpeed = 520.0f;
+        const float agentSize = 45.0f;
+        float apex = jumpSpeed * jumpSpeed / (2.0f * physics.GetGravity());
+        float airTime = 2.0f * jumpSpeed / physics.GetGravity();
+        navigation.Build(platforms, apex + agentSize, speed * airTime * 0.5f, agentSize);
+        agents.SetGraph(&navigation);
+        agents.SetMovement(speed, jumpSpeed);
+    }
 };
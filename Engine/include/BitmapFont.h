@@ -0,0 +1,353 @@
+#pragma once
+#include "FramePacket.h"
+#include "Logger.h"
+#include "ResourceManager.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/*!
+ * \class BitmapFont
+ * \brief The BitmapFont is a built-in 5x7 pixel font for printable ASCII, rasterized once into a glyph atlas texture.
+ *
+ * The glyphs are compiled in as bit rows, so text needs no font file or font library. Load writes them into a small
+ * white-on-transparent atlas, one 8x8 cell per character, and hands it to the ResourceManager, which creates the
+ * texture on the render thread and destroys it on shutdown. Every BitmapFont shares that one texture. Text is tinted by
+ * the vertex color. Character 127 is a solid block, so plain rectangles can be drawn in the same batch as text.
+ */
+class BitmapFont
+{
+public:
+    static constexpr int kGlyphWidth = 5;
+    static constexpr int kGlyphHeight = 7;
+    static constexpr int kAdvance = 6;     //!< Horizontal distance between glyphs, in font pixels.
+    static constexpr int kLineHeight = 9;  //!< Vertical distance between lines, in font pixels.
+    static constexpr char kFirstChar = ' ';
+    static constexpr char kBlockChar = 127;
+    static constexpr int kCell = 8;
+    static constexpr int kColumns = 16;
+    static constexpr int kRows = 6;
+
+    /*!
+     * \brief Rasterizes the atlas the first time any font is loaded and picks up its texture.
+     * \param renderer The renderer; without one, e.g. in headless scenes, nothing is loaded and text is not drawn.
+     */
+    void Load(SDL_Renderer *renderer)
+    {
+        ResourceManager &manager = ResourceManager::GetInstance();
+        mTexture = manager.GetResource(kAtlasKey);
+        if (mTexture != nullptr || renderer == nullptr)
+        {
+            return;
+        }
+
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, kColumns * kCell, kRows * kCell, 32, SDL_PIXELFORMAT_RGBA32);
+        if (surface == nullptr)
+        {
+            LOG_ERROR("Failed to create the glyph atlas: %s", SDL_GetError());
+            return;
+        }
+        SDL_LockSurface(surface);
+        for (int c = 0; c < kColumns * kRows; c++)
+        {
+            int cellX = (c % kColumns) * kCell;
+            int cellY = (c / kColumns) * kCell;
+            for (int y = 0; y < kCell; y++)
+            {
+                Uint32 *row = reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface->pixels) + (cellY + y) * surface->pitch) + cellX;
+                for (int x = 0; x < kCell; x++)
+                {
+                    bool set = y < kGlyphHeight && x < kGlyphWidth && (kGlyphs[c][y] >> (kGlyphWidth - 1 - x)) & 1;
+                    row[x] = set ? 0xFFFFFFFFu : 0u;
+                }
+            }
+        }
+        SDL_UnlockSurface(surface);
+        manager.LoadSurface(renderer, kAtlasKey, surface);
+        SDL_FreeSurface(surface);
+        mTexture = manager.GetResource(kAtlasKey);
+    }
+
+    /*!
+     * \brief Gets the atlas texture, or nullptr if the font is not loaded.
+     */
+    SDL_Texture *GetTexture() const
+    {
+        return mTexture;
+    }
+
+    /*!
+     * \brief Gets the atlas area of a character, in texture coordinates. Characters outside the font map to '?'.
+     * \param c The character.
+     * \param u0 Receives the left edge.
+     * \param v0 Receives the top edge.
+     * \param u1 Receives the right edge.
+     * \param v1 Receives the bottom edge.
+     */
+    static void GetGlyphCoords(char c, float &u0, float &v0, float &u1, float &v1)
+    {
+        int index = (c >= kFirstChar && c <= kBlockChar ? c : '?') - kFirstChar;
+        float x = static_cast<float>((index % kColumns) * kCell);
+        float y = static_cast<float>((index / kColumns) * kCell);
+        u0 = x / (kColumns * kCell);
+        v0 = y / (kRows * kCell);
+        u1 = (x + kGlyphWidth) / (kColumns * kCell);
+        v1 = (y + kGlyphHeight) / (kRows * kCell);
+    }
+
+    /*!
+     * \brief Gets the texture coordinates of the middle of the solid block, for drawing plain rectangles.
+     */
+    static SDL_FPoint GetSolidCoords()
+    {
+        float u0, v0, u1, v1;
+        GetGlyphCoords(kBlockChar, u0, v0, u1, v1);
+        return SDL_FPoint{(u0 + u1) * 0.5f, (v0 + v1) * 0.5f};
+    }
+
+private:
+    static constexpr const char *kAtlasKey = "font:builtin5x7";
+
+    /*!
+     * \brief Bit rows of each character from ' ' to 127; the lowest five bits of a row, leftmost pixel highest.
+     */
+    static constexpr Uint8 kGlyphs[kColumns * kRows][kGlyphHeight] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}, // '!'
+    {0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00}, // '"'
+    {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A}, // '#'
+    {0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04}, // '$'
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}, // '%'
+    {0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D}, // '&'
+    {0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00}, // "'"
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, // '('
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}, // ')'
+    {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00}, // '*'
+    {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}, // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x06, 0x04, 0x08}, // ','
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, // '.'
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, // '/'
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, // '0'
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, // '1'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, // '2'
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, // '3'
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, // '4'
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, // '5'
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, // '6'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, // '7'
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, // '8'
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, // '9'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}, // ':'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08}, // ';'
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}, // '<'
+    {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}, // '='
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}, // '>'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}, // '?'
+    {0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E}, // '@'
+    {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 'A'
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // 'B'
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, // 'C'
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // 'D'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, // 'E'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // 'F'
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, // 'G'
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 'H'
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 'I'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // 'J'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, // 'K'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // 'L'
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, // 'M'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // 'N'
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'O'
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // 'P'
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, // 'Q'
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // 'R'
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, // 'S'
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // 'T'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'U'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // 'V'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, // 'W'
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // 'X'
+    {0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04}, // 'Y'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // 'Z'
+    {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E}, // '['
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}, // '\\'
+    {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E}, // ']'
+    {0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00}, // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}, // '_'
+    {0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00}, // '`'
+    {0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F}, // 'a'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E}, // 'b'
+    {0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E}, // 'c'
+    {0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F}, // 'd'
+    {0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E}, // 'e'
+    {0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08}, // 'f'
+    {0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E}, // 'g'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11}, // 'h'
+    {0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E}, // 'i'
+    {0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C}, // 'j'
+    {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12}, // 'k'
+    {0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 'l'
+    {0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11}, // 'm'
+    {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11}, // 'n'
+    {0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E}, // 'o'
+    {0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10}, // 'p'
+    {0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01}, // 'q'
+    {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10}, // 'r'
+    {0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E}, // 's'
+    {0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06}, // 't'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D}, // 'u'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04}, // 'v'
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A}, // 'w'
+    {0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11}, // 'x'
+    {0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E}, // 'y'
+    {0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F}, // 'z'
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02}, // '{'
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // '|'
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08}, // '}'
+    {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00}, // '~'
+    {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}, // block
+    };
+
+    SDL_Texture *mTexture{nullptr};
+};
+
+/*!
+ * \class TextLabel
+ * \brief A string laid out once as glyph quads and drawn with a single batched geometry call.
+ *
+ * SetText only lays the string out again when it differs from the current one, so a label that is set every frame
+ * costs a string compare until its text actually changes. Render copies the cached quads into the frame packet, moved
+ * to the label's position and tinted. Newlines start a new line.
+ */
+class TextLabel
+{
+public:
+    /*!
+     * \brief Sets the text, laying it out again if it changed.
+     * \return True if the label was laid out again.
+     */
+    bool SetText(const std::string &text)
+    {
+        if (text == mText)
+        {
+            return false;
+        }
+        mText = text;
+        Layout();
+        return true;
+    }
+
+    /*!
+     * \brief Sets the size of a font pixel, in window pixels.
+     */
+    void SetScale(float scale)
+    {
+        if (scale != mScale)
+        {
+            mScale = scale;
+            Layout();
+        }
+    }
+
+    /*!
+     * \brief Gets the current text.
+     */
+    const std::string &GetText() const
+    {
+        return mText;
+    }
+
+    /*!
+     * \brief Gets the number of glyph quads, i.e. visible characters.
+     */
+    size_t GetQuadCount() const
+    {
+        return mVertices.size() / 4;
+    }
+
+    /*!
+     * \brief Gets the size of the laid out text, in window pixels.
+     */
+    SDL_FPoint GetSize() const
+    {
+        return mSize;
+    }
+
+    /*!
+     * \brief Records the label as one quad batch.
+     * \param packet The frame packet to record into.
+     * \param font The font the label is drawn with; nothing is drawn if it is not loaded.
+     * \param x The left edge of the text, in window coordinates.
+     * \param y The top edge of the text, in window coordinates.
+     * \param color The text color.
+     */
+    void Render(FramePacket &packet, const BitmapFont &font, float x, float y, SDL_Color color) const
+    {
+        if (font.GetTexture() == nullptr || mVertices.empty())
+        {
+            return;
+        }
+        Write(packet.DrawQuads(font.GetTexture(), GetQuadCount()), x, y, color);
+    }
+
+    /*!
+     * \brief Writes the label's quads into vertices reserved by the caller, so several labels can share one batch.
+     * \param vertices Room for GetQuadCount() quads.
+     * \param x The left edge of the text, in window coordinates.
+     * \param y The top edge of the text, in window coordinates.
+     * \param color The text color.
+     * \return The vertex after the last one written.
+     */
+    SDL_Vertex *Write(SDL_Vertex *vertices, float x, float y, SDL_Color color) const
+    {
+        for (const SDL_Vertex &vertex : mVertices)
+        {
+            *vertices++ = SDL_Vertex{SDL_FPoint{vertex.position.x + x, vertex.position.y + y}, color, vertex.tex_coord};
+        }
+        return vertices;
+    }
+
+private:
+    /*!
+     * \brief Builds a quad for every visible character, relative to the top-left corner of the text.
+     */
+    void Layout()
+    {
+        mVertices.clear();
+        float penX = 0.0f;
+        float penY = 0.0f;
+        float width = 0.0f;
+        float glyphW = BitmapFont::kGlyphWidth * mScale;
+        float glyphH = BitmapFont::kGlyphHeight * mScale;
+        for (char c : mText)
+        {
+            if (c == '\n')
+            {
+                penX = 0.0f;
+                penY += BitmapFont::kLineHeight * mScale;
+                continue;
+            }
+            if (c != ' ')
+            {
+                float u0, v0, u1, v1;
+                BitmapFont::GetGlyphCoords(c, u0, v0, u1, v1);
+                SDL_Color white{255, 255, 255, 255};
+                mVertices.push_back(SDL_Vertex{SDL_FPoint{penX, penY}, white, SDL_FPoint{u0, v0}});
+                mVertices.push_back(SDL_Vertex{SDL_FPoint{penX + glyphW, penY}, white, SDL_FPoint{u1, v0}});
+                mVertices.push_back(SDL_Vertex{SDL_FPoint{penX + glyphW, penY + glyphH}, white, SDL_FPoint{u1, v1}});
+                mVertices.push_back(SDL_Vertex{SDL_FPoint{penX, penY + glyphH}, white, SDL_FPoint{u0, v1}});
+            }
+            penX += BitmapFont::kAdvance * mScale;
+            width = std::max(width, penX);
+        }
+        mSize = SDL_FPoint{width, mText.empty() ? 0.0f : penY + glyphH};
+    }
+
+    std::string mText;
+    float mScale{1.0f};
+    std::vector<SDL_Vertex> mVertices;
+    SDL_FPoint mSize{0.0f, 0.0f};
+};
@@ -0,0 +1,294 @@
+#pragma once
+#include "SceneSnapshot.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/*!
+ * \brief Collision layer bits. A collider is on one or more layers and has a mask of the layers it collides with.
+ */
+enum CollisionLayer : Uint32
+{
+    COLLISION_LAYER_NONE = 0,
+    COLLISION_LAYER_PLAYER = 1u << 0,
+    COLLISION_LAYER_PICKUP = 1u << 1,
+    COLLISION_LAYER_HAZARD = 1u << 2
+};
+
+/*!
+ * \brief The kind of a collision event.
+ */
+enum class CollisionEventType : Uint8
+{
+    Enter, //!< The colliders started touching this frame.
+    Stay,  //!< The colliders touched last frame and still do.
+    Exit   //!< The colliders touched last frame and no longer do, or one of them is gone.
+};
+
+/*!
+ * \struct CollisionEvent
+ * \brief A change in the contact between two colliders.
+ */
+struct CollisionEvent
+{
+    CollisionEventType type;
+    Uint32 a;      //!< Id of the first collider.
+    Uint32 b;      //!< Id of the second collider.
+    Uint32 layerA; //!< Layers of the first collider.
+    Uint32 layerB; //!< Layers of the second collider.
+};
+
+/*!
+ * \class CollisionSystem
+ * \brief The CollisionSystem finds touching colliders once per frame and turns them into enter/stay/exit events.
+ *
+ * Colliders are submitted every frame with a stable id, their layers and their mask. Two colliders are only tested if
+ * each one's mask contains a layer of the other, so filtered pairs never reach the geometry test. Candidates come from a
+ * sort-and-sweep along X. The contacts are kept sorted by pair, so comparing them with the previous frame's contacts is
+ * a single merge. Handlers are registered per event type and layer pair and called in a batch after detection.
+ */
+class CollisionSystem
+{
+public:
+    using Handler = std::function<void(const CollisionEvent &)>;
+
+    /*!
+     * \brief Builds a collider id from a group (e.g. one instance list) and an index within it.
+     */
+    static Uint32 MakeId(Uint32 group, Uint32 index)
+    {
+        return (group << 24) | (index & 0x00FFFFFFu);
+    }
+
+    /*!
+     * \brief Gets the group of a collider id.
+     */
+    static Uint32 GetGroup(Uint32 id)
+    {
+        return id >> 24;
+    }
+
+    /*!
+     * \brief Gets the index of a collider id within its group.
+     */
+    static Uint32 GetIndex(Uint32 id)
+    {
+        return id & 0x00FFFFFFu;
+    }
+
+    /*!
+     * \brief Registers a handler.
+     * \param type The event type the handler is interested in.
+     * \param layerA The handler is called for pairs where one collider is on one of these layers...
+     * \param layerB ...and the other on one of these. The event is passed with a on layerA and b on layerB.
+     * \param handler The handler.
+     */
+    void AddHandler(CollisionEventType type, Uint32 layerA, Uint32 layerB, Handler handler)
+    {
+        mHandlers.push_back(HandlerEntry{type, layerA, layerB, std::move(handler)});
+    }
+
+    /*!
+     * \brief Removes all colliders submitted for the previous frame. Contacts are kept for the next Update.
+     */
+    void BeginFrame()
+    {
+        mBoxes.clear();
+        mLayers.clear();
+        mMasks.clear();
+        mIds.clear();
+    }
+
+    /*!
+     * \brief Submits a collider for this frame.
+     * \param box The collider box.
+     * \param layer The layers the collider is on.
+     * \param mask The layers the collider collides with.
+     * \param id A stable id, e.g. from MakeId; the same collider must use the same id every frame.
+     */
+    void AddCollider(const SDL_FRect &box, Uint32 layer, Uint32 mask, Uint32 id)
+    {
+        mBoxes.push_back(box);
+        mLayers.push_back(layer);
+        mMasks.push_back(mask);
+        mIds.push_back(id);
+    }
+
+    /*!
+     * \brief Detects this frame's contacts, compares them with last frame's and calls the handlers.
+     */
+    void Update()
+    {
+        mPrevious.swap(mContacts);
+        Detect();
+        Diff();
+        Dispatch();
+    }
+
+    /*!
+     * \brief Gets the events of the last Update, ordered by pair.
+     */
+    const std::vector<CollisionEvent> &GetEvents() const
+    {
+        return mEvents;
+    }
+
+    /*!
+     * \brief Gets the number of touching pairs found by the last Update.
+     */
+    size_t GetContactCount() const
+    {
+        return mContacts.size();
+    }
+
+    /*!
+     * \brief Appends the contact cache to a snapshot, so a restored scene does not see spurious events.
+     */
+    void Save(SceneSnapshot &snapshot) const
+    {
+        snapshot.WriteArray(mContacts);
+    }
+
+    /*!
+     * \brief Restores the contact cache saved by Save.
+     * \return False if the snapshot is malformed.
+     */
+    bool Restore(SnapshotReader &reader)
+    {
+        return reader.ReadArray(mContacts);
+    }
+
+private:
+    struct Contact
+    {
+        Uint64 key; //!< Lower id in the high half, higher id in the low half.
+        Uint32 layerLow;
+        Uint32 layerHigh;
+    };
+
+    struct HandlerEntry
+    {
+        CollisionEventType type;
+        Uint32 layerA;
+        Uint32 layerB;
+        Handler handler;
+    };
+
+    /*!
+     * \brief Finds all touching, unfiltered pairs with a sort-and-sweep along X.
+     */
+    void Detect()
+    {
+        mContacts.clear();
+        size_t count = mBoxes.size();
+        mOrder.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            mOrder[i] = static_cast<Uint32>(i);
+        }
+        std::sort(mOrder.begin(), mOrder.end(), [this](Uint32 l, Uint32 r)
+                  { return mBoxes[l].x < mBoxes[r].x; });
+
+        for (size_t n = 0; n < count; n++)
+        {
+            Uint32 i = mOrder[n];
+            const SDL_FRect &a = mBoxes[i];
+            for (size_t m = n + 1; m < count; m++)
+            {
+                Uint32 j = mOrder[m];
+                const SDL_FRect &b = mBoxes[j];
+                if (b.x >= a.x + a.w)
+                {
+                    break;
+                }
+                if (!(mMasks[i] & mLayers[j]) || !(mMasks[j] & mLayers[i]))
+                {
+                    continue;
+                }
+                if (b.y >= a.y + a.h || a.y >= b.y + b.h)
+                {
+                    continue;
+                }
+
+                bool iLow = mIds[i] < mIds[j];
+                Uint32 low = iLow ? i : j;
+                Uint32 high = iLow ? j : i;
+                Uint64 key = (static_cast<Uint64>(mIds[low]) << 32) | mIds[high];
+                mContacts.push_back(Contact{key, mLayers[low], mLayers[high]});
+            }
+        }
+        std::sort(mContacts.begin(), mContacts.end(), [](const Contact &l, const Contact &r)
+                  { return l.key < r.key; });
+    }
+
+    /*!
+     * \brief Merges the sorted previous and current contacts into enter, stay and exit events.
+     */
+    void Diff()
+    {
+        mEvents.clear();
+        size_t p = 0;
+        size_t c = 0;
+        while (p < mPrevious.size() || c < mContacts.size())
+        {
+            if (c == mContacts.size() || (p < mPrevious.size() && mPrevious[p].key < mContacts[c].key))
+            {
+                PushEvent(CollisionEventType::Exit, mPrevious[p++]);
+            }
+            else if (p == mPrevious.size() || mContacts[c].key < mPrevious[p].key)
+            {
+                PushEvent(CollisionEventType::Enter, mContacts[c++]);
+            }
+            else
+            {
+                PushEvent(CollisionEventType::Stay, mContacts[c++]);
+                p++;
+            }
+        }
+    }
+
+    /*!
+     * \brief Appends an event for a contact.
+     */
+    void PushEvent(CollisionEventType type, const Contact &contact)
+    {
+        mEvents.push_back(CollisionEvent{type, static_cast<Uint32>(contact.key >> 32), static_cast<Uint32>(contact.key),
+                                         contact.layerLow, contact.layerHigh});
+    }
+
+    /*!
+     * \brief Calls the matching handlers for every event of this frame.
+     */
+    void Dispatch()
+    {
+        for (const CollisionEvent &event : mEvents)
+        {
+            for (const HandlerEntry &entry : mHandlers)
+            {
+                if (entry.type != event.type)
+                {
+                    continue;
+                }
+                if ((event.layerA & entry.layerA) && (event.layerB & entry.layerB))
+                {
+                    entry.handler(event);
+                }
+                else if ((event.layerB & entry.layerA) && (event.layerA & entry.layerB))
+                {
+                    entry.handler(CollisionEvent{event.type, event.b, event.a, event.layerB, event.layerA});
+                }
+            }
+        }
+    }
+
+    std::vector<SDL_FRect> mBoxes;
+    std::vector<Uint32> mLayers;
+    std::vector<Uint32> mMasks;
+    std::vector<Uint32> mIds;
+    std::vector<Uint32> mOrder;
+    std::vector<Contact> mContacts;
+    std::vector<Contact> mPrevious;
+    std::vector<CollisionEvent> mEvents;
+    std::vector<HandlerEntry> mHandlers;
+};
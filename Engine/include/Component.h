@@ -1,17 +1,18 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "FramePacket.h"
 
 /*!
  * \class Component
  * \brief The Component class is an abstract base class for all components.
  *
  * This class defines the interface for components, provides a common interface for updating and rendering, which derived
- * components can override to implement their specific behavior.
+ * components can override to implement their specific behavior. Rendering records draw commands into a FramePacket.
  */
 class Component
 {
 public:
     virtual ~Component() = default;
     virtual void Update(float deltaTime) {}
-    virtual void Render(SDL_Renderer *renderer) {}
+    virtual void Render(FramePacket &packet) {}
 };
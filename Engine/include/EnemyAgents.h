@@ -0,0 +1,230 @@
+#pragma once
+#include "NavGraph.h"
+#include "PhysicsWorld.h"
+#include "PrototypeRegistry.h"
+#include "SceneSnapshot.h"
+#include "SpriteInstances.h"
+#include <SDL2/SDL.h>
+#include <cmath>
+#include <vector>
+
+/*!
+ * \class EnemyAgents
+ * \brief The EnemyAgents steer every chasing instance of a group toward a target across the platforms of a NavGraph.
+ *
+ * An agent is any live instance of a PROTOTYPE_CHASER prototype that has a physics body. Agents on the target's
+ * platform walk straight at it; the others follow the first link of their path: walk to the takeoff point, then jump or
+ * keep walking off the edge. Only grounded agents steer, so a jump or fall plays out under physics alone. A plan is
+ * only redone when the agent lands on another platform or the target changes platform, and at most kMaxPlansPerFrame
+ * agents re-plan per frame, round robin; the others keep moving as they were until their turn. The state is kept per
+ * instance index in parallel arrays and resized to the group, so it survives spawning and killing.
+ */
+class EnemyAgents
+{
+public:
+    static constexpr size_t kMaxPlansPerFrame = 64;
+
+    /*!
+     * \brief Sets the graph agents plan on. Must outlive the agents; forgets all plans.
+     */
+    void SetGraph(NavGraph *graph)
+    {
+        mGraph = graph;
+        std::fill(mPlanFrom.begin(), mPlanFrom.end(), NavGraph::kNoNode);
+    }
+
+    /*!
+     * \brief Sets how fast agents walk and how hard they jump.
+     */
+    void SetMovement(float speed, float jumpSpeed)
+    {
+        mSpeed = speed;
+        mJumpSpeed = jumpSpeed;
+    }
+
+    /*!
+     * \brief Steers every agent of a group. Call before the physics step, so the velocities set here move the bodies.
+     * \param instances The group; bodies must live in physics.
+     * \param physics The physics world.
+     * \param target The box to chase, e.g. the player.
+     * \param targetGrounded Whether the target stands on a platform. While it is in the air, agents keep chasing its
+     * last platform.
+     */
+    void Update(SpriteInstances &instances, PhysicsWorld &physics, const SDL_FRect &target, bool targetGrounded)
+    {
+        if (mGraph == nullptr)
+        {
+            return;
+        }
+        size_t count = instances.Size();
+        mNode.resize(count, NavGraph::kNoNode);
+        mPlanFrom.resize(count, NavGraph::kNoNode);
+        mPlanGoal.resize(count, NavGraph::kNoNode);
+        mLink.resize(count, NavGraph::kNoLink);
+        if (count == 0)
+        {
+            return;
+        }
+
+        float targetX = target.x + target.w * 0.5f;
+        if (targetGrounded)
+        {
+            Uint16 node = mGraph->FindNode(targetX, target.y + target.h);
+            if (node != NavGraph::kNoNode)
+            {
+                mTargetNode = node;
+            }
+        }
+
+        const PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+        size_t plans = 0;
+        size_t first = mCursor % count;
+        size_t resume = count;
+        for (size_t n = 0; n < count; n++)
+        {
+            size_t i = first + n < count ? first + n : first + n - count;
+            Uint32 body = instances.GetBody(i);
+            if (body == PhysicsWorld::kNoBody || !instances.IsAlive(i) ||
+                !(registry.Get(instances.GetPrototype(i)).flags & PROTOTYPE_CHASER) || !physics.IsGrounded(body))
+            {
+                continue;
+            }
+
+            SDL_FRect box = physics.GetBox(body);
+            float x = box.x + box.w * 0.5f;
+            Uint16 node = mGraph->FindNode(x, box.y + box.h);
+            mNode[i] = node;
+            if (node == NavGraph::kNoNode || mTargetNode == NavGraph::kNoNode)
+            {
+                continue;
+            }
+
+            if (node == mTargetNode)
+            {
+                WalkTo(physics, body, x, targetX);
+                continue;
+            }
+
+            if (mPlanFrom[i] != node || mPlanGoal[i] != mTargetNode)
+            {
+                if (plans == kMaxPlansPerFrame)
+                {
+                    // Out of budget: keep moving as before and start from the first such agent next frame
+                    if (resume == count)
+                    {
+                        resume = i;
+                    }
+                    continue;
+                }
+                plans++;
+                mLink[i] = mGraph->FindNextLink(node, mTargetNode);
+                mPlanFrom[i] = node;
+                mPlanGoal[i] = mTargetNode;
+            }
+            FollowLink(physics, body, x, mLink[i]);
+        }
+        mCursor = resume == count ? 0 : resume;
+    }
+
+    /*!
+     * \brief Gets the platform an agent last stood on, or NavGraph::kNoNode.
+     */
+    Uint16 GetNode(size_t i) const
+    {
+        return i < mNode.size() ? mNode[i] : NavGraph::kNoNode;
+    }
+
+    /*!
+     * \brief Gets the link an agent is following, or NavGraph::kNoLink.
+     */
+    Uint32 GetLink(size_t i) const
+    {
+        return i < mLink.size() ? mLink[i] : NavGraph::kNoLink;
+    }
+
+    /*!
+     * \brief Appends the state of every agent to a snapshot.
+     */
+    void Save(SceneSnapshot &snapshot) const
+    {
+        snapshot.WriteArray(mNode);
+        snapshot.WriteArray(mPlanFrom);
+        snapshot.WriteArray(mPlanGoal);
+        snapshot.WriteArray(mLink);
+        snapshot.Write(mTargetNode);
+        snapshot.Write(static_cast<Uint64>(mCursor));
+    }
+
+    /*!
+     * \brief Restores the state saved by Save, for the same graph.
+     * \return False if the snapshot is malformed.
+     */
+    bool Restore(SnapshotReader &reader)
+    {
+        Uint64 cursor = 0;
+        bool ok = reader.ReadArray(mNode) && reader.ReadArray(mPlanFrom) && reader.ReadArray(mPlanGoal) && reader.ReadArray(mLink) &&
+                  reader.Read(mTargetNode) && reader.Read(cursor);
+        mCursor = static_cast<size_t>(cursor);
+        return ok && mPlanFrom.size() == mNode.size() && mPlanGoal.size() == mNode.size() && mLink.size() == mNode.size();
+    }
+
+private:
+    /*!
+     * \brief Walks a body toward an X position, stopping when its center is close.
+     */
+    void WalkTo(PhysicsWorld &physics, Uint32 body, float x, float goalX)
+    {
+        float dx = goalX - x;
+        float vx = std::fabs(dx) < kArriveDistance ? 0.0f : (dx < 0.0f ? -mSpeed : mSpeed);
+        physics.SetVelocity(body, vx, physics.GetVelocityY(body));
+    }
+
+    /*!
+     * \brief Moves a grounded body along a link: to its takeoff point, then over it.
+     */
+    void FollowLink(PhysicsWorld &physics, Uint32 body, float x, Uint32 link)
+    {
+        if (link == NavGraph::kNoLink)
+        {
+            physics.SetVelocity(body, 0.0f, physics.GetVelocityY(body));
+            return;
+        }
+        const NavLink &navLink = mGraph->GetLink(link);
+        float dx = navLink.takeoffX - x;
+        if (std::fabs(dx) >= kArriveDistance)
+        {
+            physics.SetVelocity(body, dx < 0.0f ? -mSpeed : mSpeed, physics.GetVelocityY(body));
+            return;
+        }
+
+        float toLanding = navLink.landingX - navLink.takeoffX;
+        float vx = std::fabs(toLanding) < kArriveDistance ? 0.0f : (toLanding < 0.0f ? -mSpeed : mSpeed);
+        if (navLink.type == NavLinkType::Jump)
+        {
+            physics.SetVelocity(body, vx, -mJumpSpeed);
+            physics.SetGrounded(body, false);
+        }
+        else
+        {
+            // Walking and falling both just keep going; leaving the edge drops the body
+            if (vx == 0.0f)
+            {
+                vx = navLink.landingX < x ? -mSpeed : mSpeed;
+            }
+            physics.SetVelocity(body, vx, physics.GetVelocityY(body));
+        }
+    }
+
+    static constexpr float kArriveDistance = 4.0f;
+
+    NavGraph *mGraph{nullptr};
+    float mSpeed{90.0f};
+    float mJumpSpeed{520.0f};
+    Uint16 mTargetNode{NavGraph::kNoNode};
+    size_t mCursor{0};
+
+    std::vector<Uint16> mNode;
+    std::vector<Uint16> mPlanFrom;
+    std::vector<Uint16> mPlanGoal;
+    std::vector<Uint32> mLink;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*!
+ * \struct CapturedFrame
+ * \brief The pixels of a presented frame: height rows of width ARGB8888 pixels, without padding.
+ */
+struct CapturedFrame
+{
+    std::vector<Uint32> pixels;
+    int width{0};
+    int height{0};
+    Uint64 index{0}; //!< Number of the frame among those drawn by the render thread, from 1.
+};
+
+/*!
+ * \class FrameCapture
+ * \brief Hands captured frames from the render thread to readers without copying them.
+ *
+ * The render thread acquires a frame, fills it and publishes it; readers get shared ownership of the latest published
+ * frame and may keep it as long as they like. A frame is only reused for a later capture once nobody but the pool
+ * holds it any more, so a frame a reader holds never changes, and in the steady state no memory is allocated.
+ */
+class FrameCapture
+{
+public:
+    static constexpr size_t kPooledFrames = 4; //!< Free frames beyond this many are released.
+
+    /*!
+     * \brief Gets a frame to capture into. Only called on the render thread.
+     * \param width The width of the frame.
+     * \param height The height of the frame.
+     * \return A frame of that size nobody else holds; its pixels are undefined.
+     */
+    std::shared_ptr<CapturedFrame> Acquire(int width, int height)
+    {
+        std::shared_ptr<CapturedFrame> frame;
+        for (auto it = mPool.begin(); it != mPool.end();)
+        {
+            if (it->use_count() != 1)
+            {
+                ++it;
+            }
+            else if (frame == nullptr)
+            {
+                frame = *it++;
+            }
+            else if (mPool.size() > kPooledFrames)
+            {
+                it = mPool.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        if (frame)
+        {
+            // The last reader's reads of the pixels happen before our writes
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        else
+        {
+            frame = std::make_shared<CapturedFrame>();
+            mPool.push_back(frame);
+        }
+        frame->width = width;
+        frame->height = height;
+        frame->pixels.resize(static_cast<size_t>(width) * height);
+        return frame;
+    }
+
+    /*!
+     * \brief Makes a filled frame the latest one. Only called on the render thread.
+     */
+    void Publish(std::shared_ptr<CapturedFrame> frame)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLatest = std::move(frame);
+    }
+
+    /*!
+     * \brief Gets the latest published frame, or nullptr if none was captured yet. Safe to call from any thread.
+     */
+    std::shared_ptr<const CapturedFrame> GetLatest() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mLatest;
+    }
+
+    /*!
+     * \brief Forgets the latest frame, so it is not handed out again; readers keep the frames they hold.
+     */
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLatest.reset();
+    }
+
+private:
+    mutable std::mutex mMutex;
+    std::shared_ptr<CapturedFrame> mLatest;
+    std::vector<std::shared_ptr<CapturedFrame>> mPool; //!< Only touched on the render thread.
+};
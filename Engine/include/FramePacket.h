@@ -0,0 +1,238 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+
+/*!
+ * \struct SpriteDrawCommand
+ * \brief A single recorded sprite draw: which part of which texture to copy and where to put it.
+ */
+struct SpriteDrawCommand
+{
+    SDL_Texture *texture;
+    SDL_Rect source; //!< Part of the texture to copy; the whole texture if empty (w == 0).
+    SDL_FRect destination;
+};
+
+/*!
+ * \struct GeometryBatch
+ * \brief A recorded run of textured quads, drawn with a single SDL_RenderGeometry call.
+ */
+struct GeometryBatch
+{
+    SDL_Texture *texture; //!< May be null for untextured, vertex-colored quads.
+    size_t firstVertex;
+    size_t quadCount;
+};
+
+/*!
+ * \struct FrameTiming
+ * \brief Timestamps that travel with a frame from input sampling to present, used for latency measurement.
+ */
+struct FrameTiming
+{
+    Uint64 sampleCounter{0};
+    Uint32 inputTicks{0};
+    Uint64 presentCounter{0};
+    Uint32 presentTicks{0};
+    double renderMs{0.0}; //!< Render thread time spent drawing the frame, up to but excluding the present.
+};
+
+/*!
+ * \class FramePacket
+ * \brief The FramePacket class is a list of render commands recorded by the simulation for one frame.
+ *
+ * Scenes and entities never talk to the SDL_Renderer directly; they record their draws into a FramePacket, which is
+ * later executed on the thread that owns the renderer. The command vectors keep their capacity between frames, so
+ * recording a frame does not allocate once the packet has warmed up. Quad batches are drawn after all sprites.
+ *
+ * A frame has two layers. The scene is everything recorded before BeginOverlay; it may be drawn at a reduced render
+ * scale and stretched to the window. The overlay, recorded after it, is always drawn at the window's resolution on top,
+ * so text stays sharp. Each layer draws its sprites, then its quad batches.
+ */
+class FramePacket
+{
+public:
+    /*!
+     * \brief Clears all recorded commands, keeping the allocated storage.
+     */
+    void Clear()
+    {
+        mSprites.clear();
+        mBatches.clear();
+        mVertexCount = 0;
+        mClearColor = SDL_Color{0, 0, 0, SDL_ALPHA_OPAQUE};
+        mSceneSprites = kNoOverlay;
+        mSceneBatches = kNoOverlay;
+        mRenderScale = 1.0f;
+        timing = FrameTiming{};
+    }
+
+    /*!
+     * \brief Ends the scene layer; everything recorded from now on belongs to the overlay. Later calls do nothing.
+     */
+    void BeginOverlay()
+    {
+        if (mSceneSprites != kNoOverlay)
+        {
+            return;
+        }
+        mSceneSprites = mSprites.size();
+        mSceneBatches = mBatches.size();
+    }
+
+    /*!
+     * \brief Gets the number of sprites of the scene layer; the rest belong to the overlay.
+     */
+    size_t GetSceneSpriteCount() const
+    {
+        return mSceneSprites == kNoOverlay ? mSprites.size() : mSceneSprites;
+    }
+
+    /*!
+     * \brief Gets the number of quad batches of the scene layer; the rest belong to the overlay.
+     */
+    size_t GetSceneBatchCount() const
+    {
+        return mSceneBatches == kNoOverlay ? mBatches.size() : mSceneBatches;
+    }
+
+    /*!
+     * \brief Sets the fraction of the window's resolution the scene layer is rendered at.
+     * \param scale From 0 to 1; 1 draws straight into the window.
+     */
+    void SetRenderScale(float scale)
+    {
+        mRenderScale = scale;
+    }
+
+    /*!
+     * \brief Gets the fraction of the window's resolution the scene layer is rendered at.
+     */
+    float GetRenderScale() const
+    {
+        return mRenderScale;
+    }
+
+    /*!
+     * \brief Sets the color the frame is cleared to before any sprite is drawn.
+     */
+    void SetClearColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+    {
+        mClearColor = SDL_Color{r, g, b, a};
+    }
+
+    /*!
+     * \brief Records a sprite draw.
+     * \param texture The texture to draw.
+     * \param destination Where to draw the texture, in window coordinates.
+     */
+    void DrawSprite(SDL_Texture *texture, const SDL_FRect &destination)
+    {
+        mSprites.push_back(SpriteDrawCommand{texture, SDL_Rect{0, 0, 0, 0}, destination});
+    }
+
+    /*!
+     * \brief Records a draw of part of a texture, e.g. one frame of a spritesheet.
+     * \param texture The texture to draw.
+     * \param source The part of the texture to draw; the whole texture if empty (w == 0).
+     * \param destination Where to draw it, in window coordinates.
+     */
+    void DrawSprite(SDL_Texture *texture, const SDL_Rect &source, const SDL_FRect &destination)
+    {
+        mSprites.push_back(SpriteDrawCommand{texture, source, destination});
+    }
+
+    /*!
+     * \brief Records a batch of quads and returns their vertices for the caller to fill.
+     * \param texture The texture of every quad; null for untextured quads.
+     * \param quadCount The number of quads.
+     * \return Four vertices per quad, in the order top-left, top-right, bottom-right, bottom-left. Valid until the
+     * next DrawQuads or Clear.
+     */
+    SDL_Vertex *DrawQuads(SDL_Texture *texture, size_t quadCount)
+    {
+        size_t first = mVertexCount;
+        mVertexCount += quadCount * 4;
+        if (mVertices.size() < mVertexCount)
+        {
+            mVertices.resize(mVertexCount);
+        }
+        if (mQuadIndices.size() < quadCount * 6)
+        {
+            // Every batch indexes from its own first vertex, so one shared index list serves all of them
+            size_t quads = mQuadIndices.size() / 6;
+            mQuadIndices.resize(quadCount * 6);
+            for (size_t q = quads; q < quadCount; q++)
+            {
+                int v = static_cast<int>(q * 4);
+                int *index = &mQuadIndices[q * 6];
+                index[0] = v;
+                index[1] = v + 1;
+                index[2] = v + 2;
+                index[3] = v + 2;
+                index[4] = v + 3;
+                index[5] = v;
+            }
+        }
+        mBatches.push_back(GeometryBatch{texture, first, quadCount});
+        return mVertices.data() + first;
+    }
+
+    /*!
+     * \brief Gets the recorded quad batches, in submission order.
+     */
+    const std::vector<GeometryBatch> &GetBatches() const
+    {
+        return mBatches;
+    }
+
+    /*!
+     * \brief Gets the vertices of all quad batches.
+     */
+    const SDL_Vertex *GetVertices() const
+    {
+        return mVertices.data();
+    }
+
+    /*!
+     * \brief Gets the triangle indices of a batch of quads, relative to the batch's first vertex.
+     */
+    const int *GetQuadIndices() const
+    {
+        return mQuadIndices.data();
+    }
+
+    /*!
+     * \brief Gets the recorded sprite draws, in submission order.
+     */
+    const std::vector<SpriteDrawCommand> &GetSprites() const
+    {
+        return mSprites;
+    }
+
+    /*!
+     * \brief Gets the clear color of the frame.
+     */
+    SDL_Color GetClearColor() const
+    {
+        return mClearColor;
+    }
+
+    /*!
+     * \brief Timing information for this frame, filled by the main loop and the render thread.
+     */
+    FrameTiming timing;
+
+private:
+    static constexpr size_t kNoOverlay = static_cast<size_t>(-1);
+
+    std::vector<SpriteDrawCommand> mSprites;
+    std::vector<GeometryBatch> mBatches;
+    std::vector<SDL_Vertex> mVertices; //!< Only grows; the first mVertexCount are this frame's.
+    size_t mVertexCount{0};
+    std::vector<int> mQuadIndices;
+    SDL_Color mClearColor{0, 0, 0, SDL_ALPHA_OPAQUE};
+    size_t mSceneSprites{kNoOverlay};
+    size_t mSceneBatches{kNoOverlay};
+    float mRenderScale{1.0f};
+};
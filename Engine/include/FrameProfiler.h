@@ -0,0 +1,150 @@
+#pragma once
+#include "FramePacket.h"
+#include "Logger.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+
+/*!
+ * \class FrameProfiler
+ * \brief The FrameProfiler class measures frame timings of the main loop and reports them once per second.
+ *
+ * Besides the frame time, it tracks input-to-present latency: the time from the oldest input event consumed in a
+ * frame (using the SDL event timestamp) until SDL_RenderPresent returns for that frame on the render thread. Frames
+ * without input events still report the time from input sampling to present, which is the latency a held key sees.
+ * The frame time is the simulation thread's time from BeginFrame to MarkSubmitted.
+ */
+class FrameProfiler
+{
+public:
+    /*!
+     * \brief Marks the start of a frame's work, after any frame-cap sleep.
+     * \param sleptMs How long the loop slept before this frame.
+     */
+    void BeginFrame(double sleptMs)
+    {
+        mFrameStart = SDL_GetPerformanceCounter();
+        mSleepMs += sleptMs;
+    }
+
+    /*!
+     * \brief Marks the moment input was sampled for this frame.
+     * \param oldestEventTicks SDL timestamp of the oldest input event consumed this frame, or 0 if there was none.
+     */
+    void MarkInputSampled(Uint32 oldestEventTicks)
+    {
+        mSampleCounter = SDL_GetPerformanceCounter();
+        mInputTicks = oldestEventTicks;
+    }
+
+    /*!
+     * \brief Copies the input timestamps of the current frame into the frame's timing, so they reach the render thread.
+     * \param timing The timing of the frame packet being recorded.
+     */
+    void FillTiming(FrameTiming &timing) const
+    {
+        timing.sampleCounter = mSampleCounter;
+        timing.inputTicks = mInputTicks;
+    }
+
+    /*!
+     * \brief Marks the end of the simulation thread's work for the frame, right after the packet was submitted.
+     */
+    void MarkSubmitted()
+    {
+        double toMs = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+        mLastFrameMs = (SDL_GetPerformanceCounter() - mFrameStart) * toMs;
+        mFrames++;
+        mFrameSum += mLastFrameMs;
+        mFrameMax = std::max(mFrameMax, mLastFrameMs);
+    }
+
+    /*!
+     * \brief Records the latency of a frame the render thread has presented.
+     * \param timing The timing of the presented frame, with the present timestamps filled in.
+     */
+    void MarkPresented(const FrameTiming &timing)
+    {
+        double toMs = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+        mLastSampleToPresentMs = (timing.presentCounter - timing.sampleCounter) * toMs;
+        mSampleSum += mLastSampleToPresentMs;
+        mPresented++;
+        mLastInputToPresentMs = -1.0;
+        if (timing.inputTicks != 0)
+        {
+            mLastInputToPresentMs = timing.presentTicks >= timing.inputTicks ? static_cast<double>(timing.presentTicks - timing.inputTicks) : 0.0;
+            mLatencySum += mLastInputToPresentMs;
+            mLatencyMax = std::max(mLatencyMax, mLastInputToPresentMs);
+            mLatencySamples++;
+        }
+        LOG_DEBUG("frame %.2f ms, sample-to-present %.2f ms, input-to-present %.2f ms", mLastFrameMs, mLastSampleToPresentMs, mLastInputToPresentMs);
+    }
+
+    /*!
+     * \brief Logs the statistics gathered since the last report and resets them.
+     * \return The number of frames in the reported window.
+     */
+    Uint64 Report()
+    {
+        Uint64 frames = mFrames;
+        if (frames > 0)
+        {
+            LOG_INFO("fps %llu | frame avg %.2f ms max %.2f ms | sample-to-present avg %.2f ms | input-to-present avg %.2f ms max %.2f ms (%llu events) | slept %.1f ms",
+                     static_cast<unsigned long long>(frames), mFrameSum / frames, mFrameMax, mPresented ? mSampleSum / mPresented : 0.0,
+                     mLatencySamples ? mLatencySum / mLatencySamples : 0.0, mLatencyMax,
+                     static_cast<unsigned long long>(mLatencySamples), mSleepMs);
+        }
+        mFrames = 0;
+        mFrameSum = mFrameMax = mSampleSum = mSleepMs = 0.0;
+        mLatencySum = mLatencyMax = 0.0;
+        mLatencySamples = 0;
+        mPresented = 0;
+        return frames;
+    }
+
+    /*!
+     * \brief Gets the duration of the last frame, from BeginFrame to MarkSubmitted.
+     * \return The frame time in milliseconds.
+     */
+    double GetLastFrameMs() const
+    {
+        return mLastFrameMs;
+    }
+
+    /*!
+     * \brief Gets the input-to-present latency of the last frame.
+     * \return The latency in milliseconds, or -1 if no input event was consumed in the last presented frame.
+     */
+    double GetLastInputToPresentMs() const
+    {
+        return mLastInputToPresentMs;
+    }
+
+    /*!
+     * \brief Gets the time from input sampling to present of the last presented frame.
+     * \return The latency in milliseconds.
+     */
+    double GetLastSampleToPresentMs() const
+    {
+        return mLastSampleToPresentMs;
+    }
+
+private:
+    Uint64 mFrameStart{0};
+    Uint64 mSampleCounter{0};
+    Uint32 mInputTicks{0};
+
+    double mLastFrameMs{0.0};
+    double mLastSampleToPresentMs{0.0};
+    double mLastInputToPresentMs{-1.0};
+
+    Uint64 mFrames{0};
+    Uint64 mPresented{0};
+    double mFrameSum{0.0};
+    double mFrameMax{0.0};
+    double mSampleSum{0.0};
+    double mSleepMs{0.0};
+    double mLatencySum{0.0};
+    double mLatencyMax{0.0};
+    Uint64 mLatencySamples{0};
+};
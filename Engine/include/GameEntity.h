@@ -50,11 +50,11 @@ public:
 
     /*!
      * \brief Renders the entity and its components.
-     * \param renderer The SDL renderer to draw to.
+     * \param packet The frame packet to record draw commands into.
      *
      * If the entity is marked as renderable, iterates over all components and renders each one.
      */
-    virtual void Render(SDL_Renderer *renderer)
+    virtual void Render(FramePacket &packet)
     {
         if (!mRenderable)
         {
@@ -63,7 +63,7 @@ public:
 
         for (auto &comp : components)
         {
-            comp->Render(renderer);
+            comp->Render(packet);
         }
     }
 
@@ -165,6 +165,28 @@ public:
         return false;
     }
 
+    /*!
+     * \brief Checks if the entity intersects with a rectangle.
+     * \param rectangle The rectangle to check intersection with, for example the collision box of a sprite instance.
+     * \return True if there is an intersection, false otherwise.
+     */
+    bool Intersects(const SDL_FRect &rectangle) const
+    {
+        auto ourSprite = GetComponent<SpriteComponent>();
+        if (ourSprite)
+        {
+            SDL_Rect source = ConvertFRectToRect(rectangle);
+            SDL_Rect us = ConvertFRectToRect(ourSprite->GetRectangle());
+            SDL_Rect result;
+            if (SDL_IntersectRect(&source, &us, &result))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     /*!
      * \brief Converts an SDL_FRect to SDL_Rect by casting float values to ints.
      * \param frect The floating point rectangle to convert.
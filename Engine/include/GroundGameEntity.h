@@ -33,7 +33,7 @@ struct GroundGameEntity : public GameEntity
         }
     }
 
-    virtual void Render(SDL_Renderer *renderer) override
+    virtual void Render(FramePacket &packet) override
     {
         if (!mRenderable)
         {
@@ -43,7 +43,7 @@ struct GroundGameEntity : public GameEntity
         auto spriteComponent = this->GetComponent<SpriteComponent>();
         if (spriteComponent)
         {
-            spriteComponent->Render(renderer);
+            spriteComponent->Render(packet);
         }
     }
 
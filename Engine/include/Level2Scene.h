@@ -6,7 +6,8 @@
  * \brief The Level2Scene class sets up and manages the second level of the game.
  *
  * Inherits from BaseScene and implements the SetupLevel method to create a specific game level, including
- * initializing enemies and food items at positions defined in a configuration file.
+ * initializing enemies and food items at positions defined in a configuration file. With enemy_patrol_ticks set, the
+ * enemies float back and forth, each driven by a script that flips its direction every enemy_patrol_ticks ticks.
  */
 class Level2Scene : public BaseScene
 {
@@ -17,35 +18,63 @@ class Level2Scene : public BaseScene
      *
      * Overrides the SetupLevel method from BaseScene to initialize the level with enemies and food items
      * based on positions defined in the "Config/level1_config.txt" file. Utilizes the ConfigManager to
-     * load the configuration and create game entities accordingly.
+     * load the configuration and spawn enemy and food instances accordingly.
      */
     void SetupLevel() override
     {
         ConfigManager configManager;
         auto config = configManager.LoadConfig("Config/level2_config.txt");
 
-        // Create enemies based on config
-        int enemyIndex = 1;
-        while (config.find("enemy" + std::to_string(enemyIndex) + "_x") != config.end())
+        // Create enemies and foods based on config
+        SpawnFromConfig(config, "enemy", mEnemyPrototype, enemies);
+        SpawnFromConfig(config, "food", mFoodPrototype, foods);
+
+        mPatrolTicks = static_cast<Uint32>(std::max(0, config["enemy_patrol_ticks"]));
+        mPatrolSpeed = static_cast<float>(config["enemy_patrol_speed"]);
+        if (mPatrolTicks > 0)
         {
-            auto enemy = std::make_unique<EnemyGameEntity>(mRenderer);
-            float x = config["enemy" + std::to_string(enemyIndex) + "_x"];
-            float y = config["enemy" + std::to_string(enemyIndex) + "_y"];
-            enemy->GetComponent<SpriteComponent>()->Move(static_cast<int>(x), static_cast<int>(y));
-            enemies.push_back(std::move(enemy));
-            enemyIndex++;
+            for (size_t i = 0; i < enemies.Size(); i++)
+            {
+                enemies.EnablePhysics(i, 0.0f);
+            }
         }
+    }
 
-        // Create foods based on config
-        int foodIndex = 1;
-        while (config.find("food" + std::to_string(foodIndex) + "_x") != config.end())
+    /*!
+     * \brief Starts a patrol script per enemy when the level has patrols.
+     */
+    void StartScripts() override
+    {
+        if (mPatrolTicks == 0)
+        {
+            return;
+        }
+        for (size_t i = 0; i < enemies.Size(); i++)
         {
-            auto food = std::make_unique<FoodGameEntity>(mRenderer);
-            float x = config["food" + std::to_string(foodIndex) + "_x"];
-            float y = config["food" + std::to_string(foodIndex) + "_y"];
-            food->GetComponent<SpriteComponent>()->Move(static_cast<int>(x), static_cast<int>(y));
-            foods.push_back(std::move(food));
-            foodIndex++;
+            scripts.Spawn(Patrol(scripts, enemies.GetHandle(i)));
         }
     }
+
+    /*!
+     * \brief Moves an enemy one way for mPatrolTicks ticks, then back, until it dies. The script only wakes to turn,
+     * so a patrolling enemy costs nothing on the ticks in between. The handle makes the script stop once its enemy is
+     * killed, even if a later spawn reuses the slot.
+     */
+    ScriptTask Patrol(ScriptScheduler &, InstanceHandle enemy)
+    {
+        float direction = 1.0f;
+        while (enemies.IsAlive(enemy))
+        {
+            Uint32 body = enemies.GetBody(enemy.index);
+            if (body != PhysicsWorld::kNoBody)
+            {
+                physics.SetVelocity(body, direction * mPatrolSpeed, 0.0f);
+            }
+            co_await ScriptScheduler::Ticks(mPatrolTicks);
+            direction = -direction;
+        }
+    }
+
+    Uint32 mPatrolTicks{0};
+    float mPatrolSpeed{0.0f};
 };
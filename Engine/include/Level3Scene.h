@@ -6,7 +6,9 @@
  * \brief The Level3Scene class sets up and manages the third level of the game.
  *
  * Inherits from BaseScene and implements the SetupLevel method to create a specific game level, including
- * initializing enemies and food items at positions defined in a configuration file.
+ * initializing enemies and food items at positions defined in a configuration file. With enemy_wave_ticks set, a
+ * repeating timer brings in a wave of enemies at the wave positions every enemy_wave_ticks ticks, as long as fewer than
+ * enemy_wave_max enemies are alive.
  */
 class Level3Scene : public BaseScene
 {
@@ -16,36 +18,48 @@ class Level3Scene : public BaseScene
      * \brief Sets up the level-specific entities and environment.
      *
      * Overrides the SetupLevel method from BaseScene to initialize the level with enemies and food items
-     * based on positions defined in the "Config/level1_config.txt" file. Utilizes the ConfigManager to
-     * load the configuration and create game entities accordingly.
+     * based on positions defined in the "Config/level3_config.txt" file. Utilizes the ConfigManager to
+     * load the configuration and spawn enemy and food instances accordingly.
      */
     void SetupLevel() override
     {
         ConfigManager configManager;
-        auto config = configManager.LoadConfig("Config/level3_config.txt");
+        mConfig = configManager.LoadConfig("Config/level3_config.txt");
 
-        // Create enemies based on config
-        int enemyIndex = 1;
-        while (config.find("enemy" + std::to_string(enemyIndex) + "_x") != config.end())
+        // Create enemies and foods based on config; with enemy_chase=1 the enemies hunt the player
+        mWavePrototype = mConfig["enemy_chase"] != 0 ? mChaserPrototype : mEnemyPrototype;
+        SpawnFromConfig(mConfig, "enemy", mWavePrototype, enemies);
+        SpawnFromConfig(mConfig, "food", mFoodPrototype, foods);
+    }
+
+    /*!
+     * \brief Schedules the enemy waves. The timer repeats, so the level costs nothing between waves.
+     */
+    void StartScripts() override
+    {
+        Uint32 period = static_cast<Uint32>(std::max(0, mConfig["enemy_wave_ticks"]));
+        if (period == 0)
         {
-            auto enemy = std::make_unique<EnemyGameEntity>(mRenderer);
-            float x = config["enemy" + std::to_string(enemyIndex) + "_x"];
-            float y = config["enemy" + std::to_string(enemyIndex) + "_y"];
-            enemy->GetComponent<SpriteComponent>()->Move(static_cast<int>(x), static_cast<int>(y));
-            enemies.push_back(std::move(enemy));
-            enemyIndex++;
+            return;
         }
-
-        // Create foods based on config
-        int foodIndex = 1;
-        while (config.find("food" + std::to_string(foodIndex) + "_x") != config.end())
+        size_t maxEnemies = static_cast<size_t>(std::max(0, mConfig["enemy_wave_max"]));
+        // Waves only come while fewer than maxEnemies are alive and reuse dead slots, so this many slots always do;
+        // reserving them keeps in-game spawns from moving the arrays under views held by Python
+        size_t waveSize = 0;
+        while (mConfig.count("wave" + std::to_string(waveSize + 1) + "_x") != 0)
         {
-            auto food = std::make_unique<FoodGameEntity>(mRenderer);
-            float x = config["food" + std::to_string(foodIndex) + "_x"];
-            float y = config["food" + std::to_string(foodIndex) + "_y"];
-            food->GetComponent<SpriteComponent>()->Move(static_cast<int>(x), static_cast<int>(y));
-            foods.push_back(std::move(food));
-            foodIndex++;
+            waveSize++;
         }
+        enemies.Reserve(std::max(enemies.Size(), maxEnemies + waveSize));
+        timers.Schedule(period, [this, maxEnemies]()
+                        {
+            // Decided from the live count, so a restored scene keeps the same cap without extra state
+            if (enemies.GetLiveCount() < maxEnemies)
+            {
+                SpawnFromConfig(mConfig, "wave", mWavePrototype, enemies);
+            } }, period);
     }
+
+    std::unordered_map<std::string, int> mConfig;
+    Uint16 mWavePrototype{0};
 };
@@ -0,0 +1,365 @@
+#pragma once
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*!
+ * \brief Compile-time log levels. Messages below ENGINE_LOG_LEVEL are removed by the preprocessor.
+ */
+#define ENGINE_LOG_LEVEL_DEBUG 0
+#define ENGINE_LOG_LEVEL_INFO 1
+#define ENGINE_LOG_LEVEL_WARN 2
+#define ENGINE_LOG_LEVEL_ERROR 3
+#define ENGINE_LOG_LEVEL_NONE 4
+
+#ifndef ENGINE_LOG_LEVEL
+#define ENGINE_LOG_LEVEL ENGINE_LOG_LEVEL_INFO
+#endif
+
+/*!
+ * \enum LogLevel
+ * \brief Severity of a log record.
+ */
+enum class LogLevel : int
+{
+    Debug = ENGINE_LOG_LEVEL_DEBUG,
+    Info = ENGINE_LOG_LEVEL_INFO,
+    Warn = ENGINE_LOG_LEVEL_WARN,
+    Error = ENGINE_LOG_LEVEL_ERROR
+};
+
+/*!
+ * \struct LogString
+ * \brief Fixed-size copy of a string argument, so the caller's buffer may die before the record is formatted.
+ */
+struct LogString
+{
+    static constexpr size_t kCapacity = 96;
+    char text[kCapacity];
+
+    explicit LogString(const char *value)
+    {
+        if (value == nullptr)
+        {
+            value = "(null)";
+        }
+        std::strncpy(text, value, kCapacity - 1);
+        text[kCapacity - 1] = '\0';
+    }
+};
+
+/*!
+ * \brief Maps a log argument to the type stored in the ring buffer and back to the value handed to snprintf.
+ *
+ * Arithmetic values and pointers are stored as-is; C strings and std::string are copied into a LogString.
+ */
+template <typename T>
+struct LogArg
+{
+    using Stored = T;
+    static const T &Capture(const T &value) { return value; }
+    static const T &Unwrap(const T &value) { return value; }
+};
+
+template <>
+struct LogArg<const char *>
+{
+    using Stored = LogString;
+    static LogString Capture(const char *value) { return LogString(value); }
+    static const char *Unwrap(const LogString &value) { return value.text; }
+};
+
+template <>
+struct LogArg<char *> : LogArg<const char *>
+{
+};
+
+template <>
+struct LogArg<std::string>
+{
+    using Stored = LogString;
+    static LogString Capture(const std::string &value) { return LogString(value.c_str()); }
+    static const char *Unwrap(const LogString &value) { return value.text; }
+};
+
+template <typename T>
+using LogArgOf = LogArg<std::decay_t<T>>;
+
+/*!
+ * \struct LogRecord
+ * \brief One slot of the logger's ring buffer.
+ *
+ * Holds the raw format string and the captured arguments; the text is only produced on the logger thread.
+ */
+struct LogRecord
+{
+    static constexpr size_t kPayloadSize = 200;
+
+    std::atomic<size_t> sequence{0};
+    LogLevel level{LogLevel::Info};
+    Uint64 timestampNs{0};
+    const char *format{nullptr};
+    void (*formatter)(const LogRecord &record, char *out, size_t size){nullptr};
+    alignas(std::max_align_t) unsigned char payload[kPayloadSize];
+};
+
+/*!
+ * \class LogRateLimiter
+ * \brief Lets at most a fixed number of messages through per second; used by the *_RATE macros, one per call site.
+ */
+class LogRateLimiter
+{
+public:
+    explicit LogRateLimiter(Uint32 perSecond) : mPerSecond(perSecond) {}
+
+    /*!
+     * \brief Checks whether another message may be logged in the current one-second window.
+     * \return True if the message should be logged.
+     */
+    bool Allow()
+    {
+        Uint64 now = static_cast<Uint64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+        Uint64 windowStart = mWindowStart.load(std::memory_order_relaxed);
+        if (now - windowStart >= 1000 && mWindowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+        {
+            mCount.store(0, std::memory_order_relaxed);
+        }
+        if (mCount.fetch_add(1, std::memory_order_relaxed) < mPerSecond)
+        {
+            return true;
+        }
+        mSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /*!
+     * \brief Returns the number of messages dropped by this limiter so far.
+     */
+    Uint64 GetSuppressed() const
+    {
+        return mSuppressed.load(std::memory_order_relaxed);
+    }
+
+private:
+    Uint32 mPerSecond;
+    std::atomic<Uint64> mWindowStart{0};
+    std::atomic<Uint32> mCount{0};
+    std::atomic<Uint64> mSuppressed{0};
+};
+
+/*!
+ * \class Logger
+ * \brief Asynchronous logger backed by a lock-free multi-producer single-consumer ring buffer.
+ *
+ * Any thread may log; a call only copies the format pointer and arguments into a ring slot. A background thread
+ * formats the records and writes them to stderr in batches. When the ring is full, records are dropped and counted
+ * instead of blocking the caller. SDL's own log output is routed through the same queue once StartUp has been called.
+ * Like ResourceManager, the Logger is a singleton.
+ */
+class Logger
+{
+private:
+    Logger();
+    Logger(Logger const &);
+    void operator=(Logger const &);
+
+    static constexpr size_t kCapacity = 4096;
+    static constexpr size_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "Logger capacity must be a power of two");
+
+    LogRecord mRecords[kCapacity];
+    alignas(64) std::atomic<size_t> mEnqueuePos{0};
+    alignas(64) size_t mDequeuePos{0};
+    std::atomic<Uint64> mDropped{0};
+    std::atomic<bool> mRunning{false};
+    std::atomic<Uint32> mProducers{0}; //!< Calls between checking mRunning and publishing; ShutDown waits for them.
+    std::thread mThread;
+    SDL_LogOutputFunction mPreviousOutput{nullptr};
+    void *mPreviousUserdata{nullptr};
+
+    /*!
+     * \brief Claims a free slot for writing.
+     * \param pos Receives the claimed position, passed back to Publish.
+     * \return The slot, or nullptr if the ring is full.
+     */
+    LogRecord *Acquire(size_t &pos);
+
+    /*!
+     * \brief Makes a slot written by a producer visible to the logger thread.
+     */
+    void Publish(LogRecord *record, size_t pos);
+
+    /*!
+     * \brief Formats and writes every record currently in the ring.
+     * \return The number of records written.
+     */
+    size_t Drain();
+
+    /*!
+     * \brief Body of the background thread: drains the ring until ShutDown is called.
+     */
+    void Run();
+
+    /*!
+     * \brief Writes one fully formatted line to stderr.
+     */
+    static void Write(LogLevel level, Uint64 timestampNs, const char *message);
+
+    static Uint64 Now();
+    static void SDLOutput(void *userdata, int category, SDL_LogPriority priority, const char *message);
+    static void FormatMessage(const LogRecord &record, char *out, size_t size);
+
+    template <typename Tuple, size_t... I>
+    static void FormatTuple(const LogRecord &record, char *out, size_t size, std::index_sequence<I...>)
+    {
+        const Tuple &args = *std::launder(reinterpret_cast<const Tuple *>(record.payload));
+        std::snprintf(out, size, record.format, LogArg<std::tuple_element_t<I, typename Tuple::Base>>::Unwrap(std::get<I>(args.values))...);
+    }
+
+    template <typename... Args>
+    struct Captured
+    {
+        using Base = std::tuple<Args...>;
+        std::tuple<typename LogArg<Args>::Stored...> values;
+
+        static void Format(const LogRecord &record, char *out, size_t size)
+        {
+            FormatTuple<Captured>(record, out, size, std::index_sequence_for<Args...>{});
+        }
+    };
+
+public:
+    /*!
+     * \brief Retrieves the singleton instance of Logger.
+     * \return Reference to the singleton Logger instance.
+     */
+    static Logger &GetInstance();
+
+    /*!
+     * \brief Starts the background thread and routes SDL's log output into the logger.
+     * \return 0 on success.
+     */
+    int StartUp();
+
+    /*!
+     * \brief Writes out every pending record, stops the background thread and restores SDL's log output.
+     * \return 0 on success.
+     */
+    int ShutDown();
+
+    /*!
+     * \brief Returns the number of records dropped because the ring was full.
+     */
+    Uint64 GetDroppedCount() const
+    {
+        return mDropped.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Queues a printf-style message.
+     * \param level The severity of the message.
+     * \param format A printf format string. It must outlive the logger (a string literal).
+     * \param args Arguments for the format string; strings are copied, everything else is stored by value.
+     *
+     * Formatting happens later on the logger thread. Before StartUp, or after ShutDown, the message is
+     * formatted and written synchronously.
+     */
+    template <typename... Args>
+    void Log(LogLevel level, const char *format, Args &&...args)
+    {
+        using Record = Captured<std::decay_t<Args>...>;
+        static_assert(sizeof(Record) <= LogRecord::kPayloadSize, "Too many log arguments for one record");
+        static_assert(std::is_trivially_destructible<Record>::value, "Log arguments must be trivially destructible");
+
+        // Counted before checking mRunning, so ShutDown either sees this call or this call sees ShutDown
+        mProducers.fetch_add(1, std::memory_order_seq_cst);
+        if (!mRunning.load(std::memory_order_seq_cst))
+        {
+            mProducers.fetch_sub(1, std::memory_order_release);
+            LogRecord record;
+            record.level = level;
+            record.timestampNs = Now();
+            record.format = format;
+            new (record.payload) Record{{LogArgOf<Args>::Capture(args)...}};
+            char message[512];
+            Record::Format(record, message, sizeof(message));
+            Write(level, record.timestampNs, message);
+            return;
+        }
+
+        size_t pos;
+        LogRecord *record = Acquire(pos);
+        if (record == nullptr)
+        {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            record->level = level;
+            record->timestampNs = Now();
+            record->format = format;
+            record->formatter = &Record::Format;
+            new (record->payload) Record{{LogArgOf<Args>::Capture(args)...}};
+            Publish(record, pos);
+        }
+        mProducers.fetch_sub(1, std::memory_order_release);
+    }
+};
+
+#define ENGINE_LOG_RATE_LIMITED(level, perSecond, ...)                 \
+    do                                                                 \
+    {                                                                  \
+        static LogRateLimiter engineLogLimiter(perSecond);             \
+        if (engineLogLimiter.Allow())                                  \
+        {                                                              \
+            Logger::GetInstance().Log(level, __VA_ARGS__);             \
+        }                                                              \
+    } while (0)
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::GetInstance().Log(LogLevel::Debug, __VA_ARGS__)
+#define LOG_DEBUG_RATE(perSecond, ...) ENGINE_LOG_RATE_LIMITED(LogLevel::Debug, perSecond, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#define LOG_DEBUG_RATE(perSecond, ...) ((void)0)
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::GetInstance().Log(LogLevel::Info, __VA_ARGS__)
+#define LOG_INFO_RATE(perSecond, ...) ENGINE_LOG_RATE_LIMITED(LogLevel::Info, perSecond, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#define LOG_INFO_RATE(perSecond, ...) ((void)0)
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::GetInstance().Log(LogLevel::Warn, __VA_ARGS__)
+#define LOG_WARN_RATE(perSecond, ...) ENGINE_LOG_RATE_LIMITED(LogLevel::Warn, perSecond, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#define LOG_WARN_RATE(perSecond, ...) ((void)0)
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::GetInstance().Log(LogLevel::Error, __VA_ARGS__)
+#define LOG_ERROR_RATE(perSecond, ...) ENGINE_LOG_RATE_LIMITED(LogLevel::Error, perSecond, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#define LOG_ERROR_RATE(perSecond, ...) ((void)0)
+#endif
+
+#endif // LOGGER_H
@@ -0,0 +1,347 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*!
+ * \brief How an agent gets from one platform to another.
+ */
+enum class NavLinkType : Uint8
+{
+    Walk, //!< The platforms touch; walk across.
+    Jump, //!< Jump from the takeoff point; the target is above or across a gap.
+    Fall  //!< Walk off the edge at the takeoff point and drop onto the target.
+};
+
+/*!
+ * \struct NavLink
+ * \brief A directed link between two platforms of a NavGraph.
+ */
+struct NavLink
+{
+    Uint16 from;
+    Uint16 to;
+    NavLinkType type;
+    float takeoffX; //!< Where on the source platform the agent's center starts the move.
+    float landingX; //!< Where on the target platform the agent's center ends up.
+    float cost;
+};
+
+/*!
+ * \class NavGraph
+ * \brief The NavGraph connects the walkable tops of a level's platforms for agents that walk, jump and fall.
+ *
+ * Every platform top is a node; agents walk freely along it. Links between nodes are found once when the level is
+ * built: walk links between touching platforms, fall links from each edge to the highest platform below it, and jump
+ * links to platforms within jump reach. Paths are found with A* over the nodes. Search storage is allocated once per
+ * graph and stamped with a search number instead of being cleared, and the first link of every path found is cached
+ * per (start, goal) pair, so most queries after the first few are a table lookup.
+ */
+class NavGraph
+{
+public:
+    static constexpr Uint16 kNoNode = 0xFFFF;
+    static constexpr Uint32 kNoLink = 0xFFFFFFFFu;
+
+    /*!
+     * \brief Builds the graph from platform boxes, replacing any previous graph.
+     * \param platforms The solid boxes agents stand on.
+     * \param jumpHeight How far above its platform an agent can reach a platform top by jumping.
+     * \param jumpDistance How wide a horizontal gap an agent can jump across.
+     * \param agentWidth The width of the agents, used to keep takeoff and landing points on the platforms.
+     */
+    void Build(const std::vector<SDL_FRect> &platforms, float jumpHeight, float jumpDistance, float agentWidth)
+    {
+        mPlatforms = platforms;
+        mLinks.clear();
+        size_t count = std::min(platforms.size(), static_cast<size_t>(kNoNode));
+        mPlatforms.resize(count);
+        float half = agentWidth * 0.5f;
+
+        for (size_t a = 0; a < count; a++)
+        {
+            const SDL_FRect &from = mPlatforms[a];
+
+            // Fall off either edge onto the highest platform below it
+            for (int side = 0; side < 2; side++)
+            {
+                float edgeX = side == 0 ? from.x - half : from.x + from.w + half;
+                Uint16 below = FindNodeBelow(edgeX, from.y + 1.0f);
+                if (below != kNoNode)
+                {
+                    float takeoff = side == 0 ? from.x : from.x + from.w;
+                    AddLink(static_cast<Uint16>(a), below, NavLinkType::Fall, takeoff, ClampToNode(below, edgeX, half));
+                }
+            }
+
+            for (size_t b = 0; b < count; b++)
+            {
+                if (a == b)
+                {
+                    continue;
+                }
+                const SDL_FRect &to = mPlatforms[b];
+                float rise = from.y - to.y;
+                float overlapLeft = std::max(from.x, to.x);
+                float overlapRight = std::min(from.x + from.w, to.x + to.w);
+
+                if (std::fabs(rise) < 1.0f && overlapRight >= overlapLeft - 1.0f)
+                {
+                    // Same height and touching
+                    float x = from.x < to.x ? from.x + from.w : from.x;
+                    AddLink(static_cast<Uint16>(a), static_cast<Uint16>(b), NavLinkType::Walk, x, x);
+                }
+                else if (rise > 0.0f && rise <= jumpHeight && overlapRight - overlapLeft >= agentWidth)
+                {
+                    // Straight up onto a platform above
+                    float x = (overlapLeft + overlapRight) * 0.5f;
+                    AddLink(static_cast<Uint16>(a), static_cast<Uint16>(b), NavLinkType::Jump, x, x);
+                }
+                else if (rise > -jumpHeight && rise <= jumpHeight && overlapRight < overlapLeft)
+                {
+                    // Across a gap, no higher than a straight jump
+                    float gap = overlapLeft - overlapRight;
+                    if (gap <= jumpDistance)
+                    {
+                        bool rightward = to.x > from.x;
+                        float takeoff = rightward ? from.x + from.w - half : from.x + half;
+                        float landing = rightward ? to.x + half : to.x + to.w - half;
+                        AddLink(static_cast<Uint16>(a), static_cast<Uint16>(b), NavLinkType::Jump, takeoff, landing);
+                    }
+                }
+            }
+        }
+
+        // Links of each node are contiguous, so a search only touches a slice of the link array
+        std::stable_sort(mLinks.begin(), mLinks.end(), [](const NavLink &l, const NavLink &r)
+                         { return l.from < r.from; });
+        mFirstLink.assign(count + 1, 0);
+        for (const NavLink &link : mLinks)
+        {
+            mFirstLink[link.from + 1]++;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            mFirstLink[i + 1] += mFirstLink[i];
+        }
+
+        mCost.assign(count, 0.0f);
+        mParentLink.assign(count, kNoLink);
+        mStamp.assign(count, 0);
+        mClosed.assign(count, 0);
+        mOpen.clear();
+        mOpen.reserve(mLinks.size() + 1);
+        mSearch = 0;
+        mNextLink.assign(count * count, kUnknown);
+        mSearchCount = 0;
+    }
+
+    /*!
+     * \brief Gets the number of nodes, i.e. platforms.
+     */
+    size_t GetNodeCount() const
+    {
+        return mPlatforms.size();
+    }
+
+    /*!
+     * \brief Gets all links, grouped by source node.
+     */
+    const std::vector<NavLink> &GetLinks() const
+    {
+        return mLinks;
+    }
+
+    /*!
+     * \brief Gets a link by index.
+     */
+    const NavLink &GetLink(Uint32 link) const
+    {
+        return mLinks[link];
+    }
+
+    /*!
+     * \brief Finds the platform an agent stands on.
+     * \param x The X position of the agent's center.
+     * \param footY The Y position of the agent's bottom edge.
+     * \return The node, or kNoNode if no platform top is within a pixel of footY at x.
+     */
+    Uint16 FindNode(float x, float footY) const
+    {
+        for (size_t i = 0; i < mPlatforms.size(); i++)
+        {
+            const SDL_FRect &p = mPlatforms[i];
+            if (x >= p.x && x <= p.x + p.w && std::fabs(footY - p.y) <= 1.0f)
+            {
+                return static_cast<Uint16>(i);
+            }
+        }
+        return kNoNode;
+    }
+
+    /*!
+     * \brief Finds the first link of the cheapest path between two nodes.
+     * \param start The node the agent is on.
+     * \param goal The node the agent wants to reach.
+     * \return The link to take, or kNoLink if start is the goal or the goal cannot be reached.
+     */
+    Uint32 FindNextLink(Uint16 start, Uint16 goal)
+    {
+        size_t count = mPlatforms.size();
+        if (start >= count || goal >= count || start == goal)
+        {
+            return kNoLink;
+        }
+        Uint32 &cached = mNextLink[static_cast<size_t>(start) * count + goal];
+        if (cached == kUnknown)
+        {
+            Search(start, goal);
+        }
+        return cached;
+    }
+
+    /*!
+     * \brief Gets the number of A* searches run since the graph was built.
+     */
+    size_t GetSearchCount() const
+    {
+        return mSearchCount;
+    }
+
+private:
+    static constexpr Uint32 kUnknown = 0xFFFFFFFEu;
+
+    /*!
+     * \brief Runs A* from start to goal and caches the first link for every node on the path found.
+     */
+    void Search(Uint16 start, Uint16 goal)
+    {
+        size_t count = mPlatforms.size();
+        mSearchCount++;
+        if (++mSearch == 0)
+        {
+            // The stamp wrapped around; old stamps could look current again
+            std::fill(mStamp.begin(), mStamp.end(), 0);
+            std::fill(mClosed.begin(), mClosed.end(), 0);
+            mSearch = 1;
+        }
+
+        auto greater = [](const std::pair<float, Uint16> &l, const std::pair<float, Uint16> &r)
+        { return l.first > r.first; };
+        mOpen.clear();
+        mStamp[start] = mSearch;
+        mCost[start] = 0.0f;
+        mParentLink[start] = kNoLink;
+        mOpen.emplace_back(Heuristic(start, goal), start);
+
+        bool found = false;
+        while (!mOpen.empty())
+        {
+            std::pop_heap(mOpen.begin(), mOpen.end(), greater);
+            Uint16 node = mOpen.back().second;
+            mOpen.pop_back();
+            if (mClosed[node] == mSearch)
+            {
+                continue;
+            }
+            mClosed[node] = mSearch;
+            if (node == goal)
+            {
+                found = true;
+                break;
+            }
+            for (Uint32 l = mFirstLink[node]; l < mFirstLink[node + 1]; l++)
+            {
+                const NavLink &link = mLinks[l];
+                float cost = mCost[node] + link.cost;
+                if (mClosed[link.to] == mSearch || (mStamp[link.to] == mSearch && cost >= mCost[link.to]))
+                {
+                    continue;
+                }
+                mStamp[link.to] = mSearch;
+                mCost[link.to] = cost;
+                mParentLink[link.to] = l;
+                mOpen.emplace_back(cost + Heuristic(link.to, goal), link.to);
+                std::push_heap(mOpen.begin(), mOpen.end(), greater);
+            }
+        }
+
+        if (!found)
+        {
+            mNextLink[static_cast<size_t>(start) * count + goal] = kNoLink;
+            return;
+        }
+        // Walk back from the goal; each link is the next step to the goal from its source node
+        for (Uint32 l = mParentLink[goal]; l != kNoLink; l = mParentLink[mLinks[l].from])
+        {
+            mNextLink[static_cast<size_t>(mLinks[l].from) * count + goal] = l;
+        }
+    }
+
+    /*!
+     * \brief Estimates the cost between two nodes as the distance between their centers.
+     */
+    float Heuristic(Uint16 from, Uint16 to) const
+    {
+        const SDL_FRect &a = mPlatforms[from];
+        const SDL_FRect &b = mPlatforms[to];
+        float dx = std::max(0.0f, std::max(a.x, b.x) - std::min(a.x + a.w, b.x + b.w));
+        return std::hypot(dx, a.y - b.y);
+    }
+
+    /*!
+     * \brief Adds a link. The cost is the walk to the takeoff point plus the distance travelled through the air.
+     */
+    void AddLink(Uint16 from, Uint16 to, NavLinkType type, float takeoffX, float landingX)
+    {
+        float cost = std::hypot(landingX - takeoffX, mPlatforms[from].y - mPlatforms[to].y);
+        if (type == NavLinkType::Jump)
+        {
+            cost += 16.0f; // Prefer walking and falling when they are as short
+        }
+        mLinks.push_back(NavLink{from, to, type, takeoffX, landingX, cost});
+    }
+
+    /*!
+     * \brief Finds the highest platform whose top is below y and spans x.
+     */
+    Uint16 FindNodeBelow(float x, float y) const
+    {
+        Uint16 best = kNoNode;
+        for (size_t i = 0; i < mPlatforms.size(); i++)
+        {
+            const SDL_FRect &p = mPlatforms[i];
+            if (x >= p.x && x <= p.x + p.w && p.y >= y && (best == kNoNode || p.y < mPlatforms[best].y))
+            {
+                best = static_cast<Uint16>(i);
+            }
+        }
+        return best;
+    }
+
+    /*!
+     * \brief Clamps an X position so an agent of the given half width fits on a platform.
+     */
+    float ClampToNode(Uint16 node, float x, float half) const
+    {
+        const SDL_FRect &p = mPlatforms[node];
+        return std::max(p.x + half, std::min(p.x + p.w - half, x));
+    }
+
+    std::vector<SDL_FRect> mPlatforms;
+    std::vector<NavLink> mLinks;
+    std::vector<Uint32> mFirstLink; //!< Links of node i are [mFirstLink[i], mFirstLink[i + 1]).
+    std::vector<Uint32> mNextLink;  //!< First link from start to goal, indexed start * nodes + goal.
+
+    // A* storage, reused by every search
+    std::vector<float> mCost;
+    std::vector<Uint32> mParentLink;
+    std::vector<Uint32> mStamp;  //!< Search number that last set mCost and mParentLink.
+    std::vector<Uint32> mClosed; //!< Search number that last closed the node.
+    std::vector<std::pair<float, Uint16>> mOpen;
+    Uint32 mSearch{0};
+    size_t mSearchCount{0};
+};
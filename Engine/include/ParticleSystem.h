@@ -0,0 +1,244 @@
+#pragma once
+#include "FramePacket.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*!
+ * \struct ParticleEmitter
+ * \brief Describes the particles of one effect: how many fit, how they are launched and how they look.
+ */
+struct ParticleEmitter
+{
+    SDL_Texture *texture{nullptr};       //!< Texture of each particle quad; null draws plain colored quads.
+    size_t capacity{4096};               //!< Most particles alive at once; bursts beyond it are cut short.
+    float life{0.6f};                    //!< Seconds a particle lives.
+    float minSpeed{60.0f};
+    float maxSpeed{180.0f};
+    float gravity{400.0f};               //!< Downward acceleration in pixels per second squared.
+    float size{4.0f};                    //!< Width and height of a particle quad.
+    SDL_Color color{255, 255, 255, 255}; //!< Color at birth; alpha fades to zero over the particle's life.
+};
+
+/*!
+ * \class ParticleSystem
+ * \brief The ParticleSystem simulates short-lived particles for many effects without an entity per particle.
+ *
+ * Each emitter owns a pool of parallel arrays (position, velocity, remaining life) with a fixed capacity, allocated on
+ * the first burst. Update integrates every pool with straight loops over the arrays, which the compiler vectorizes,
+ * then removes dead particles by moving the last live particle into their slot. Render records one batch of quads per
+ * emitter, so an effect costs a single SDL_RenderGeometry call however many particles it has.
+ */
+class ParticleSystem
+{
+public:
+    /*!
+     * \brief Adds an emitter.
+     * \param emitter The effect description.
+     * \return The emitter index, passed to Emit.
+     */
+    size_t AddEmitter(const ParticleEmitter &emitter)
+    {
+        mPools.emplace_back();
+        mPools.back().emitter = emitter;
+        return mPools.size() - 1;
+    }
+
+    /*!
+     * \brief Gets the number of emitters.
+     */
+    size_t GetEmitterCount() const
+    {
+        return mPools.size();
+    }
+
+    /*!
+     * \brief Changes how many particles of an emitter can be alive at once. Particles beyond the new capacity are dropped.
+     */
+    void SetCapacity(size_t emitter, size_t capacity)
+    {
+        Pool &pool = mPools[emitter];
+        pool.emitter.capacity = capacity;
+        pool.count = std::min(pool.count, capacity);
+        if (!pool.x.empty())
+        {
+            pool.Allocate();
+        }
+    }
+
+    /*!
+     * \brief Launches a burst of particles from a point, in random directions.
+     * \param emitter The emitter index.
+     * \param x The X position of the burst.
+     * \param y The Y position of the burst.
+     * \param count The number of particles.
+     * \return The number of particles launched; fewer than count if the pool is full.
+     */
+    size_t Emit(size_t emitter, float x, float y, size_t count)
+    {
+        Pool &pool = mPools[emitter];
+        if (pool.x.empty())
+        {
+            pool.Allocate();
+        }
+        const ParticleEmitter &config = pool.emitter;
+        size_t first = pool.count;
+        size_t last = std::min(first + count, config.capacity);
+        for (size_t i = first; i < last; i++)
+        {
+            float angle = NextRandom() * 6.2831853f;
+            float speed = config.minSpeed + NextRandom() * (config.maxSpeed - config.minSpeed);
+            pool.x[i] = x;
+            pool.y[i] = y;
+            pool.vx[i] = std::cos(angle) * speed;
+            pool.vy[i] = std::sin(angle) * speed;
+            pool.life[i] = config.life;
+        }
+        pool.count = last;
+        return last - first;
+    }
+
+    /*!
+     * \brief Moves every particle, ages it and removes the ones whose life ran out.
+     * \param deltaTime The time since the last update.
+     */
+    void Update(float deltaTime)
+    {
+        for (Pool &pool : mPools)
+        {
+            size_t count = pool.count;
+            float *x = pool.x.data();
+            float *y = pool.y.data();
+            float *vx = pool.vx.data();
+            float *vy = pool.vy.data();
+            float *life = pool.life.data();
+            float dv = pool.emitter.gravity * deltaTime;
+            for (size_t i = 0; i < count; i++)
+            {
+                vy[i] += dv;
+                x[i] += vx[i] * deltaTime;
+                y[i] += vy[i] * deltaTime;
+                life[i] -= deltaTime;
+            }
+
+            // Swap-remove keeps the live particles packed; their order does not matter
+            size_t i = 0;
+            while (i < count)
+            {
+                if (life[i] > 0.0f)
+                {
+                    i++;
+                    continue;
+                }
+                count--;
+                x[i] = x[count];
+                y[i] = y[count];
+                vx[i] = vx[count];
+                vy[i] = vy[count];
+                life[i] = life[count];
+            }
+            pool.count = count;
+        }
+    }
+
+    /*!
+     * \brief Records one batch of quads per emitter with live particles.
+     * \param packet The frame packet to record into.
+     */
+    void Render(FramePacket &packet) const
+    {
+        for (const Pool &pool : mPools)
+        {
+            if (pool.count == 0)
+            {
+                continue;
+            }
+            const ParticleEmitter &config = pool.emitter;
+            float half = config.size * 0.5f;
+            float fade = static_cast<float>(config.color.a) / config.life;
+            SDL_Vertex *vertex = packet.DrawQuads(config.texture, pool.count);
+            for (size_t i = 0; i < pool.count; i++, vertex += 4)
+            {
+                float left = pool.x[i] - half;
+                float top = pool.y[i] - half;
+                float right = pool.x[i] + half;
+                float bottom = pool.y[i] + half;
+                SDL_Color color = config.color;
+                color.a = static_cast<Uint8>(std::min(255.0f, pool.life[i] * fade));
+                vertex[0] = SDL_Vertex{SDL_FPoint{left, top}, color, SDL_FPoint{0.0f, 0.0f}};
+                vertex[1] = SDL_Vertex{SDL_FPoint{right, top}, color, SDL_FPoint{1.0f, 0.0f}};
+                vertex[2] = SDL_Vertex{SDL_FPoint{right, bottom}, color, SDL_FPoint{1.0f, 1.0f}};
+                vertex[3] = SDL_Vertex{SDL_FPoint{left, bottom}, color, SDL_FPoint{0.0f, 1.0f}};
+            }
+        }
+    }
+
+    /*!
+     * \brief Gets the number of live particles of one emitter.
+     */
+    size_t GetLiveCount(size_t emitter) const
+    {
+        return mPools[emitter].count;
+    }
+
+    /*!
+     * \brief Gets the number of live particles of all emitters.
+     */
+    size_t GetLiveCount() const
+    {
+        size_t count = 0;
+        for (const Pool &pool : mPools)
+        {
+            count += pool.count;
+        }
+        return count;
+    }
+
+    /*!
+     * \brief Removes every live particle, keeping the pools.
+     */
+    void Clear()
+    {
+        for (Pool &pool : mPools)
+        {
+            pool.count = 0;
+        }
+    }
+
+private:
+    struct Pool
+    {
+        ParticleEmitter emitter;
+        size_t count{0};
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> vx;
+        std::vector<float> vy;
+        std::vector<float> life;
+
+        void Allocate()
+        {
+            x.resize(emitter.capacity);
+            y.resize(emitter.capacity);
+            vx.resize(emitter.capacity);
+            vy.resize(emitter.capacity);
+            life.resize(emitter.capacity);
+        }
+    };
+
+    /*!
+     * \brief Returns a pseudo-random number in [0, 1) from a xorshift generator. Particles are cosmetic, so the
+     * sequence is not part of the scene state.
+     */
+    float NextRandom()
+    {
+        mRandom ^= mRandom << 13;
+        mRandom ^= mRandom >> 17;
+        mRandom ^= mRandom << 5;
+        return static_cast<float>(mRandom >> 8) * (1.0f / 16777216.0f);
+    }
+
+    std::vector<Pool> mPools;
+    Uint32 mRandom{0x9E3779B9u};
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include "BitmapFont.h"
+#include "FramePacket.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+/*!
+ * \class PerfOverlay
+ * \brief The PerfOverlay draws frame statistics on top of the game: fps, a frame-time graph and entity and draw counts.
+ *
+ * The frame times of the last kHistory frames are kept in a ring buffer and drawn as a bar per frame, green up to one
+ * 60 Hz frame, yellow up to two and red beyond, with a line marking 16.7 ms. The panel, the bars and the text all
+ * sample the font atlas, so the whole overlay is recorded as a single quad batch. The text lines are TextLabels and
+ * are only laid out again when a number shown changes.
+ */
+class PerfOverlay
+{
+public:
+    static constexpr size_t kHistory = 120;
+
+    /*!
+     * \brief Loads the font. Without a renderer the overlay draws nothing.
+     */
+    void Load(SDL_Renderer *renderer)
+    {
+        mFont.Load(renderer);
+    }
+
+    /*!
+     * \brief Shows or hides the overlay. Statistics are gathered either way.
+     */
+    void SetVisible(bool visible)
+    {
+        mVisible = visible;
+    }
+
+    /*!
+     * \brief Checks whether the overlay is shown.
+     */
+    bool IsVisible() const
+    {
+        return mVisible;
+    }
+
+    /*!
+     * \brief Records the duration of a frame.
+     * \param frameMs The frame time in milliseconds.
+     */
+    void AddFrame(double frameMs)
+    {
+        mHistory[mNext] = static_cast<float>(frameMs);
+        mNext = (mNext + 1) % kHistory;
+        mCount = std::min(mCount + 1, kHistory);
+    }
+
+    /*!
+     * \brief Sets the frame rate shown, normally once per second from FrameProfiler::Report.
+     */
+    void SetFps(Uint64 fps)
+    {
+        float sum = 0.0f;
+        float worst = 0.0f;
+        for (size_t i = 0; i < mCount; i++)
+        {
+            sum += mHistory[i];
+            worst = std::max(worst, mHistory[i]);
+        }
+        char text[64];
+        std::snprintf(text, sizeof(text), "FPS %llu  FRAME %.2f MS  MAX %.2f", static_cast<unsigned long long>(fps),
+                      mCount ? sum / mCount : 0.0f, worst);
+        mScratch.assign(text);
+        mFpsLabel.SetText(mScratch);
+    }
+
+    /*!
+     * \brief Sets the counts shown for the current frame.
+     * \param entities The number of live entities and instances in the scene.
+     * \param particles The number of live particles.
+     * \param drawCalls The number of sprite copies and geometry batches the frame is drawn with.
+     * \param renderScale The fraction of the window's resolution the scene is rendered at.
+     */
+    void SetCounts(size_t entities, size_t particles, size_t drawCalls, float renderScale)
+    {
+        char text[112];
+        std::snprintf(text, sizeof(text), "ENTITIES %zu  PARTICLES %zu\nDRAW CALLS %zu  SCALE %d%%", entities, particles, drawCalls,
+                      static_cast<int>(renderScale * 100.0f + 0.5f));
+        mScratch.assign(text);
+        mCountLabel.SetText(mScratch);
+    }
+
+    /*!
+     * \brief Records the overlay as one quad batch, if it is visible.
+     * \param packet The frame packet to record into.
+     * \param x The left edge of the panel.
+     * \param y The top edge of the panel.
+     */
+    void Render(FramePacket &packet, float x, float y) const
+    {
+        if (!mVisible || mFont.GetTexture() == nullptr)
+        {
+            return;
+        }
+
+        float textTop = y + kPadding;
+        float countsTop = textTop + mFpsLabel.GetSize().y + kPadding;
+        float graphTop = countsTop + mCountLabel.GetSize().y + kPadding;
+        float graphBottom = graphTop + kGraphHeight;
+
+        size_t quads = 2 + mCount + mFpsLabel.GetQuadCount() + mCountLabel.GetQuadCount();
+        SDL_Vertex *vertex = packet.DrawQuads(mFont.GetTexture(), quads);
+        SDL_FPoint solid = BitmapFont::GetSolidCoords();
+
+        vertex = WriteRect(vertex, solid, x, y, kWidth, graphBottom + kPadding - y, SDL_Color{0, 0, 0, 160});
+        float pixelsPerMs = kGraphHeight / kGraphMs;
+        vertex = WriteRect(vertex, solid, x + kPadding, graphBottom - kTargetMs * pixelsPerMs, kHistory * kBarWidth, 1.0f,
+                           SDL_Color{255, 255, 255, 96});
+
+        // Oldest frame on the left
+        size_t first = (mNext + kHistory - mCount) % kHistory;
+        for (size_t i = 0; i < mCount; i++)
+        {
+            float ms = mHistory[(first + i) % kHistory];
+            float height = std::min(ms, kGraphMs) * pixelsPerMs;
+            SDL_Color color = ms <= kTargetMs ? SDL_Color{64, 220, 64, 255} : ms <= 2.0f * kTargetMs ? SDL_Color{240, 200, 40, 255} : SDL_Color{240, 60, 40, 255};
+            vertex = WriteRect(vertex, solid, x + kPadding + i * kBarWidth, graphBottom - height, kBarWidth, height, color);
+        }
+
+        vertex = mFpsLabel.Write(vertex, x + kPadding, textTop, SDL_Color{255, 255, 255, 255});
+        mCountLabel.Write(vertex, x + kPadding, countsTop, SDL_Color{200, 200, 200, 255});
+    }
+
+    /*!
+     * \brief Gets the width of the panel.
+     */
+    static constexpr float GetWidth()
+    {
+        return kWidth;
+    }
+
+private:
+    static constexpr float kBarWidth = 2.0f;
+    static constexpr float kPadding = 6.0f;
+    static constexpr float kWidth = kHistory * kBarWidth + 2.0f * kPadding;
+    static constexpr float kGraphHeight = 50.0f;
+    static constexpr float kGraphMs = 50.0f;   //!< Frame time at the top of the graph.
+    static constexpr float kTargetMs = 16.67f; //!< Frame time of a 60 Hz frame.
+
+    /*!
+     * \brief Writes a plain rectangle as a quad sampling the solid block of the atlas.
+     */
+    static SDL_Vertex *WriteRect(SDL_Vertex *vertex, SDL_FPoint solid, float x, float y, float w, float h, SDL_Color color)
+    {
+        vertex[0] = SDL_Vertex{SDL_FPoint{x, y}, color, solid};
+        vertex[1] = SDL_Vertex{SDL_FPoint{x + w, y}, color, solid};
+        vertex[2] = SDL_Vertex{SDL_FPoint{x + w, y + h}, color, solid};
+        vertex[3] = SDL_Vertex{SDL_FPoint{x, y + h}, color, solid};
+        return vertex + 4;
+    }
+
+    BitmapFont mFont;
+    TextLabel mFpsLabel;
+    TextLabel mCountLabel;
+    std::string mScratch;
+    bool mVisible{false};
+    float mHistory[kHistory]{};
+    size_t mNext{0};
+    size_t mCount{0};
+};
@@ -0,0 +1,584 @@
+#pragma once
+#include "SceneSnapshot.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/*!
+ * \class PhysicsWorld
+ * \brief The PhysicsWorld class moves rigid bodies under gravity and lands them on static geometry.
+ *
+ * Bodies are axis-aligned boxes stored as parallel arrays, so a step is one tight loop over contiguous floats followed
+ * by one broadphase query per body. Static geometry (platforms) is bucketed into a uniform grid once; a body only tests
+ * the statics in the cells it covers. Bodies are referred to by stable handles, so destroying one body does not
+ * invalidate the others.
+ *
+ * The arrays are partitioned into awake bodies followed by sleeping ones. A body falls asleep when it rests on the
+ * ground without velocity and is woken by anything that could move it, so resting bodies cost nothing per step.
+ */
+class PhysicsWorld
+{
+public:
+    static constexpr Uint32 kNoBody = 0xFFFFFFFFu;
+    static constexpr float kContactSlop = 0.01f; //!< How far above a surface a body still counts as resting on it.
+    static constexpr float kNoHit = 2.0f;        //!< Time of impact meaning "no impact during this step".
+
+    /*!
+     * \brief Creates an empty world.
+     * \param width The width of the world; bodies are kept between 0 and width.
+     * \param height The height of the world; its bottom edge is a floor.
+     * \param gravity The downward acceleration in pixels per second squared.
+     * \param cellSize The size of a broadphase grid cell.
+     */
+    PhysicsWorld(float width = 640.0f, float height = 480.0f, float gravity = 980.0f, float cellSize = 64.0f)
+        : mWidth(width), mHeight(height), mGravity(gravity), mCellSize(cellSize)
+    {
+    }
+
+    /*!
+     * \brief Gets the downward acceleration in pixels per second squared.
+     */
+    float GetGravity() const
+    {
+        return mGravity;
+    }
+
+    /*!
+     * \brief Adds a static box that bodies land on.
+     * \param box The box in world coordinates.
+     */
+    void AddStatic(const SDL_FRect &box)
+    {
+        mStatic.push_back(box);
+        mGridDirty = true;
+        mAwakeCount = mX.size();
+    }
+
+    /*!
+     * \brief Removes all static geometry.
+     */
+    void ClearStatic()
+    {
+        mStatic.clear();
+        mGridDirty = true;
+        mAwakeCount = mX.size();
+    }
+
+    /*!
+     * \brief Creates an awake body.
+     * \param box The initial box of the body.
+     * \param gravityScale Multiplier applied to the world gravity; 0 for bodies that only move by their velocity.
+     * \param owner An id of whatever the body moves, reported by ForEachMoved; kNoBody if not needed.
+     * \return A handle to the body.
+     */
+    Uint32 CreateBody(const SDL_FRect &box, float gravityScale = 1.0f, Uint32 owner = kNoBody)
+    {
+        Uint32 handle;
+        if (!mFreeHandles.empty())
+        {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+        }
+        else
+        {
+            handle = static_cast<Uint32>(mDenseOf.size());
+            mDenseOf.push_back(kNoBody);
+        }
+
+        mDenseOf[handle] = static_cast<Uint32>(mX.size());
+        mHandleOf.push_back(handle);
+        mX.push_back(box.x);
+        mY.push_back(box.y);
+        mW.push_back(box.w);
+        mH.push_back(box.h);
+        mVX.push_back(0.0f);
+        mVY.push_back(0.0f);
+        mGravityScale.push_back(gravityScale);
+        mGrounded.push_back(0);
+        mOwner.push_back(owner);
+        SwapDense(mDenseOf[handle], static_cast<Uint32>(mAwakeCount));
+        mAwakeCount++;
+        return handle;
+    }
+
+    /*!
+     * \brief Destroys a body. Other bodies are swapped into its slot, so the arrays stay packed.
+     * \param handle A handle returned by CreateBody; invalid handles are ignored.
+     */
+    void DestroyBody(Uint32 handle)
+    {
+        if (!IsValid(handle))
+        {
+            return;
+        }
+        if (IsAwake(handle))
+        {
+            Sleep(mDenseOf[handle]);
+        }
+        SwapDense(mDenseOf[handle], static_cast<Uint32>(mX.size() - 1));
+        mMovedCount = std::min(mMovedCount, mX.size() - 1);
+        mX.pop_back();
+        mY.pop_back();
+        mW.pop_back();
+        mH.pop_back();
+        mVX.pop_back();
+        mVY.pop_back();
+        mGravityScale.pop_back();
+        mGrounded.pop_back();
+        mOwner.pop_back();
+        mHandleOf.pop_back();
+        mDenseOf[handle] = kNoBody;
+        mFreeHandles.push_back(handle);
+    }
+
+    /*!
+     * \brief Checks whether a handle refers to a live body.
+     */
+    bool IsValid(Uint32 handle) const
+    {
+        return handle < mDenseOf.size() && mDenseOf[handle] != kNoBody;
+    }
+
+    /*!
+     * \brief Checks whether a body is awake, i.e. integrated by Step.
+     */
+    bool IsAwake(Uint32 handle) const
+    {
+        return mDenseOf[handle] < mAwakeCount;
+    }
+
+    /*!
+     * \brief Wakes a sleeping body.
+     */
+    void Wake(Uint32 handle)
+    {
+        Uint32 dense = mDenseOf[handle];
+        if (dense >= mAwakeCount)
+        {
+            SwapDense(dense, static_cast<Uint32>(mAwakeCount));
+            mAwakeCount++;
+        }
+    }
+
+    /*!
+     * \brief Gets the number of awake bodies.
+     */
+    size_t GetAwakeCount() const
+    {
+        return mAwakeCount;
+    }
+
+    /*!
+     * \brief Gets the number of live bodies.
+     */
+    size_t GetBodyCount() const
+    {
+        return mX.size();
+    }
+
+    /*!
+     * \brief Gets the box of a body.
+     */
+    SDL_FRect GetBox(Uint32 handle) const
+    {
+        Uint32 i = mDenseOf[handle];
+        return SDL_FRect{mX[i], mY[i], mW[i], mH[i]};
+    }
+
+    /*!
+     * \brief Teleports a body.
+     */
+    void SetPosition(Uint32 handle, float x, float y)
+    {
+        Uint32 i = mDenseOf[handle];
+        mX[i] = x;
+        mY[i] = y;
+        Wake(handle);
+    }
+
+    /*!
+     * \brief Gets the horizontal velocity of a body.
+     */
+    float GetVelocityX(Uint32 handle) const
+    {
+        return mVX[mDenseOf[handle]];
+    }
+
+    /*!
+     * \brief Gets the vertical velocity of a body; positive is downward.
+     */
+    float GetVelocityY(Uint32 handle) const
+    {
+        return mVY[mDenseOf[handle]];
+    }
+
+    /*!
+     * \brief Sets the velocity of a body.
+     */
+    void SetVelocity(Uint32 handle, float vx, float vy)
+    {
+        Uint32 i = mDenseOf[handle];
+        mVX[i] = vx;
+        mVY[i] = vy;
+        if (vx != 0.0f || vy != 0.0f)
+        {
+            Wake(handle);
+        }
+    }
+
+    /*!
+     * \brief Checks whether a body rests on static geometry or the floor.
+     */
+    bool IsGrounded(Uint32 handle) const
+    {
+        return mGrounded[mDenseOf[handle]] != 0;
+    }
+
+    /*!
+     * \brief Sets the grounded state of a body, e.g. to let it leave the ground when jumping.
+     */
+    void SetGrounded(Uint32 handle, bool grounded)
+    {
+        mGrounded[mDenseOf[handle]] = grounded ? 1 : 0;
+        if (!grounded)
+        {
+            Wake(handle);
+        }
+    }
+
+    /*!
+     * \brief Sets the gravity multiplier of a body.
+     */
+    void SetGravityScale(Uint32 handle, float gravityScale)
+    {
+        mGravityScale[mDenseOf[handle]] = gravityScale;
+        Wake(handle);
+    }
+
+    /*!
+     * \brief Advances all bodies.
+     * \param deltaTime The length of the step in seconds.
+     *
+     * Integrates every awake body, then resolves each one against the floor and the statics found by a broadphase
+     * query over its swept box. Collisions are continuous, so the step length only affects accuracy, not whether
+     * bodies land. Bodies that come to rest are put to sleep.
+     */
+    void Step(float deltaTime)
+    {
+        if (mGridDirty)
+        {
+            BuildGrid();
+        }
+
+        size_t count = mAwakeCount;
+        mMovedCount = count;
+        mPrevX.assign(mX.begin(), mX.begin() + count);
+        mPrevY.assign(mY.begin(), mY.begin() + count);
+        float gravityStep = mGravity * deltaTime;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!mGrounded[i])
+            {
+                mVY[i] += gravityStep * mGravityScale[i];
+            }
+            mX[i] = std::clamp(mX[i] + mVX[i] * deltaTime, 0.0f, mWidth - mW[i]);
+            mY[i] += mVY[i] * deltaTime;
+        }
+
+        // Backwards, so a body put to sleep is swapped with one that was already resolved
+        for (size_t i = count; i-- > 0;)
+        {
+            Resolve(i);
+            if (mGrounded[i] && mVX[i] == 0.0f && mVY[i] == 0.0f)
+            {
+                Sleep(static_cast<Uint32>(i));
+            }
+        }
+    }
+
+    /*!
+     * \brief Calls f(owner, x, y) for every body that was awake during the last Step, including the ones that fell
+     * asleep at its end, so their owners can copy the final positions.
+     */
+    template <typename F>
+    void ForEachMoved(F &&f) const
+    {
+        for (size_t i = 0; i < mMovedCount; i++)
+        {
+            f(mOwner[i], mX[i], mY[i]);
+        }
+    }
+
+    /*!
+     * \brief Changes the owner id of a body, e.g. after its owner was moved to another index.
+     */
+    void SetOwner(Uint32 handle, Uint32 owner)
+    {
+        mOwner[mDenseOf[handle]] = owner;
+    }
+
+    /*!
+     * \brief Appends the state of every body to a snapshot. Static geometry is not saved.
+     */
+    void Save(SceneSnapshot &snapshot) const
+    {
+        snapshot.WriteArray(mX);
+        snapshot.WriteArray(mY);
+        snapshot.WriteArray(mW);
+        snapshot.WriteArray(mH);
+        snapshot.WriteArray(mVX);
+        snapshot.WriteArray(mVY);
+        snapshot.WriteArray(mGravityScale);
+        snapshot.WriteArray(mGrounded);
+        snapshot.WriteArray(mOwner);
+        snapshot.WriteArray(mHandleOf);
+        snapshot.WriteArray(mDenseOf);
+        snapshot.WriteArray(mFreeHandles);
+        snapshot.Write(static_cast<Uint64>(mAwakeCount));
+    }
+
+    /*!
+     * \brief Restores the state saved by Save. Handles saved with the snapshot are valid again afterwards.
+     * \return False if the snapshot is malformed.
+     */
+    bool Restore(SnapshotReader &reader)
+    {
+        bool ok = reader.ReadArray(mX) && reader.ReadArray(mY) && reader.ReadArray(mW) && reader.ReadArray(mH) &&
+                  reader.ReadArray(mVX) && reader.ReadArray(mVY) && reader.ReadArray(mGravityScale) &&
+                  reader.ReadArray(mGrounded) && reader.ReadArray(mOwner) && reader.ReadArray(mHandleOf) &&
+                  reader.ReadArray(mDenseOf) && reader.ReadArray(mFreeHandles);
+        Uint64 awakeCount = 0;
+        ok = ok && reader.Read(awakeCount);
+        size_t count = mX.size();
+        mAwakeCount = std::min(static_cast<size_t>(awakeCount), count);
+        mMovedCount = 0;
+        return ok && mY.size() == count && mW.size() == count && mH.size() == count && mVX.size() == count &&
+               mVY.size() == count && mGravityScale.size() == count && mGrounded.size() == count &&
+               mOwner.size() == count && mHandleOf.size() == count && awakeCount <= count;
+    }
+
+private:
+    /*!
+     * \brief Swaps two bodies in the dense arrays and fixes up their handles.
+     */
+    void SwapDense(Uint32 a, Uint32 b)
+    {
+        if (a == b)
+        {
+            return;
+        }
+        std::swap(mX[a], mX[b]);
+        std::swap(mY[a], mY[b]);
+        std::swap(mW[a], mW[b]);
+        std::swap(mH[a], mH[b]);
+        std::swap(mVX[a], mVX[b]);
+        std::swap(mVY[a], mVY[b]);
+        std::swap(mGravityScale[a], mGravityScale[b]);
+        std::swap(mGrounded[a], mGrounded[b]);
+        std::swap(mOwner[a], mOwner[b]);
+        std::swap(mHandleOf[a], mHandleOf[b]);
+        mDenseOf[mHandleOf[a]] = a;
+        mDenseOf[mHandleOf[b]] = b;
+    }
+
+    /*!
+     * \brief Moves an awake body to the sleeping part of the arrays.
+     */
+    void Sleep(Uint32 dense)
+    {
+        mAwakeCount--;
+        SwapDense(dense, static_cast<Uint32>(mAwakeCount));
+    }
+
+    /*!
+     * \brief Buckets the static boxes into grid cells, stored compactly as one index list per cell.
+     */
+    void BuildGrid()
+    {
+        mColumns = std::max(1, static_cast<int>(std::ceil(mWidth / mCellSize)));
+        mRows = std::max(1, static_cast<int>(std::ceil(mHeight / mCellSize)));
+        mCellStart.assign(static_cast<size_t>(mColumns * mRows) + 1, 0);
+
+        // Count the statics per cell, turn the counts into offsets, then fill
+        for (int pass = 0; pass < 2; pass++)
+        {
+            std::vector<Uint32> cursor;
+            if (pass == 1)
+            {
+                for (size_t c = 1; c < mCellStart.size(); c++)
+                {
+                    mCellStart[c] += mCellStart[c - 1];
+                }
+                mCellItems.resize(mCellStart.back());
+                cursor.assign(mCellStart.begin(), mCellStart.end() - 1);
+            }
+            for (size_t s = 0; s < mStatic.size(); s++)
+            {
+                int x0, y0, x1, y1;
+                CellRange(mStatic[s], x0, y0, x1, y1);
+                for (int cy = y0; cy <= y1; cy++)
+                {
+                    for (int cx = x0; cx <= x1; cx++)
+                    {
+                        size_t cell = static_cast<size_t>(cy * mColumns + cx);
+                        if (pass == 0)
+                        {
+                            mCellStart[cell + 1]++;
+                        }
+                        else
+                        {
+                            mCellItems[cursor[cell]++] = static_cast<Uint32>(s);
+                        }
+                    }
+                }
+            }
+        }
+        mGridDirty = false;
+    }
+
+    /*!
+     * \brief Gets the range of grid cells covered by a box, clamped to the grid.
+     */
+    void CellRange(const SDL_FRect &box, int &x0, int &y0, int &x1, int &y1) const
+    {
+        x0 = std::clamp(static_cast<int>(std::floor(box.x / mCellSize)), 0, mColumns - 1);
+        y0 = std::clamp(static_cast<int>(std::floor(box.y / mCellSize)), 0, mRows - 1);
+        x1 = std::clamp(static_cast<int>(std::floor((box.x + box.w) / mCellSize)), 0, mColumns - 1);
+        y1 = std::clamp(static_cast<int>(std::floor((box.y + box.h) / mCellSize)), 0, mRows - 1);
+    }
+
+    /*!
+     * \brief Computes when a box moving by (dx, dy) during a step first overlaps a static box.
+     * \return The time of impact in [0, 1], or a value above 1 if they do not touch during the step.
+     *
+     * Swept AABB test: the entry and exit times are computed per axis, and the boxes overlap while both axes do.
+     */
+    static float SweepTime(float x, float y, float w, float h, float dx, float dy, const SDL_FRect &s)
+    {
+        float entryX, exitX, entryY, exitY;
+        if (!AxisInterval(x, w, dx, s.x, s.w, entryX, exitX) || !AxisInterval(y, h, dy, s.y, s.h, entryY, exitY))
+        {
+            return kNoHit;
+        }
+        float entry = std::max(entryX, entryY);
+        float exit = std::min(exitX, exitY);
+        if (entry >= exit || entry > 1.0f || exit <= 0.0f)
+        {
+            return kNoHit;
+        }
+        return std::max(entry, 0.0f);
+    }
+
+    /*!
+     * \brief Computes the times during which an interval moving by d overlaps a fixed interval on one axis.
+     * \return False if a non-moving interval never overlaps.
+     */
+    static bool AxisInterval(float p, float size, float d, float s, float sSize, float &entry, float &exit)
+    {
+        if (d == 0.0f)
+        {
+            if (p < s + sSize && p + size > s)
+            {
+                entry = -std::numeric_limits<float>::infinity();
+                exit = std::numeric_limits<float>::infinity();
+                return true;
+            }
+            return false;
+        }
+        float t0 = (s - (p + size)) / d;
+        float t1 = (s + sSize - p) / d;
+        entry = std::min(t0, t1);
+        exit = std::max(t0, t1);
+        return true;
+    }
+
+    /*!
+     * \brief Lands a body on the first static it touched during the step, on a static it stands on, or on the floor.
+     *
+     * The whole motion of the step is swept, so a fast body cannot pass through a thin platform between two steps.
+     * A body that touches a static from any side is lifted onto its top, as the player always was; a body touching
+     * a top while not moving up stays grounded on it.
+     */
+    void Resolve(size_t i)
+    {
+        float px = mPrevX[i];
+        float py = mPrevY[i];
+        float dx = mX[i] - px;
+        float dy = mY[i] - py;
+        float left = mX[i];
+        float right = mX[i] + mW[i];
+        float bottom = mY[i] + mH[i];
+
+        float hitTime = kNoHit;
+        float hitTop = mHeight;
+        float restTop = mHeight;
+        int x0, y0, x1, y1;
+        // One query covers the whole swept box, plus one pixel below it so resting contacts are found
+        CellRange(SDL_FRect{std::min(px, mX[i]), std::min(py, mY[i]), mW[i] + std::fabs(dx), mH[i] + std::fabs(dy) + 1.0f}, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; cy++)
+        {
+            for (int cx = x0; cx <= x1; cx++)
+            {
+                size_t cell = static_cast<size_t>(cy * mColumns + cx);
+                for (Uint32 k = mCellStart[cell]; k < mCellStart[cell + 1]; k++)
+                {
+                    const SDL_FRect &s = mStatic[mCellItems[k]];
+                    float t = SweepTime(px, py, mW[i], mH[i], dx, dy, s);
+                    if (t < hitTime || (t == hitTime && s.y < hitTop))
+                    {
+                        hitTime = t;
+                        hitTop = s.y;
+                    }
+                    bool resting = right > s.x && left < s.x + s.w && std::fabs(bottom - s.y) <= kContactSlop;
+                    if (resting && mVY[i] >= 0.0f && s.y < restTop)
+                    {
+                        restTop = s.y;
+                    }
+                }
+            }
+        }
+
+        float support = hitTime <= 1.0f ? hitTop : restTop;
+        if (hitTime <= 1.0f || (bottom >= support - kContactSlop && (bottom > support || mVY[i] >= 0.0f)))
+        {
+            mY[i] = support - mH[i];
+            mVY[i] = 0.0f;
+            mGrounded[i] = 1;
+        }
+        else
+        {
+            mGrounded[i] = 0;
+        }
+    }
+
+    float mWidth;
+    float mHeight;
+    float mGravity;
+    float mCellSize;
+
+    std::vector<float> mX;
+    std::vector<float> mY;
+    std::vector<float> mW;
+    std::vector<float> mH;
+    std::vector<float> mVX;
+    std::vector<float> mVY;
+    std::vector<float> mGravityScale;
+    std::vector<Uint8> mGrounded;
+    std::vector<Uint32> mOwner;
+    std::vector<Uint32> mHandleOf;
+    std::vector<Uint32> mDenseOf;
+    std::vector<Uint32> mFreeHandles;
+    std::vector<float> mPrevX; //!< Positions at the start of the current step; scratch, not saved.
+    std::vector<float> mPrevY;
+    size_t mAwakeCount{0}; //!< Bodies [0, mAwakeCount) are awake, the rest sleep.
+    size_t mMovedCount{0}; //!< Bodies [0, mMovedCount) were awake during the last Step.
+
+    std::vector<SDL_FRect> mStatic;
+    std::vector<Uint32> mCellStart;
+    std::vector<Uint32> mCellItems;
+    int mColumns{1};
+    int mRows{1};
+    bool mGridDirty{true};
+};
@@ -1,121 +1,165 @@
 #pragma once
 #include "GameEntity.h"
+#include "RigidBodyComponent.h"
+
+/*!
+ * \brief Bits of a player action, as read from the keyboard or supplied by a script.
+ */
+enum PlayerActionFlags : Uint8
+{
+    PLAYER_ACTION_NONE = 0,
+    PLAYER_ACTION_LEFT = 1u << 0,
+    PLAYER_ACTION_RIGHT = 1u << 1,
+    PLAYER_ACTION_JUMP = 1u << 2
+};
 
 /*!
  * \struct PlayerGameEntity
  * \brief The PlayerGameEntity struct is specialized to represent the player character in the game.
  *
- * Inherits from GameEntity and adds a SpriteComponent for the player's visual representation. This entity handles
- * user input for movements like walking and jumping, and manages the physics of those actions.
+ * Inherits from GameEntity and adds a SpriteComponent for the player's visual representation and a RigidBodyComponent
+ * for its motion. This entity turns user input into walking and jumping velocities; gravity and landing are handled by
+ * the scene's PhysicsWorld. If the hero spritesheet defines "idle", "run" or "jump" clips, the sprite plays the one
+ * matching the body's motion.
  */
 struct PlayerGameEntity : public GameEntity
 {
-    PlayerGameEntity(SDL_Renderer *renderer) : GameEntity()
+    PlayerGameEntity(SDL_Renderer *renderer, PhysicsWorld &physics, AnimationSystem &animations) : GameEntity()
     {
-        AddComponent<SpriteComponent>(renderer, "assets/hero.bmp");
+        auto spriteComponent = AddComponent<SpriteComponent>(renderer, "assets/hero.bmp");
+        AddComponent<RigidBodyComponent>(physics, spriteComponent->GetRectangle());
+        if (spriteComponent->Animate(animations) > 0)
+        {
+            mIdleClip = spriteComponent->FindClip("idle");
+            mRunClip = spriteComponent->FindClip("run");
+            mJumpClip = spriteComponent->FindClip("jump");
+        }
     }
 
     virtual ~PlayerGameEntity()
     {
     }
 
+    /*!
+     * \brief Reads the keyboard and applies the resulting action.
+     * \param deltaTime The time since the last update.
+     */
     void Input(float deltaTime) override
     {
         const Uint8 *state = SDL_GetKeyboardState(nullptr);
-        auto spriteComponent = this->GetComponent<SpriteComponent>();
-        if (!spriteComponent)
+        Uint8 action = PLAYER_ACTION_NONE;
+        if (state[SDL_SCANCODE_LEFT])
         {
-            return;
+            action |= PLAYER_ACTION_LEFT;
         }
+        if (state[SDL_SCANCODE_RIGHT])
+        {
+            action |= PLAYER_ACTION_RIGHT;
+        }
+        if (state[SDL_SCANCODE_SPACE])
+        {
+            action |= PLAYER_ACTION_JUMP;
+        }
+        ApplyAction(action, deltaTime);
+    }
 
-        float newX = spriteComponent->GetX();
-        float newY = spriteComponent->GetY();
+    /*!
+     * \brief Applies a player action: walking left or right and jumping.
+     * \param action A combination of PlayerActionFlags.
+     * \param deltaTime The time since the last update.
+     *
+     * Sets the body's velocity; the position changes on the next physics step. Left takes precedence over right,
+     * as with the keyboard.
+     */
+    void ApplyAction(Uint8 action, float deltaTime)
+    {
+        auto body = GetComponent<RigidBodyComponent>();
+        if (!body)
+        {
+            return;
+        }
 
-        if (state[SDL_SCANCODE_LEFT])
+        float vx = 0.0f;
+        if (action & PLAYER_ACTION_LEFT)
         {
-            newX -= mSpeed * deltaTime;
+            vx = -mSpeed;
         }
-        else if (state[SDL_SCANCODE_RIGHT])
+        else if (action & PLAYER_ACTION_RIGHT)
         {
-            newX += mSpeed * deltaTime;
+            vx = mSpeed;
         }
 
-        if (state[SDL_SCANCODE_SPACE] && mIsOnGround)
+        if ((action & PLAYER_ACTION_JUMP) && body->IsGrounded())
+        {
+            body->SetVelocity(vx, -mJumpSpeed);
+            body->SetGrounded(false);
+        }
+        else
         {
-            mVerticalSpeed = -mJumpSpeed;
-            mIsOnGround = false;
+            body->SetVelocity(vx, body->GetVelocityY());
         }
-        spriteComponent->SetX(std::clamp(newX, 0.0f, 640.0f - spriteComponent->GetWidth()));
     }
 
+    /*!
+     * \brief Moves the sprite to where the last physics step put the body and picks the clip matching its motion.
+     * \param deltaTime The time since the last update.
+     */
     virtual void Update(float deltaTime) override
     {
-        auto spriteComponent = this->GetComponent<SpriteComponent>();
-        if (!spriteComponent)
+        auto spriteComponent = GetComponent<SpriteComponent>();
+        auto body = GetComponent<RigidBodyComponent>();
+        if (!spriteComponent || !body)
         {
             return;
         }
 
-        if (!mIsOnGround)
+        SDL_FRect box = body->GetBox();
+        spriteComponent->Move(box.x, box.y);
+
+        Uint16 clip = mIdleClip;
+        if (!body->IsGrounded() && mJumpClip != AnimationSystem::kNoClip)
+        {
+            clip = mJumpClip;
+        }
+        else if (body->GetVelocityX() != 0.0f && mRunClip != AnimationSystem::kNoClip)
         {
-            mVerticalSpeed += mGravity * deltaTime;
-            float newY = spriteComponent->GetY() + mVerticalSpeed * deltaTime;
-            if (newY >= 480.0f - spriteComponent->GetHeight())
-            {
-                newY = 480.0f - spriteComponent->GetHeight();
-                mIsOnGround = true;
-                mVerticalSpeed = 0.0f;
-            }
-
-            spriteComponent->SetY(newY);
+            clip = mRunClip;
         }
+        spriteComponent->PlayClip(clip);
     }
 
     /*!
-     * \brief Renders the player entity using the associated renderer.
-     * \param renderer The SDL renderer to draw the player sprite.
+     * \brief Renders the player entity into the frame packet.
+     * \param packet The frame packet to record the player sprite into.
      *
      * Renders the player sprite if the entity is marked as renderable. Retrieves the SpriteComponent
      * and invokes its render method.
      */
-    void Render(SDL_Renderer *renderer) override
+    void Render(FramePacket &packet) override
     {
         auto spriteComponent = this->GetComponent<SpriteComponent>();
         if (spriteComponent)
         {
-            spriteComponent->Render(renderer);
+            spriteComponent->Render(packet);
         }
     }
 
     /*!
-     * \brief Sets the player's ground state.
-     * \param newY The new Y-coordinate for players at the ground.
-     *
-     * This method is called to set the player's position to the ground level and adjust the jumping state accordingly.
+     * \brief Places the player, moving both the sprite and the body.
+     * \param x The new X position.
+     * \param y The new Y position.
      */
-    void SetOnGround(float newY)
+    void Teleport(float x, float y)
     {
         auto spriteComponent = GetComponent<SpriteComponent>();
-
+        auto body = GetComponent<RigidBodyComponent>();
         if (spriteComponent)
         {
-            spriteComponent->SetY(newY);
-            mVerticalSpeed = 0.0f;
-            mIsOnGround = true;
+            spriteComponent->Move(x, y);
         }
-    }
-
-    /*!
-     * \brief Controls whether the player should start falling.
-     * \param value True if the player should fall, false if otherwise.
-     *
-     * Sets the player's on-ground state to false to initiate falling, typically used after jumping.
-     */
-    void SetShouldFall(bool value)
-    {
-        if (value)
+        if (body)
         {
-            mIsOnGround = false;
+            body->SetPosition(x, y);
         }
     }
 
@@ -125,7 +169,7 @@ struct PlayerGameEntity : public GameEntity
      */
     bool IsJumping() const
     {
-        return mVerticalSpeed != 0.0f;
+        return GetVerticalSpeed() != 0.0f;
     }
 
     /*!
@@ -136,13 +180,24 @@ struct PlayerGameEntity : public GameEntity
      */
     float GetVerticalSpeed() const
     {
-        return mVerticalSpeed;
+        auto body = GetComponent<RigidBodyComponent>();
+        return body ? body->GetVelocityY() : 0.0f;
+    }
+
+    /*!
+     * \brief Checks if the player is standing on the ground.
+     * \return True if the player is on the ground.
+     */
+    bool IsOnGround() const
+    {
+        auto body = GetComponent<RigidBodyComponent>();
+        return body && body->IsGrounded();
     }
 
 private:
     float mSpeed{150.0f};
     float mJumpSpeed{450.0f};
-    float mGravity{980.0f};
-    float mVerticalSpeed{0.0f};
-    bool mIsOnGround{true};
+    Uint16 mIdleClip{AnimationSystem::kNoClip};
+    Uint16 mRunClip{AnimationSystem::kNoClip};
+    Uint16 mJumpClip{AnimationSystem::kNoClip};
 };
@@ -0,0 +1,122 @@
+#pragma once
+#ifndef PROTOTYPE_REGISTRY_H
+#define PROTOTYPE_REGISTRY_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief Behavior flags shared by every instance of a prototype.
+ */
+enum PrototypeFlags : Uint32
+{
+    PROTOTYPE_NONE = 0,
+    PROTOTYPE_COLLECTIBLE = 1u << 0, //!< Touching it scores points and hides it.
+    PROTOTYPE_HAZARD = 1u << 1,      //!< Touching it kills the player.
+    PROTOTYPE_SOLID = 1u << 2,       //!< The player can stand on it.
+    PROTOTYPE_CHASER = 1u << 3       //!< Instances with a body walk and jump after the player.
+};
+
+/*!
+ * \struct SpritePrototype
+ * \brief Immutable data shared by every instance of one kind of sprite.
+ *
+ * Instances only store the index of their prototype and their position; texture, size, collision box and
+ * behavior flags are looked up here.
+ */
+struct SpritePrototype
+{
+    std::string name;
+    SDL_Texture *texture = nullptr;
+    float width = 0.0f;
+    float height = 0.0f;
+    SDL_FRect collisionBox{0.0f, 0.0f, 0.0f, 0.0f}; //!< Relative to the instance position.
+    Uint32 flags = PROTOTYPE_NONE;
+    Uint32 collisionLayer = 0; //!< CollisionLayer bits of every instance; 0 means instances have no collider.
+    Uint32 collisionMask = 0;  //!< CollisionLayer bits instances collide with.
+};
+
+/*!
+ * \class PrototypeRegistry
+ * \brief Stores sprite prototypes once and hands out compact indices for them.
+ *
+ * The PrototypeRegistry follows the Singleton design pattern, like ResourceManager. Registering a prototype resolves
+ * its texture through the ResourceManager a single time; registering the same name again returns the existing index.
+ */
+class PrototypeRegistry
+{
+private:
+    PrototypeRegistry();
+    PrototypeRegistry(PrototypeRegistry const &);
+    void operator=(PrototypeRegistry const &);
+
+    std::vector<SpritePrototype> prototypes;
+    std::unordered_map<std::string, Uint16> indices;
+
+public:
+    /*!
+     * \brief Retrieves the singleton instance of PrototypeRegistry.
+     * \return Reference to the singleton PrototypeRegistry instance.
+     */
+    static PrototypeRegistry &GetInstance();
+
+    /*!
+     * \brief Registers a prototype, loading its texture if needed.
+     * \param name Unique name of the prototype.
+     * \param renderer The renderer the texture is created for.
+     * \param image_filename The path to the image file of the sprite.
+     * \param width The width of every instance.
+     * \param height The height of every instance.
+     * \param flags Behavior flags, see PrototypeFlags.
+     * \return The index of the prototype.
+     *
+     * The collision box defaults to the full sprite rectangle.
+     */
+    Uint16 Register(const std::string &name, SDL_Renderer *renderer, const std::string &image_filename, float width, float height, Uint32 flags);
+
+    /*!
+     * \brief Sets the collision layers and mask shared by every instance of a prototype.
+     * \param index An index returned by Register.
+     * \param layer The CollisionLayer bits instances are on.
+     * \param mask The CollisionLayer bits instances collide with.
+     */
+    void SetCollisionFilter(Uint16 index, Uint32 layer, Uint32 mask)
+    {
+        prototypes[index].collisionLayer = layer;
+        prototypes[index].collisionMask = mask;
+    }
+
+    /*!
+     * \brief Looks up the index of a registered prototype.
+     * \param name The name of the prototype.
+     * \return The index, or -1 if no prototype has this name.
+     */
+    int Find(const std::string &name) const;
+
+    /*!
+     * \brief Gets a prototype by index.
+     * \param index An index returned by Register.
+     * \return The prototype.
+     */
+    const SpritePrototype &Get(Uint16 index) const
+    {
+        return prototypes[index];
+    }
+
+    /*!
+     * \brief Gets the number of registered prototypes.
+     */
+    size_t Size() const
+    {
+        return prototypes.size();
+    }
+
+    /*!
+     * \brief Forgets all prototypes. Called when the ResourceManager releases its textures.
+     */
+    void Clear();
+};
+
+#endif // PROTOTYPE_REGISTRY_H
@@ -0,0 +1,611 @@
+#pragma once
+#include "FrameCapture.h"
+#include "FramePacket.h"
+#include "Logger.h"
+#include "SpriteRasterizer.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * \class RenderThread
+ * \brief The RenderThread class owns the SDL_Renderer and executes recorded frame packets on a dedicated thread.
+ *
+ * The renderer is created, used and destroyed only on the render thread. The simulation records frame N+1 into one
+ * packet while the render thread draws and presents frame N from the other. Submit only blocks if the render thread
+ * has not finished the previous frame yet. Any other work that needs the renderer, such as creating textures, is
+ * sent to the render thread with Execute.
+ *
+ * Frames can be captured: each one is then drawn into a texture and read back into a CapturedFrame before it is
+ * presented. Offscreen, frames are not presented at all, and with the CPU rasterizer they do not touch SDL either.
+ */
+class RenderThread
+{
+public:
+    RenderThread() = default;
+
+    /*!
+     * \brief Destructor that stops the render thread if it is still running.
+     */
+    ~RenderThread()
+    {
+        ShutDown();
+    }
+
+    /*!
+     * \brief Starts the render thread and creates the renderer on it.
+     * \param window The window to render into.
+     * \param flags The SDL_RendererFlags to create the renderer with.
+     * \return The created renderer, or nullptr if it could not be created.
+     *
+     * The returned pointer identifies the renderer to code that creates textures; it must only be used through
+     * Execute.
+     */
+    SDL_Renderer *StartUp(SDL_Window *window, Uint32 flags)
+    {
+        mRunning = true;
+        mThread = std::thread(&RenderThread::Run, this, window, flags);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]()
+                        { return mStarted; });
+        return mRenderer;
+    }
+
+    /*!
+     * \brief Waits for all pending work, destroys the renderer and joins the render thread.
+     */
+    void ShutDown()
+    {
+        if (!mThread.joinable())
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRunning = false;
+        }
+        mCondition.notify_all();
+        mThread.join();
+        mRenderer = nullptr;
+        mStarted = false;
+    }
+
+    /*!
+     * \brief Gets the renderer owned by the render thread.
+     */
+    SDL_Renderer *GetRenderer() const
+    {
+        return mRenderer;
+    }
+
+    /*!
+     * \brief Gets the packet the simulation should record the next frame into.
+     * \return The recording packet, cleared.
+     */
+    FramePacket &BeginFrame()
+    {
+        FramePacket &packet = mPackets[mRecordIndex];
+        packet.Clear();
+        return packet;
+    }
+
+    /*!
+     * \brief Hands the recorded packet to the render thread.
+     *
+     * Waits until the render thread has finished the previous packet, so the simulation is at most one frame ahead,
+     * then swaps packets and returns immediately.
+     */
+    void Submit()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]()
+                        { return !mPacketReady && !mBusy; });
+        mPendingIndex = mRecordIndex;
+        mPacketReady = true;
+        mRecordIndex ^= 1;
+        lock.unlock();
+        mCondition.notify_all();
+    }
+
+    /*!
+     * \brief Waits until every submitted packet and task has been executed.
+     */
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]()
+                        { return !mPacketReady && !mBusy && mTasks.empty(); });
+    }
+
+    /*!
+     * \brief Runs a function on the render thread and waits for it to finish.
+     * \param task The function to run; it receives the renderer.
+     *
+     * Called from the render thread itself, the task runs inline.
+     */
+    void Execute(const std::function<void(SDL_Renderer *)> &task)
+    {
+        if (!mThread.joinable() || std::this_thread::get_id() == mThread.get_id())
+        {
+            task(mRenderer);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        Uint64 ticket = ++mTasksSubmitted;
+        mTasks.push_back(task);
+        mCondition.notify_all();
+        mCondition.wait(lock, [this, ticket]()
+                        { return mTasksCompleted >= ticket; });
+    }
+
+    /*!
+     * \brief Drops the CPU rasterizer's copies of texture pixels. Only called on the render thread, e.g. from an Execute
+     * task that destroys textures, so the copies do not outlive the textures they are keyed by.
+     */
+    void ForgetTextures()
+    {
+        if (mRasterizer)
+        {
+            mRasterizer->ClearTextures();
+        }
+    }
+
+    /*!
+     * \brief Retrieves the timing of the most recently presented frame.
+     * \param timing Receives the timing of the frame.
+     * \return True if a frame has been presented since the last call.
+     */
+    bool TakePresentedTiming(FrameTiming &timing)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mHasPresented)
+        {
+            return false;
+        }
+        timing = mPresentedTiming;
+        mHasPresented = false;
+        return true;
+    }
+
+    /*!
+     * \brief Switches the scene layer between SDL's renderer and the SpriteRasterizer, from the next frame on.
+     * \param enabled Whether the scene is rasterized on the CPU and uploaded as one texture.
+     * \param threads The threads the rasterizer uses, including the render thread; 0 uses one per core.
+     */
+    void SetCpuRasterizer(bool enabled, size_t threads = 0)
+    {
+        mCpuThreads = threads;
+        mCpuRasterizer = enabled;
+    }
+
+    /*!
+     * \brief Checks whether the scene layer is rasterized on the CPU.
+     */
+    bool IsCpuRasterizer() const
+    {
+        return mCpuRasterizer;
+    }
+
+    /*!
+     * \brief Turns capturing every drawn frame on or off, from the next frame on.
+     *
+     * Off, the last captured frame is forgotten.
+     */
+    void SetFrameCapture(bool enabled)
+    {
+        mCaptureFrames = enabled;
+        if (!enabled)
+        {
+            mCaptures.Reset();
+        }
+    }
+
+    /*!
+     * \brief Checks whether frames are captured.
+     */
+    bool IsFrameCapture() const
+    {
+        return mCaptureFrames;
+    }
+
+    /*!
+     * \brief Turns presenting frames to the window off or on, from the next frame on.
+     * \param offscreen Whether frames are only drawn, into a texture or with the CPU rasterizer into memory.
+     */
+    void SetOffscreen(bool offscreen)
+    {
+        mOffscreen = offscreen;
+    }
+
+    /*!
+     * \brief Checks whether frames are drawn without being presented.
+     */
+    bool IsOffscreen() const
+    {
+        return mOffscreen;
+    }
+
+    /*!
+     * \brief Gets the most recently captured frame without waiting, or nullptr if none was captured.
+     *
+     * The frame stays valid and unchanged for as long as it is held. Call Flush first to get the last submitted frame.
+     */
+    std::shared_ptr<const CapturedFrame> GetCapturedFrame() const
+    {
+        return mCaptures.GetLatest();
+    }
+
+private:
+    /*!
+     * \brief Body of the render thread: creates the renderer, then executes tasks and packets until shut down.
+     */
+    void Run(SDL_Window *window, Uint32 flags)
+    {
+        SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, flags);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRenderer = renderer;
+            mStarted = true;
+        }
+        mCondition.notify_all();
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        for (;;)
+        {
+            mCondition.wait(lock, [this]()
+                            { return mPacketReady || !mTasks.empty() || !mRunning; });
+
+            if (!mTasks.empty())
+            {
+                std::vector<std::function<void(SDL_Renderer *)>> tasks;
+                tasks.swap(mTasks);
+                mBusy = true;
+                lock.unlock();
+                for (auto &task : tasks)
+                {
+                    task(renderer);
+                }
+                lock.lock();
+                mTasksCompleted += tasks.size();
+                mBusy = false;
+                mCondition.notify_all();
+                continue;
+            }
+
+            if (mPacketReady)
+            {
+                FramePacket &packet = mPackets[mPendingIndex];
+                mPacketReady = false;
+                mBusy = true;
+                lock.unlock();
+                Draw(renderer, packet);
+                lock.lock();
+                mPresentedTiming = packet.timing;
+                mHasPresented = true;
+                mBusy = false;
+                mCondition.notify_all();
+                continue;
+            }
+
+            if (!mRunning)
+            {
+                break;
+            }
+        }
+        lock.unlock();
+
+        for (RenderTarget *target : {&mSceneTarget, &mFrameTarget})
+        {
+            if (target->texture)
+            {
+                SDL_DestroyTexture(target->texture);
+                target->texture = nullptr;
+            }
+        }
+        if (mCpuTexture)
+        {
+            SDL_DestroyTexture(mCpuTexture);
+            mCpuTexture = nullptr;
+        }
+        mRasterizer.reset();
+        if (renderer)
+        {
+            SDL_DestroyRenderer(renderer);
+        }
+    }
+
+    /*!
+     * \brief Executes the commands of a packet and presents the frame.
+     *
+     * At a render scale below 1 the scene layer is drawn into the top-left part of an offscreen target, scaled down by
+     * the render scale, and then stretched over the window with linear filtering; the overlay layer is drawn on top at
+     * full resolution. The target is created once at the window's size and reused for every scale.
+     *
+     * With the CPU rasterizer the scene layer is instead rasterized at the scaled size, uploaded into the top-left part
+     * of a streaming texture and stretched over the window the same way.
+     *
+     * Offscreen or capturing, the whole frame is drawn into a frame target of the window's size instead of the window,
+     * and copied to the window only if it is presented. Offscreen with the CPU rasterizer, see DrawHeadless.
+     */
+    void Draw(SDL_Renderer *renderer, FramePacket &packet)
+    {
+        if (renderer == nullptr)
+        {
+            return;
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        mFramesDrawn++;
+
+        int width = 0;
+        int height = 0;
+        SDL_GetRendererOutputSize(renderer, &width, &height);
+        if (mOffscreen && mCpuRasterizer)
+        {
+            DrawHeadless(packet, width, height, start);
+            return;
+        }
+
+        // Without render target support the frame is drawn into, and read back from, the window's back buffer
+        SDL_Texture *frameTarget = nullptr;
+        if ((mOffscreen || mCaptureFrames) && PrepareTarget(renderer, mFrameTarget, width, height, SDL_ScaleModeNearest))
+        {
+            frameTarget = mFrameTarget.texture;
+            SDL_SetRenderTarget(renderer, frameTarget);
+        }
+
+        SDL_Rect scaled{0, 0, width, height};
+        if (mCpuRasterizer && DrawSceneOnCpu(renderer, packet, width, height))
+        {
+            FinishFrame(renderer, packet, start, frameTarget, width, height);
+            return;
+        }
+
+        bool offscreen = packet.GetRenderScale() < 1.0f && PrepareTarget(renderer, mSceneTarget, width, height, SDL_ScaleModeLinear);
+        SDL_Color clear = packet.GetClearColor();
+        SDL_SetRenderDrawColor(renderer, clear.r, clear.g, clear.b, clear.a);
+        if (offscreen)
+        {
+            // Only the scaled-down part of the target is filled, so clearing costs no more than drawing
+            scaled.w = std::max(1, static_cast<int>(width * packet.GetRenderScale() + 0.5f));
+            scaled.h = std::max(1, static_cast<int>(height * packet.GetRenderScale() + 0.5f));
+            SDL_SetRenderTarget(renderer, mSceneTarget.texture);
+            SDL_RenderSetScale(renderer, static_cast<float>(scaled.w) / width, static_cast<float>(scaled.h) / height);
+            SDL_FRect all{0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)};
+            SDL_RenderFillRectF(renderer, &all);
+        }
+        else
+        {
+            SDL_RenderClear(renderer);
+        }
+
+        DrawCommands(renderer, packet, 0, packet.GetSceneSpriteCount(), 0, packet.GetSceneBatchCount());
+        if (offscreen)
+        {
+            SDL_SetRenderTarget(renderer, frameTarget);
+            SDL_RenderCopy(renderer, mSceneTarget.texture, &scaled, nullptr);
+        }
+        FinishFrame(renderer, packet, start, frameTarget, width, height);
+    }
+
+    /*!
+     * \brief Draws the overlay layer on top of the scene, captures the frame if asked to and presents it.
+     * \param start The performance counter when drawing the frame began.
+     * \param frameTarget The texture the frame was drawn into, or nullptr for the window.
+     *
+     * The readback is not counted in the render time, as it does not shrink with the render scale.
+     */
+    void FinishFrame(SDL_Renderer *renderer, FramePacket &packet, Uint64 start, SDL_Texture *frameTarget, int width, int height)
+    {
+        DrawCommands(renderer, packet, packet.GetSceneSpriteCount(), packet.GetSprites().size(), packet.GetSceneBatchCount(),
+                     packet.GetBatches().size());
+        packet.timing.renderMs = static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+        if (mCaptureFrames)
+        {
+            std::shared_ptr<CapturedFrame> frame = mCaptures.Acquire(width, height);
+            if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, frame->pixels.data(), width * static_cast<int>(sizeof(Uint32))) == 0)
+            {
+                frame->index = mFramesDrawn;
+                mCaptures.Publish(std::move(frame));
+            }
+            else
+            {
+                LOG_WARN("Cannot read the frame back, capture turned off: %s", SDL_GetError());
+                mCaptureFrames = false;
+            }
+        }
+        if (frameTarget)
+        {
+            SDL_SetRenderTarget(renderer, nullptr);
+            if (!mOffscreen)
+            {
+                SDL_RenderCopy(renderer, frameTarget, nullptr, nullptr);
+            }
+        }
+        if (!mOffscreen)
+        {
+            SDL_RenderPresent(renderer);
+        }
+
+        packet.timing.presentCounter = SDL_GetPerformanceCounter();
+        packet.timing.presentTicks = SDL_GetTicks();
+    }
+
+    /*!
+     * \brief Draws a frame offscreen entirely with the CPU rasterizer, without any SDL rendering.
+     *
+     * The scene and the overlay are rasterized together at full resolution, whatever the render scale, and a captured
+     * frame takes over the rasterizer's framebuffer rather than copying it.
+     */
+    void DrawHeadless(FramePacket &packet, int width, int height, Uint64 start)
+    {
+        SpriteRasterizer &rasterizer = GetRasterizer();
+        rasterizer.Render(packet, width, height, 1.0f, true);
+        packet.timing.renderMs = static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+        if (mCaptureFrames)
+        {
+            std::shared_ptr<CapturedFrame> frame = mCaptures.Acquire(width, height);
+            rasterizer.SwapPixels(frame->pixels);
+            frame->index = mFramesDrawn;
+            mCaptures.Publish(std::move(frame));
+        }
+        packet.timing.presentCounter = SDL_GetPerformanceCounter();
+        packet.timing.presentTicks = SDL_GetTicks();
+    }
+
+    /*!
+     * \brief Executes a range of a packet's sprite draws, then a range of its quad batches.
+     */
+    static void DrawCommands(SDL_Renderer *renderer, const FramePacket &packet, size_t firstSprite, size_t endSprite, size_t firstBatch,
+                             size_t endBatch)
+    {
+        const std::vector<SpriteDrawCommand> &sprites = packet.GetSprites();
+        for (size_t i = firstSprite; i < endSprite; i++)
+        {
+            const SpriteDrawCommand &command = sprites[i];
+            const SDL_Rect *source = command.source.w > 0 ? &command.source : NULL;
+            SDL_RenderCopyF(renderer, command.texture, source, &command.destination);
+        }
+        const std::vector<GeometryBatch> &batches = packet.GetBatches();
+        for (size_t i = firstBatch; i < endBatch; i++)
+        {
+            const GeometryBatch &batch = batches[i];
+            SDL_RenderGeometry(renderer, batch.texture, packet.GetVertices() + batch.firstVertex, static_cast<int>(batch.quadCount * 4),
+                               packet.GetQuadIndices(), static_cast<int>(batch.quadCount * 6));
+        }
+    }
+
+    /*!
+     * \brief Rasterizes the scene layer with the SpriteRasterizer and copies it over the window.
+     * \return False if the streaming texture cannot be created; the scene is then left to SDL.
+     */
+    bool DrawSceneOnCpu(SDL_Renderer *renderer, const FramePacket &packet, int width, int height)
+    {
+        SpriteRasterizer &rasterizer = GetRasterizer();
+        if (mCpuTexture == nullptr || mCpuTextureWidth != width || mCpuTextureHeight != height)
+        {
+            if (mCpuTexture)
+            {
+                SDL_DestroyTexture(mCpuTexture);
+            }
+            mCpuTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+            if (mCpuTexture == nullptr)
+            {
+                LOG_WARN("Cannot create the CPU raster texture, rendering with SDL: %s", SDL_GetError());
+                mCpuRasterizer = false;
+                return false;
+            }
+            SDL_SetTextureScaleMode(mCpuTexture, SDL_ScaleModeLinear);
+            mCpuTextureWidth = width;
+            mCpuTextureHeight = height;
+        }
+
+        float scale = std::min(packet.GetRenderScale(), 1.0f);
+        SDL_Rect scaled{0, 0, std::max(1, static_cast<int>(width * scale + 0.5f)), std::max(1, static_cast<int>(height * scale + 0.5f))};
+        rasterizer.Render(packet, scaled.w, scaled.h, scale);
+        SDL_UpdateTexture(mCpuTexture, &scaled, rasterizer.GetPixels(), scaled.w * static_cast<int>(sizeof(Uint32)));
+        SDL_RenderCopy(renderer, mCpuTexture, &scaled, nullptr);
+        return true;
+    }
+
+    /*!
+     * \brief Gets the CPU rasterizer, created with the requested number of threads.
+     */
+    SpriteRasterizer &GetRasterizer()
+    {
+        size_t threads = mCpuThreads;
+        if (!mRasterizer || (threads != 0 && mRasterizer->GetThreadCount() != threads))
+        {
+            mRasterizer = std::make_unique<SpriteRasterizer>(threads);
+        }
+        return *mRasterizer;
+    }
+
+    /*!
+     * \brief A texture to render into, the size of the window.
+     */
+    struct RenderTarget
+    {
+        SDL_Texture *texture{nullptr};
+        int width{0};
+        int height{0};
+        bool failed{false}; //!< Whether it could not be created; not retried.
+    };
+
+    /*!
+     * \brief Makes sure a render target exists and matches the window's size.
+     * \param scaleMode How the target is filtered when it is copied to the window.
+     * \return False if the renderer cannot render to textures; the caller then draws into the window.
+     */
+    static bool PrepareTarget(SDL_Renderer *renderer, RenderTarget &target, int width, int height, SDL_ScaleMode scaleMode)
+    {
+        if (target.texture && target.width == width && target.height == height)
+        {
+            return true;
+        }
+        if (target.texture)
+        {
+            SDL_DestroyTexture(target.texture);
+            target.texture = nullptr;
+        }
+        if (target.failed || !SDL_RenderTargetSupported(renderer))
+        {
+            target.failed = true;
+            return false;
+        }
+        target.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (target.texture == nullptr)
+        {
+            LOG_WARN("Cannot create a render target, drawing into the window: %s", SDL_GetError());
+            target.failed = true;
+            return false;
+        }
+        SDL_SetTextureScaleMode(target.texture, scaleMode);
+        target.width = width;
+        target.height = height;
+        return true;
+    }
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    SDL_Renderer *mRenderer{nullptr};
+    bool mStarted{false};
+    bool mRunning{false};
+
+    FramePacket mPackets[2];
+    int mRecordIndex{0};
+    int mPendingIndex{0};
+    bool mPacketReady{false};
+    bool mBusy{false};
+    std::vector<std::function<void(SDL_Renderer *)>> mTasks;
+    Uint64 mTasksSubmitted{0};
+    Uint64 mTasksCompleted{0};
+
+    FrameTiming mPresentedTiming;
+    bool mHasPresented{false};
+
+    // Only touched on the render thread
+    RenderTarget mSceneTarget; //!< Offscreen target of a scaled scene layer.
+    RenderTarget mFrameTarget; //!< Target of whole frames drawn offscreen or captured.
+    Uint64 mFramesDrawn{0};
+
+    std::atomic<bool> mCpuRasterizer{false};
+    std::atomic<size_t> mCpuThreads{0};
+    std::unique_ptr<SpriteRasterizer> mRasterizer; //!< Created on the render thread when first used.
+    SDL_Texture *mCpuTexture{nullptr};
+    int mCpuTextureWidth{0};
+    int mCpuTextureHeight{0};
+
+    std::atomic<bool> mCaptureFrames{false};
+    std::atomic<bool> mOffscreen{false};
+    FrameCapture mCaptures;
+};
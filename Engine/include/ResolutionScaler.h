@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+/*!
+ * \class ResolutionScaler
+ * \brief The ResolutionScaler picks the render scale of the scene so the render thread stays within a frame-time budget.
+ *
+ * It is fed the render thread's drawing time of every presented frame and smooths it with an exponential moving
+ * average. The fill cost of the software renderer grows with the number of pixels, i.e. with the square of the scale,
+ * so when the average stays over the budget for kDownFrames frames the scale drops at once to the one predicted to fit,
+ * with some headroom. It only rises again one kStep at a time, after the average stayed below kUpThreshold of the
+ * budget for kUpFrames frames. The gap between the two thresholds and the waits keep the scale from oscillating, and
+ * after every change kSettleFrames frames are ignored while frames drawn at the old scale are still being presented.
+ */
+class ResolutionScaler
+{
+public:
+    static constexpr float kStep = 0.05f;         //!< Scales are multiples of this.
+    static constexpr double kUpThreshold = 0.7;   //!< Fraction of the budget the average must stay below to scale up.
+    static constexpr double kHeadroom = 0.85;     //!< Fraction of the budget a scale-down aims for.
+    static constexpr int kDownFrames = 6;
+    static constexpr int kUpFrames = 90;
+    static constexpr int kSettleFrames = 10;
+    static constexpr double kSmoothing = 0.15;    //!< Weight of a new sample in the average.
+
+    /*!
+     * \brief Sets the render time the scale is adjusted to hold.
+     * \param budgetMs Milliseconds per frame; 0 leaves it to the main loop to use its frame time.
+     */
+    void SetBudget(double budgetMs)
+    {
+        mBudgetMs = std::max(0.0, budgetMs);
+        Reset();
+    }
+
+    /*!
+     * \brief Gets the render time budget in milliseconds, or 0 if none was set.
+     */
+    double GetBudget() const
+    {
+        return mBudgetMs;
+    }
+
+    /*!
+     * \brief Turns the scaling on or off. Off, the scale goes back to the upper limit.
+     */
+    void SetEnabled(bool enabled)
+    {
+        mEnabled = enabled;
+        if (!enabled)
+        {
+            mScale = mMaxScale;
+        }
+        Reset();
+    }
+
+    /*!
+     * \brief Checks whether the scale adapts to the budget.
+     */
+    bool IsEnabled() const
+    {
+        return mEnabled;
+    }
+
+    /*!
+     * \brief Sets the range the scale may move in; equal limits fix the scale.
+     * \param minScale The lowest scale, at least kStep.
+     * \param maxScale The highest scale, at most 1.
+     */
+    void SetLimits(float minScale, float maxScale)
+    {
+        mMinScale = std::clamp(Snap(minScale), kStep, 1.0f);
+        mMaxScale = std::clamp(Snap(maxScale), mMinScale, 1.0f);
+        mScale = std::clamp(mScale, mMinScale, mMaxScale);
+        Reset();
+    }
+
+    /*!
+     * \brief Gets the lowest scale.
+     */
+    float GetMinScale() const
+    {
+        return mMinScale;
+    }
+
+    /*!
+     * \brief Gets the highest scale.
+     */
+    float GetMaxScale() const
+    {
+        return mMaxScale;
+    }
+
+    /*!
+     * \brief Records the render time of a presented frame and adjusts the scale.
+     * \param renderMs The render thread's drawing time of the frame.
+     */
+    void AddSample(double renderMs)
+    {
+        mAverageMs = mHasAverage ? mAverageMs + (renderMs - mAverageMs) * kSmoothing : renderMs;
+        mHasAverage = true;
+        if (!mEnabled || mBudgetMs <= 0.0)
+        {
+            return;
+        }
+        if (mSettle > 0)
+        {
+            mSettle--;
+            return;
+        }
+
+        mOver = mAverageMs > mBudgetMs ? mOver + 1 : 0;
+        mUnder = mAverageMs < mBudgetMs * kUpThreshold ? mUnder + 1 : 0;
+        if (mOver >= kDownFrames && mScale > mMinScale)
+        {
+            // Cost is proportional to the pixel count; drop by at least one step
+            float target = mScale * static_cast<float>(std::sqrt(mBudgetMs * kHeadroom / mAverageMs));
+            SetScale(std::min(std::floor(target / kStep) * kStep, mScale - kStep));
+        }
+        else if (mUnder >= kUpFrames && mScale < mMaxScale)
+        {
+            SetScale(mScale + kStep);
+        }
+    }
+
+    /*!
+     * \brief Gets the scale the scene should be rendered at.
+     */
+    float GetScale() const
+    {
+        return mScale;
+    }
+
+    /*!
+     * \brief Gets the smoothed render time in milliseconds.
+     */
+    double GetAverageMs() const
+    {
+        return mAverageMs;
+    }
+
+private:
+    static float Snap(float scale)
+    {
+        return std::round(scale / kStep) * kStep;
+    }
+
+    /*!
+     * \brief Changes the scale and predicts the average at the new one, so it does not trigger again right away.
+     */
+    void SetScale(float scale)
+    {
+        float previous = mScale;
+        mScale = std::clamp(Snap(scale), mMinScale, mMaxScale);
+        double ratio = static_cast<double>(mScale) / previous;
+        mAverageMs *= ratio * ratio;
+        mSettle = kSettleFrames;
+        mOver = 0;
+        mUnder = 0;
+    }
+
+    void Reset()
+    {
+        mOver = 0;
+        mUnder = 0;
+        mSettle = 0;
+    }
+
+    double mBudgetMs{0.0};
+    double mAverageMs{0.0};
+    bool mHasAverage{false};
+    bool mEnabled{true};
+    float mScale{1.0f};
+    float mMinScale{0.5f};
+    float mMaxScale{1.0f};
+    int mOver{0};
+    int mUnder{0};
+    int mSettle{0};
+};
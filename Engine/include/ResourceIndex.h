@@ -0,0 +1,217 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+ * \class ResourceIndex
+ * \brief A read-mostly map from names, or other keys, to resources that any number of threads may look up and insert into at once.
+ *
+ * Keys are spread over kShards shards by hash. Each shard is an open-addressing table of atomic pointers to nodes,
+ * and a node is never moved or freed before Clear, so a lookup is a handful of acquire loads and never takes a lock;
+ * the value it returns stays valid until Clear. Inserts take the lock of their shard only. A full table is copied into
+ * one twice the size, which is published with a single store while readers finish their probe of the old one; old
+ * tables are retired rather than freed, which costs at most as much memory as the live table.
+ *
+ * Clear and ForEach must not run concurrently with anything else, e.g. only at shutdown.
+ */
+template <typename T, typename Key = std::string>
+class ResourceIndex
+{
+public:
+    static constexpr int kShardBits = 4;
+    static constexpr size_t kShards = size_t{1} << kShardBits;
+
+    ResourceIndex() = default;
+    ResourceIndex(const ResourceIndex &) = delete;
+    ResourceIndex &operator=(const ResourceIndex &) = delete;
+
+    /*!
+     * \brief Looks up a value without locking.
+     * \return The value, or nullptr if nothing was inserted under the key yet.
+     */
+    T *Find(const Key &key) const
+    {
+        size_t hash = HashOf(key);
+        const Table *table = mShards[ShardOf(hash)].table.load(std::memory_order_acquire);
+        return table ? Probe(*table, hash, key) : nullptr;
+    }
+
+    /*!
+     * \brief Inserts a value unless the key is taken.
+     * \param key The name.
+     * \param value The value, only moved from if it is inserted.
+     * \return The value stored under the key and whether it is the one just inserted. If another thread inserted the key
+     * first, its value is returned and the caller still owns value.
+     */
+    std::pair<T *, bool> Insert(const Key &key, T &&value)
+    {
+        size_t hash = HashOf(key);
+        Shard &shard = mShards[ShardOf(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        Table *table = shard.table.load(std::memory_order_relaxed);
+        if (table)
+        {
+            if (T *existing = Probe(*table, hash, key))
+            {
+                return {existing, false};
+            }
+        }
+        if (table == nullptr || (shard.count + 1) * 2 > table->mask + 1)
+        {
+            table = Grow(shard);
+        }
+
+        shard.nodes.push_back(std::make_unique<Node>(Node{key, hash, std::move(value)}));
+        Node *node = shard.nodes.back().get();
+        Link(*table, node);
+        shard.count++;
+        mSize.fetch_add(1, std::memory_order_relaxed);
+        return {&node->value, true};
+    }
+
+    /*!
+     * \brief Gets the number of values.
+     */
+    size_t Size() const
+    {
+        return mSize.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Calls a function for every key and value. Not safe against concurrent inserts.
+     */
+    void ForEach(const std::function<void(const Key &, T &)> &function)
+    {
+        for (Shard &shard : mShards)
+        {
+            for (std::unique_ptr<Node> &node : shard.nodes)
+            {
+                function(node->key, node->value);
+            }
+        }
+    }
+
+    /*!
+     * \brief Removes every value. Nothing may be looking up or inserting, and pointers handed out become invalid.
+     */
+    void Clear()
+    {
+        for (Shard &shard : mShards)
+        {
+            shard.table.store(nullptr, std::memory_order_relaxed);
+            shard.tables.clear();
+            shard.nodes.clear();
+            shard.count = 0;
+        }
+        mSize.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct Node
+    {
+        Key key;
+        size_t hash;
+        T value;
+    };
+
+    struct Table
+    {
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new std::atomic<Node *>[capacity])
+        {
+            for (size_t i = 0; i < capacity; i++)
+            {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<Node *>[]> slots;
+    };
+
+    /*!
+     * \brief A shard, on its own cache lines so that inserting into one does not slow down lookups in another.
+     */
+    struct alignas(64) Shard
+    {
+        std::atomic<Table *> table{nullptr};
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Table>> tables; //!< The live table last; older ones may still be read.
+        std::vector<std::unique_ptr<Node>> nodes;
+        size_t count{0};
+    };
+
+    /*!
+     * \brief Hashes a key, mixing the bits so that both the high bits picking the shard and the low bits picking the
+     * slot depend on all of it; std::hash of a pointer or integer is the value itself.
+     */
+    static size_t HashOf(const Key &key)
+    {
+        uint64_t hash = std::hash<Key>{}(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        if constexpr (sizeof(size_t) < sizeof(uint64_t))
+        {
+            hash ^= hash >> 32;
+        }
+        return static_cast<size_t>(hash);
+    }
+
+    static size_t ShardOf(size_t hash)
+    {
+        // The low bits pick the slot, so pick the shard from the high ones
+        return (hash >> (sizeof(size_t) * 8 - kShardBits)) & (kShards - 1);
+    }
+
+    static T *Probe(const Table &table, size_t hash, const Key &key)
+    {
+        for (size_t slot = hash & table.mask;; slot = (slot + 1) & table.mask)
+        {
+            Node *node = table.slots[slot].load(std::memory_order_acquire);
+            if (node == nullptr)
+            {
+                return nullptr;
+            }
+            if (node->hash == hash && node->key == key)
+            {
+                return &node->value;
+            }
+        }
+    }
+
+    static void Link(Table &table, Node *node)
+    {
+        size_t slot = node->hash & table.mask;
+        while (table.slots[slot].load(std::memory_order_relaxed) != nullptr)
+        {
+            slot = (slot + 1) & table.mask;
+        }
+        table.slots[slot].store(node, std::memory_order_release);
+    }
+
+    /*!
+     * \brief Builds a table twice the size holding every node of the shard and publishes it. Called with the lock held.
+     */
+    static Table *Grow(Shard &shard)
+    {
+        Table *old = shard.table.load(std::memory_order_relaxed);
+        auto table = std::make_unique<Table>(old ? (old->mask + 1) * 2 : 16);
+        for (std::unique_ptr<Node> &node : shard.nodes)
+        {
+            Link(*table, node.get());
+        }
+        shard.tables.push_back(std::move(table));
+        shard.table.store(shard.tables.back().get(), std::memory_order_release);
+        return shard.tables.back().get();
+    }
+
+    Shard mShards[kShards];
+    std::atomic<size_t> mSize{0};
+};
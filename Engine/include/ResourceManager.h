@@ -2,17 +2,44 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
+#include "AssetPack.h"
+#include "ResourceIndex.h"
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include <SDL2/SDL.h>
 
+class RenderThread;
+
+/*!
+ * \struct SoundBuffer
+ * \brief A sound decoded once into the format the mixer plays: interleaved stereo 32-bit float frames.
+ */
+struct SoundBuffer
+{
+    std::vector<float> samples; //!< Two samples (left, right) per frame.
+    int frequency{0};           //!< Frames per second.
+
+    /*!
+     * \brief Gets the number of frames.
+     */
+    size_t GetFrameCount() const
+    {
+        return samples.size() / 2;
+    }
+};
+
 /*!
  * \class ResourceManager
- * \brief Manages the loading, access, and unloading of resources such as textures.
+ * \brief Manages the loading, access, and unloading of resources such as textures and sounds.
  *
  * The ResourceManager class follows the Singleton design pattern to ensure only one instance manages all resources
  * in the application. It provides methods to load resources from files, retrieve loaded resources, and perform
  * cleanup on shutdown.
+ *
+ * Every method but StartUp, ShutDown, MountPack and SetRenderThread may be called from any thread. Lookups never lock,
+ * and loads of different files run in parallel. CPU-side data, i.e. decoded images and sounds, is loaded on the
+ * calling thread; textures are created and destroyed on the render thread. Two threads loading the same file at once
+ * both decode it and the first to finish wins; the other copy is freed again.
  */
 class ResourceManager
 {
@@ -45,7 +72,48 @@ private:
      *
      * Maps resource identifiers to SDL_Texture pointers. Ensures each resource is only loaded once.
      */
-    std::unordered_map<std::string, SDL_Texture *> resources;
+    ResourceIndex<SDL_Texture *> resources;
+
+    /*!
+     * \brief Container for storing decoded images, owned by the manager.
+     *
+     * Maps file names to the surfaces their textures were created from, so code on any thread can read the pixels.
+     */
+    ResourceIndex<SDL_Surface *> images;
+
+    /*!
+     * \brief Maps every texture to the image in images it was created from, for rendering on the CPU.
+     */
+    ResourceIndex<const SDL_Surface *, SDL_Texture *> textureImages;
+
+    /*!
+     * \brief Container for storing decoded sounds.
+     *
+     * Maps file names to PCM buffers. Buffers never move once loaded, so the audio thread can read them while more
+     * sounds are loaded.
+     */
+    ResourceIndex<SoundBuffer> sounds;
+
+    /*!
+     * \brief The thread that owns the renderer, or nullptr to create textures on the calling thread.
+     */
+    RenderThread *mRenderThread = nullptr;
+
+    /*!
+     * \brief The mounted asset pack, searched before loose files.
+     */
+    AssetPack pack;
+
+    /*!
+     * \brief Opens an asset from the pack, or else from a loose file.
+     * \param filename The asset path, e.g. "assets/hero.bmp".
+     * \param scratch Holds the bytes of a compressed pack entry; it must outlive the stream.
+     * \return A stream to read the asset from, or nullptr if it exists in neither.
+     *
+     * Code refers to assets as "assets/...", while the directory in the source tree is "Assets"; on a case-sensitive
+     * file system the loose file is looked up under both spellings.
+     */
+    SDL_RWops *OpenAsset(const std::string &filename, std::vector<Uint8> &scratch);
 
 public:
     /*!
@@ -62,10 +130,45 @@ public:
      * \param image_filename The path to the image file to load.
      *
      * Loads an image from the specified file path and creates an SDL_Texture from it. The texture is stored
-     * in the resources container.
+     * in the resources container. The image is decoded on the calling thread with LoadImage; the texture is created on
+     * the render thread if one is set, otherwise the caller must own the renderer. Without a renderer or render thread
+     * nothing is loaded.
      */
     void LoadResource(SDL_Renderer *renderer, const std::string &image_filename);
 
+    /*!
+     * \brief Decodes an image without creating a texture.
+     * \param image_filename The path to the image file to load.
+     * \return The decoded image, or nullptr if it cannot be loaded. Owned by the manager and valid until ShutDown;
+     * it must not be modified.
+     */
+    const SDL_Surface *LoadImage(const std::string &image_filename);
+
+    /*!
+     * \brief Retrieves a decoded image.
+     * \param key The path the image was loaded from.
+     * \return The image, or nullptr if it has not been loaded.
+     */
+    const SDL_Surface *GetImage(const std::string &key) const;
+
+    /*!
+     * \brief Retrieves the image a texture was created from, so it can be drawn without the renderer.
+     * \param texture A texture created by LoadResource or LoadSurface.
+     * \return The image, or nullptr for textures the manager did not create. Valid until ShutDown.
+     */
+    const SDL_Surface *GetTextureImage(SDL_Texture *texture) const;
+
+    /*!
+     * \brief Creates a texture from a surface built in memory, e.g. a generated atlas.
+     * \param renderer Pointer to the SDL_Renderer to use for texture creation.
+     * \param key The identifier to store the texture under; nothing is created if it is already taken.
+     * \param surface The pixels to upload. The caller keeps ownership.
+     *
+     * Like LoadResource, the texture is created on the render thread if one is set and is destroyed by ShutDown. A copy
+     * of the pixels is kept as the image of the key unless one was loaded already.
+     */
+    void LoadSurface(SDL_Renderer *renderer, const std::string &key, SDL_Surface *surface);
+
     /*!
      * \brief Retrieves a loaded texture resource.
      * \param key The identifier of the resource to retrieve.
@@ -73,7 +176,41 @@ public:
      *
      * Looks up a resource by its identifier and returns a pointer to the SDL_Texture if it exists.
      */
-    SDL_Texture *GetResource(const std::string &key);
+    SDL_Texture *GetResource(const std::string &key) const;
+
+    /*!
+     * \brief Loads a WAV file and converts it to stereo float PCM once.
+     * \param sound_filename The path to the WAV file to load.
+     * \param frequency The sample rate to convert to, normally the mixer's.
+     *
+     * Loading a sound that is already cached does nothing, even if the frequency differs.
+     */
+    void LoadSound(const std::string &sound_filename, int frequency);
+
+    /*!
+     * \brief Retrieves a loaded sound.
+     * \param key The path the sound was loaded from.
+     * \return The decoded sound, or nullptr if not found. Valid until ShutDown.
+     */
+    const SoundBuffer *GetSound(const std::string &key) const;
+
+    /*!
+     * \brief Maps an asset pack that later loads are served from first.
+     * \param path The path of the pack written by pack_assets.py.
+     * \return True if the pack was mounted; otherwise assets are loaded from loose files.
+     */
+    bool MountPack(const std::string &path);
+
+    /*!
+     * \brief Gets the mounted asset pack.
+     */
+    const AssetPack &GetPack() const;
+
+    /*!
+     * \brief Sets the render thread that texture creation and destruction are sent to.
+     * \param renderThread The thread owning the renderer, or nullptr.
+     */
+    void SetRenderThread(RenderThread *renderThread);
 
     /*!
      * \brief Initializes the ResourceManager.
@@ -85,7 +222,8 @@ public:
     /*!
      * \brief Performs cleanup tasks for the ResourceManager.
      *
-     * Frees all loaded resources and prepares the resource manager for shutdown.
+     * Frees all loaded resources, unmaps the asset pack and prepares the resource manager for shutdown. Nothing may be
+     * playing the sounds, and no other thread may be using the manager.
      */
     int ShutDown();
 };
@@ -0,0 +1,101 @@
+#pragma once
+#include "Component.h"
+#include "PhysicsWorld.h"
+
+/*!
+ * \struct RigidBodyComponent
+ * \brief The RigidBodyComponent gives an entity a body in a PhysicsWorld.
+ *
+ * The component only holds a handle; velocity, gravity scale and grounded state live in the world's arrays so that
+ * all bodies are integrated together. The world must outlive the component.
+ */
+struct RigidBodyComponent : public Component
+{
+public:
+    /*!
+     * \brief Creates a body for the entity.
+     * \param world The physics world the body lives in.
+     * \param box The initial box of the body.
+     * \param gravityScale Multiplier applied to the world gravity.
+     */
+    RigidBodyComponent(PhysicsWorld &world, const SDL_FRect &box, float gravityScale = 1.0f)
+        : mWorld(world), mHandle(world.CreateBody(box, gravityScale))
+    {
+    }
+
+    /*!
+     * \brief Destroys the body.
+     */
+    virtual ~RigidBodyComponent()
+    {
+        mWorld.DestroyBody(mHandle);
+    }
+
+    /*!
+     * \brief Gets the body's box, as moved by the last physics step.
+     */
+    SDL_FRect GetBox() const
+    {
+        return mWorld.GetBox(mHandle);
+    }
+
+    /*!
+     * \brief Teleports the body.
+     */
+    void SetPosition(float x, float y)
+    {
+        mWorld.SetPosition(mHandle, x, y);
+    }
+
+    /*!
+     * \brief Gets the horizontal velocity.
+     */
+    float GetVelocityX() const
+    {
+        return mWorld.GetVelocityX(mHandle);
+    }
+
+    /*!
+     * \brief Gets the vertical velocity; positive is downward.
+     */
+    float GetVelocityY() const
+    {
+        return mWorld.GetVelocityY(mHandle);
+    }
+
+    /*!
+     * \brief Sets the velocity.
+     */
+    void SetVelocity(float vx, float vy)
+    {
+        mWorld.SetVelocity(mHandle, vx, vy);
+    }
+
+    /*!
+     * \brief Checks whether the body rests on the ground or a platform.
+     */
+    bool IsGrounded() const
+    {
+        return mWorld.IsGrounded(mHandle);
+    }
+
+    /*!
+     * \brief Sets the grounded state, e.g. to leave the ground when jumping.
+     */
+    void SetGrounded(bool grounded)
+    {
+        mWorld.SetGrounded(mHandle, grounded);
+    }
+
+    /*!
+     * \brief Gets the handle of the body in its world.
+     */
+    Uint32 GetHandle() const
+    {
+        return mHandle;
+    }
+
+private:
+    PhysicsWorld &mWorld;
+    Uint32 mHandle;
+};
@@ -1,4 +1,7 @@
 #pragma once
+#include <SDL2/SDL.h>
+#include "FramePacket.h"
+#include "SceneSnapshot.h"
 
 /*!
  * \class Scene
@@ -6,7 +9,9 @@
  *
  * This interface mandates the implementation of core methods essential for scene lifecycle management, including
  * initialization, input handling, updating, rendering, and cleanup. Additionally, it provides methods to check the
- * completion status of the scene and whether the player has won.
+ * completion status of the scene and whether the player has won, and the timestamp of the input consumed in the
+ * last HandleInput call so the main loop can measure input latency. Scenes can save their simulation state to a
+ * SceneSnapshot and restore it in place, which is how a level is restarted.
  */
 class Scene
 {
@@ -16,8 +21,12 @@ public:
     virtual void StartUp() = 0;
     virtual void HandleInput(float deltaTime) = 0;
     virtual void Update(float deltaTime) = 0;
-    virtual void Render() = 0;
+    virtual void Render(FramePacket &packet) = 0;
     virtual void Cleanup() = 0;
     virtual bool IsCompleted() const = 0;
     virtual bool IsWin() const = 0;
+    virtual Uint32 GetInputTimestamp() const = 0;
+    virtual void SaveSnapshot(SceneSnapshot &snapshot) const = 0;
+    virtual bool RestoreSnapshot(const SceneSnapshot &snapshot) = 0;
+    virtual void Restart() = 0;
 };
@@ -0,0 +1,510 @@
+#pragma once
+#include "CollisionSystem.h"
+#include "FramePacket.h"
+#include "PrototypeRegistry.h"
+#include "SceneSnapshot.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <vector>
+
+/*!
+ * \struct NodeTransform
+ * \brief A 2D transform of a scene graph node: a scale followed by a translation.
+ *
+ * There is no rotation, as sprites are drawn and collided as axis-aligned rectangles.
+ */
+struct NodeTransform
+{
+    float x{0.0f};
+    float y{0.0f};
+    float scaleX{1.0f};
+    float scaleY{1.0f};
+
+    /*!
+     * \brief Applies this transform on top of a parent's world transform.
+     */
+    NodeTransform Under(const NodeTransform &parent) const
+    {
+        return NodeTransform{parent.x + parent.scaleX * x, parent.y + parent.scaleY * y, parent.scaleX * scaleX, parent.scaleY * scaleY};
+    }
+};
+
+/*!
+ * \class SceneGraph
+ * \brief The SceneGraph moves groups of sprites together through a hierarchy of parent-relative transforms.
+ *
+ * Every node has a local transform relative to its parent and a world transform, and optionally a prototype from the
+ * PrototypeRegistry that it is drawn and collided as, scaled by its world transform; a node without one only groups its
+ * children. Moving a platform node moves the food placed on it, moving an enemy node moves its attached parts.
+ *
+ * Nodes are stored as parallel arrays in depth-first order, so every node comes after its parent and a subtree is one
+ * contiguous range. Update, Render and AddColliders are single linear passes. A changed node is flagged dirty and its
+ * ancestors are flagged as having dirty descendants; Update skips every clean subtree in one jump and recomputes only
+ * the dirty subtrees, each a linear run from parent to children. Node handles are stable; the position of a handle in
+ * the arrays changes when nodes are added, removed or reparented, which costs time linear in the number of nodes.
+ */
+class SceneGraph
+{
+public:
+    static constexpr Uint32 kNoNode = 0xFFFFFFFFu;
+    static constexpr Uint16 kNoPrototype = 0xFFFF; //!< The node is not drawn and has no collider.
+
+    /*!
+     * \brief Adds a node as the last child of a parent.
+     * \param parent The parent node, or kNoNode for a root.
+     * \param x The X position relative to the parent.
+     * \param y The Y position relative to the parent.
+     * \param prototype The prototype the node is drawn and collided as, or kNoPrototype.
+     * \return The handle of the node, or kNoNode if the parent does not exist.
+     */
+    Uint32 Add(Uint32 parent, float x, float y, Uint16 prototype = kNoPrototype)
+    {
+        if (parent != kNoNode && !IsAlive(parent))
+        {
+            return kNoNode;
+        }
+        Uint32 node;
+        if (!mFree.empty())
+        {
+            node = mFree.back();
+            mFree.pop_back();
+        }
+        else
+        {
+            node = static_cast<Uint32>(mPositions.size());
+            mPositions.push_back(kNoNode);
+        }
+
+        size_t at = parent == kNoNode ? mHandles.size() : mPositions[parent] + mSubtreeSizes[mPositions[parent]];
+        mHandles.insert(mHandles.begin() + at, node);
+        mParents.insert(mParents.begin() + at, parent);
+        mLocal.insert(mLocal.begin() + at, NodeTransform{x, y, 1.0f, 1.0f});
+        mWorld.insert(mWorld.begin() + at, NodeTransform{});
+        mFlags.insert(mFlags.begin() + at, Uint8{0});
+        mPrototypes.insert(mPrototypes.begin() + at, prototype);
+        Reindex();
+        MarkDirty(at);
+        return node;
+    }
+
+    /*!
+     * \brief Removes a node and its whole subtree. Their handles are reused by later nodes.
+     */
+    void Remove(Uint32 node)
+    {
+        if (!IsAlive(node))
+        {
+            return;
+        }
+        size_t first = mPositions[node];
+        size_t end = first + mSubtreeSizes[first];
+        for (size_t i = first; i < end; i++)
+        {
+            mPositions[mHandles[i]] = kNoNode;
+            mFree.push_back(mHandles[i]);
+        }
+        ForEachArray([first, end](auto &array)
+                     { array.erase(array.begin() + first, array.begin() + end); });
+        Reindex();
+    }
+
+    /*!
+     * \brief Moves a node and its subtree under another parent, keeping its local transform.
+     * \param node The node to move.
+     * \param parent The new parent, or kNoNode to make the node a root.
+     * \return False if either node does not exist or the parent is in the node's own subtree.
+     */
+    bool SetParent(Uint32 node, Uint32 parent)
+    {
+        if (!IsAlive(node) || (parent != kNoNode && !IsAlive(parent)))
+        {
+            return false;
+        }
+        size_t first = mPositions[node];
+        size_t count = mSubtreeSizes[first];
+        size_t end = parent == kNoNode ? mHandles.size() : mPositions[parent] + mSubtreeSizes[mPositions[parent]];
+        if (parent != kNoNode && mPositions[parent] >= first && mPositions[parent] < first + count)
+        {
+            return false;
+        }
+
+        // Where the subtree goes once it is taken out: after the new parent's last descendant
+        size_t target = first < end ? end - count : end;
+        ForEachArray([first, count, target](auto &array)
+                     {
+            if (target >= first)
+            {
+                std::rotate(array.begin() + first, array.begin() + first + count, array.begin() + target + count);
+            }
+            else
+            {
+                std::rotate(array.begin() + target, array.begin() + first, array.begin() + first + count);
+            } });
+        mParents[target] = parent;
+        Reindex();
+        MarkDirty(target);
+        return true;
+    }
+
+    /*!
+     * \brief Checks whether a handle refers to a node.
+     */
+    bool IsAlive(Uint32 node) const
+    {
+        return node < mPositions.size() && mPositions[node] != kNoNode;
+    }
+
+    /*!
+     * \brief Gets the parent of a node, or kNoNode for a root.
+     */
+    Uint32 GetParent(Uint32 node) const
+    {
+        return mParents[mPositions[node]];
+    }
+
+    /*!
+     * \brief Sets a node's position relative to its parent.
+     */
+    void SetPosition(Uint32 node, float x, float y)
+    {
+        size_t i = mPositions[node];
+        mLocal[i].x = x;
+        mLocal[i].y = y;
+        MarkDirty(i);
+    }
+
+    /*!
+     * \brief Moves a node, and with it its subtree, relative to its current position.
+     */
+    void Translate(Uint32 node, float dx, float dy)
+    {
+        size_t i = mPositions[node];
+        mLocal[i].x += dx;
+        mLocal[i].y += dy;
+        MarkDirty(i);
+    }
+
+    /*!
+     * \brief Sets a node's scale, which also scales the positions and sizes of its subtree.
+     */
+    void SetScale(Uint32 node, float scaleX, float scaleY)
+    {
+        size_t i = mPositions[node];
+        mLocal[i].scaleX = scaleX;
+        mLocal[i].scaleY = scaleY;
+        MarkDirty(i);
+    }
+
+    /*!
+     * \brief Shows or hides a node and its subtree. Hidden nodes are neither drawn nor collided.
+     */
+    void SetVisible(Uint32 node, bool visible)
+    {
+        size_t i = mPositions[node];
+        mFlags[i] = visible ? mFlags[i] & ~kHidden : mFlags[i] | kHidden;
+        MarkDirty(i);
+    }
+
+    /*!
+     * \brief Gets a node's transform relative to its parent.
+     */
+    const NodeTransform &GetLocal(Uint32 node) const
+    {
+        return mLocal[mPositions[node]];
+    }
+
+    /*!
+     * \brief Gets a node's world transform as of the last Update.
+     */
+    const NodeTransform &GetWorld(Uint32 node) const
+    {
+        return mWorld[mPositions[node]];
+    }
+
+    /*!
+     * \brief Gets the world rectangle a node is drawn in as of the last Update; empty for nodes without a prototype.
+     */
+    SDL_FRect GetRectangle(Uint32 node) const
+    {
+        size_t i = mPositions[node];
+        if (mPrototypes[i] == kNoPrototype)
+        {
+            return SDL_FRect{mWorld[i].x, mWorld[i].y, 0.0f, 0.0f};
+        }
+        const SpritePrototype &prototype = PrototypeRegistry::GetInstance().Get(mPrototypes[i]);
+        return SDL_FRect{mWorld[i].x, mWorld[i].y, prototype.width * mWorld[i].scaleX, prototype.height * mWorld[i].scaleY};
+    }
+
+    /*!
+     * \brief Gets the number of nodes.
+     */
+    size_t Size() const
+    {
+        return mHandles.size();
+    }
+
+    /*!
+     * \brief Gets the number of world transforms the last Update recomputed.
+     */
+    size_t GetUpdatedCount() const
+    {
+        return mUpdated;
+    }
+
+    /*!
+     * \brief Recomputes the world transforms of dirty nodes and their subtrees.
+     */
+    void Update()
+    {
+        mUpdated = 0;
+        if (!mAnyDirty)
+        {
+            return;
+        }
+        size_t count = mHandles.size();
+        size_t i = 0;
+        while (i < count)
+        {
+            if (mFlags[i] & kDirty)
+            {
+                // Parents precede their children, so each parent's world transform is ready when its children need it
+                size_t end = i + mSubtreeSizes[i];
+                for (size_t j = i; j < end; j++)
+                {
+                    Uint32 parent = mParentPositions[j];
+                    bool parentHidden = parent != kNoNode && (mFlags[parent] & kWorldHidden);
+                    mWorld[j] = parent == kNoNode ? mLocal[j] : mLocal[j].Under(mWorld[parent]);
+                    Uint8 flags = mFlags[j] & kHidden;
+                    mFlags[j] = (parentHidden || flags) ? flags | kWorldHidden : flags;
+                }
+                mUpdated += end - i;
+                i = end;
+            }
+            else if (mFlags[i] & kDirtyBelow)
+            {
+                mFlags[i] &= ~kDirtyBelow;
+                i++;
+            }
+            else
+            {
+                i += mSubtreeSizes[i];
+            }
+        }
+        mAnyDirty = false;
+    }
+
+    /*!
+     * \brief Records a draw for every visible node with a prototype, parents before children.
+     * \param packet The frame packet to record into.
+     */
+    void Render(FramePacket &packet) const
+    {
+        const PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+        for (size_t i = 0; i < mHandles.size(); i++)
+        {
+            if (mPrototypes[i] == kNoPrototype || (mFlags[i] & kWorldHidden))
+            {
+                continue;
+            }
+            const SpritePrototype &prototype = registry.Get(mPrototypes[i]);
+            if (prototype.texture != nullptr)
+            {
+                const NodeTransform &world = mWorld[i];
+                packet.DrawSprite(prototype.texture, SDL_FRect{world.x, world.y, prototype.width * world.scaleX, prototype.height * world.scaleY});
+            }
+        }
+    }
+
+    /*!
+     * \brief Submits a collider for every visible node whose prototype has a collision layer.
+     * \param collisions The collision system to submit to.
+     * \param group The group part of the collider ids; the index part is the node handle.
+     */
+    void AddColliders(CollisionSystem &collisions, Uint32 group) const
+    {
+        const PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+        for (size_t i = 0; i < mHandles.size(); i++)
+        {
+            if (mPrototypes[i] == kNoPrototype || (mFlags[i] & kWorldHidden))
+            {
+                continue;
+            }
+            const SpritePrototype &prototype = registry.Get(mPrototypes[i]);
+            if (prototype.collisionLayer == COLLISION_LAYER_NONE)
+            {
+                continue;
+            }
+            const NodeTransform &world = mWorld[i];
+            const SDL_FRect &box = prototype.collisionBox;
+            collisions.AddCollider(SDL_FRect{world.x + box.x * world.scaleX, world.y + box.y * world.scaleY, box.w * world.scaleX, box.h * world.scaleY},
+                                   prototype.collisionLayer, prototype.collisionMask, CollisionSystem::MakeId(group, mHandles[i]));
+        }
+    }
+
+    /*!
+     * \brief Removes every node.
+     */
+    void Clear()
+    {
+        ForEachArray([](auto &array)
+                     { array.clear(); });
+        mPositions.clear();
+        mFree.clear();
+        Reindex();
+    }
+
+    /*!
+     * \brief Appends every node to a snapshot.
+     */
+    void Save(SceneSnapshot &snapshot) const
+    {
+        snapshot.WriteArray(mHandles);
+        snapshot.WriteArray(mParents);
+        snapshot.WriteArray(mLocal);
+        snapshot.WriteArray(mWorld);
+        snapshot.WriteArray(mFlags);
+        snapshot.WriteArray(mPrototypes);
+        snapshot.WriteArray(mFree);
+    }
+
+    /*!
+     * \brief Restores the nodes saved by Save; every handle refers to the same node again.
+     * \return False if the snapshot is malformed.
+     */
+    bool Restore(SnapshotReader &reader)
+    {
+        bool ok = reader.ReadArray(mHandles) && reader.ReadArray(mParents) && reader.ReadArray(mLocal) && reader.ReadArray(mWorld) &&
+                  reader.ReadArray(mFlags) && reader.ReadArray(mPrototypes) && reader.ReadArray(mFree);
+        size_t count = mHandles.size();
+        ok = ok && mParents.size() == count && mLocal.size() == count && mWorld.size() == count && mFlags.size() == count &&
+             mPrototypes.size() == count;
+        if (!ok)
+        {
+            Clear();
+            return false;
+        }
+        mPositions.assign(count + mFree.size(), kNoNode);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (mHandles[i] >= mPositions.size() || mPositions[mHandles[i]] != kNoNode)
+            {
+                Clear();
+                return false;
+            }
+            mPositions[mHandles[i]] = static_cast<Uint32>(i);
+        }
+        std::vector<Uint8> freed(mPositions.size(), 0);
+        for (Uint32 node : mFree)
+        {
+            if (node >= mPositions.size() || mPositions[node] != kNoNode || freed[node])
+            {
+                Clear();
+                return false;
+            }
+            freed[node] = 1;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            if (mParents[i] != kNoNode && (mParents[i] >= mPositions.size() || mPositions[mParents[i]] >= i))
+            {
+                Clear();
+                return false;
+            }
+        }
+        Reindex();
+        mAnyDirty = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            // Every subtree must be one contiguous range right after its root
+            Uint32 parent = mParentPositions[i];
+            if (parent != kNoNode && i >= parent + mSubtreeSizes[parent])
+            {
+                Clear();
+                return false;
+            }
+            mAnyDirty = mAnyDirty || (mFlags[i] & (kDirty | kDirtyBelow)) != 0;
+        }
+        return true;
+    }
+
+private:
+    enum : Uint8
+    {
+        kDirty = 1 << 0,       //!< The local transform or visibility changed; the whole subtree is recomputed.
+        kDirtyBelow = 1 << 1,  //!< A descendant is dirty.
+        kHidden = 1 << 2,      //!< Hidden by SetVisible.
+        kWorldHidden = 1 << 3  //!< Hidden itself or through an ancestor, as of the last Update.
+    };
+
+    /*!
+     * \brief Calls a function on every array ordered by position, except the derived ones rebuilt by Reindex.
+     */
+    template <typename Function>
+    void ForEachArray(Function function)
+    {
+        function(mHandles);
+        function(mParents);
+        function(mLocal);
+        function(mWorld);
+        function(mFlags);
+        function(mPrototypes);
+    }
+
+    /*!
+     * \brief Rebuilds the positions of the handles, the positions of the parents and the subtree sizes after the order
+     * changed.
+     */
+    void Reindex()
+    {
+        size_t count = mHandles.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            mPositions[mHandles[i]] = static_cast<Uint32>(i);
+        }
+        mParentPositions.resize(count);
+        mSubtreeSizes.assign(count, 1);
+        for (size_t i = 0; i < count; i++)
+        {
+            mParentPositions[i] = mParents[i] == kNoNode ? kNoNode : mPositions[mParents[i]];
+        }
+        for (size_t i = count; i-- > 0;)
+        {
+            if (mParentPositions[i] != kNoNode)
+            {
+                mSubtreeSizes[mParentPositions[i]] += mSubtreeSizes[i];
+            }
+        }
+    }
+
+    /*!
+     * \brief Flags a node dirty and its ancestors as having a dirty descendant, stopping at the first that already knows.
+     */
+    void MarkDirty(size_t i)
+    {
+        mFlags[i] |= kDirty;
+        mAnyDirty = true;
+        for (Uint32 parent = mParentPositions[i]; parent != kNoNode; parent = mParentPositions[parent])
+        {
+            if (mFlags[parent] & (kDirty | kDirtyBelow))
+            {
+                break;
+            }
+            mFlags[parent] |= kDirtyBelow;
+        }
+    }
+
+    // Ordered by position, depth-first
+    std::vector<Uint32> mHandles;
+    std::vector<Uint32> mParents; //!< Handles of the parents.
+    std::vector<NodeTransform> mLocal;
+    std::vector<NodeTransform> mWorld;
+    std::vector<Uint8> mFlags;
+    std::vector<Uint16> mPrototypes;
+    std::vector<Uint32> mParentPositions;
+    std::vector<Uint32> mSubtreeSizes;
+
+    std::vector<Uint32> mPositions; //!< Position of every handle, or kNoNode if it is free.
+    std::vector<Uint32> mFree;
+    bool mAnyDirty{false};
+    size_t mUpdated{0};
+};
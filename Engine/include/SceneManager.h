@@ -66,14 +66,26 @@ public:
 
     /*!
      * \brief Renders the current scene.
+     * \param packet The frame packet the scene records its draws into.
      */
-    void Render()
+    void Render(FramePacket &packet)
     {
         if (currentScene)
         {
-            currentScene->Render();
+            currentScene->Render(packet);
         }
     }
+    /*!
+     * \brief Restarts the current level from its initial state.
+     */
+    void RestartLevel()
+    {
+        if (currentScene)
+        {
+            currentScene->Restart();
+        }
+    }
+
     /*!
      * \brief Returns a pointer to the current scene.
      * \return A pointer to the current scene.
@@ -93,14 +105,33 @@ public:
     void LoadNextLevel(SDL_Renderer *renderer, SDL_Window *window)
     {
         currentLevelIndex++;
-        switch (currentLevelIndex)
+        std::unique_ptr<BaseScene> level = CreateLevel(currentLevelIndex, renderer, window);
+        if (level)
+        {
+            SwitchScene(std::move(level));
+        }
+    }
+
+    static constexpr int kLevelCount = 3; //!< Number of levels CreateLevel knows.
+
+    /*!
+     * \brief Creates the scene of a level, without initializing it.
+     * \param levelIndex The zero-based level index.
+     * \param renderer The SDL renderer used for scene rendering, or nullptr for a headless scene.
+     * \param window The SDL window where the scene is rendered, or nullptr for a headless scene.
+     * \return The new scene, or nullptr if there is no such level.
+     */
+    static std::unique_ptr<BaseScene> CreateLevel(int levelIndex, SDL_Renderer *renderer, SDL_Window *window)
+    {
+        switch (levelIndex)
         {
+        case 0:
+            return std::make_unique<Level1Scene>(renderer, window);
         case 1:
-            SwitchScene(std::make_unique<Level2Scene>(renderer, window));
-            break;
+            return std::make_unique<Level2Scene>(renderer, window);
         case 2:
-            SwitchScene(std::make_unique<Level3Scene>(renderer, window));
-            break;
+            return std::make_unique<Level3Scene>(renderer, window);
         }
+        return nullptr;
     }
 };
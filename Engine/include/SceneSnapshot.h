@@ -0,0 +1,164 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/*!
+ * \class SceneSnapshot
+ * \brief The SceneSnapshot class is a flat byte buffer holding the complete simulation state of a scene.
+ *
+ * Values are appended in a fixed order by the scene and read back in the same order by a SnapshotReader. Only
+ * trivially copyable values are stored, so saving and restoring are plain memory copies. The buffer keeps its capacity
+ * when it is cleared, so taking a snapshot every tick (for rollback or rewind) does not allocate.
+ */
+class SceneSnapshot
+{
+public:
+    static constexpr Uint32 kMagic = 0x50414E53; // "SNAP"
+    static constexpr Uint32 kVersion = 7;
+
+    /*!
+     * \brief Empties the snapshot, keeping the allocated storage.
+     */
+    void Clear()
+    {
+        mData.clear();
+    }
+
+    /*!
+     * \brief Gets the size of the snapshot in bytes.
+     */
+    size_t Size() const
+    {
+        return mData.size();
+    }
+
+    /*!
+     * \brief Gets the raw bytes of the snapshot.
+     */
+    const Uint8 *Data() const
+    {
+        return mData.data();
+    }
+
+    /*!
+     * \brief Replaces the snapshot with raw bytes, e.g. ones saved earlier with Data and Size.
+     */
+    void Assign(const Uint8 *data, size_t size)
+    {
+        mData.assign(data, data + size);
+    }
+
+    /*!
+     * \brief Appends a single value.
+     */
+    template <typename T>
+    void Write(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        size_t offset = mData.size();
+        mData.resize(offset + sizeof(T));
+        std::memcpy(mData.data() + offset, &value, sizeof(T));
+    }
+
+    /*!
+     * \brief Appends an array, preceded by its element count.
+     */
+    template <typename T>
+    void WriteArray(const std::vector<T> &values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        Write(static_cast<Uint64>(values.size()));
+        size_t offset = mData.size();
+        mData.resize(offset + values.size() * sizeof(T));
+        if (!values.empty())
+        {
+            std::memcpy(mData.data() + offset, values.data(), values.size() * sizeof(T));
+        }
+    }
+
+private:
+    std::vector<Uint8> mData;
+};
+
+/*!
+ * \class SnapshotReader
+ * \brief Reads values back from a SceneSnapshot, in the order they were written.
+ *
+ * Every read checks the remaining size; once a read fails, all following reads fail too.
+ */
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const SceneSnapshot &snapshot) : mData(snapshot.Data()), mSize(snapshot.Size()) {}
+
+    /*!
+     * \brief Reads a single value.
+     * \return False if the snapshot is too short.
+     */
+    template <typename T>
+    bool Read(T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        if (!mOk || mSize - mPos < sizeof(T))
+        {
+            mOk = false;
+            return false;
+        }
+        std::memcpy(&value, mData + mPos, sizeof(T));
+        mPos += sizeof(T);
+        return true;
+    }
+
+    /*!
+     * \brief Reads the number of elements of the next array without consuming it.
+     * \return False if the snapshot is too short for the array.
+     */
+    template <typename T>
+    bool PeekArraySize(Uint64 &count) const
+    {
+        if (!mOk || mSize - mPos < sizeof(Uint64))
+        {
+            return false;
+        }
+        std::memcpy(&count, mData + mPos, sizeof(Uint64));
+        return (mSize - mPos - sizeof(Uint64)) / sizeof(T) >= count;
+    }
+
+    /*!
+     * \brief Reads an array written with WriteArray, resizing the destination to match.
+     * \return False if the snapshot is too short.
+     */
+    template <typename T>
+    bool ReadArray(std::vector<T> &values)
+    {
+        Uint64 count = 0;
+        if (!Read(count) || (mSize - mPos) / sizeof(T) < count)
+        {
+            mOk = false;
+            return false;
+        }
+        values.resize(static_cast<size_t>(count));
+        if (count > 0)
+        {
+            std::memcpy(values.data(), mData + mPos, static_cast<size_t>(count) * sizeof(T));
+        }
+        mPos += static_cast<size_t>(count) * sizeof(T);
+        return true;
+    }
+
+    /*!
+     * \brief Checks whether every read so far succeeded.
+     */
+    bool IsOk() const
+    {
+        return mOk;
+    }
+
+private:
+    const Uint8 *mData;
+    size_t mSize;
+    size_t mPos{0};
+    bool mOk{true};
+};
@@ -0,0 +1,577 @@
+#pragma once
+#include "Logger.h"
+#include "TimerWheel.h"
+#include <SDL2/SDL.h>
+#include <coroutine>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ScriptScheduler;
+
+/*!
+ * \class ScriptFramePool
+ * \brief Hands out coroutine frames from free lists of fixed-size blocks, so spawning a script does not call malloc.
+ *
+ * Frames are rounded up to a multiple of kGranularity and served from one free list per size; the lists are refilled a
+ * chunk of blocks at a time and never shrink. Frames larger than kMaxPooledSize fall back to the global heap. Not
+ * thread safe: each ScriptScheduler owns a pool and only runs on its scene's thread.
+ */
+class ScriptFramePool
+{
+public:
+    static constexpr size_t kGranularity = 64;
+    static constexpr size_t kMaxPooledSize = 1024;
+    static constexpr size_t kBlocksPerChunk = 64;
+
+    ScriptFramePool() = default;
+    ScriptFramePool(const ScriptFramePool &) = delete;
+    ScriptFramePool &operator=(const ScriptFramePool &) = delete;
+
+    ~ScriptFramePool()
+    {
+        for (void *chunk : mChunks)
+        {
+            std::free(chunk);
+        }
+    }
+
+    /*!
+     * \brief Allocates a block of at least size bytes, aligned like operator new.
+     */
+    void *Allocate(size_t size)
+    {
+        if (size > kMaxPooledSize)
+        {
+            return AllocateBytes(size);
+        }
+        size_t sizeClass = (size + kGranularity - 1) / kGranularity - 1;
+        FreeBlock *&head = mFree[sizeClass];
+        if (head == nullptr)
+        {
+            size_t blockSize = (sizeClass + 1) * kGranularity;
+            char *chunk = static_cast<char *>(AllocateBytes(blockSize * kBlocksPerChunk));
+            mChunks.push_back(chunk);
+            for (size_t i = kBlocksPerChunk; i-- > 0;)
+            {
+                FreeBlock *block = reinterpret_cast<FreeBlock *>(chunk + i * blockSize);
+                block->next = head;
+                head = block;
+            }
+            mReservedBytes += blockSize * kBlocksPerChunk;
+        }
+        FreeBlock *block = head;
+        head = block->next;
+        return block;
+    }
+
+    /*!
+     * \brief Returns a block to its free list.
+     * \param block The block, from Allocate.
+     * \param size The size passed to Allocate.
+     */
+    void Free(void *block, size_t size)
+    {
+        if (size > kMaxPooledSize)
+        {
+            std::free(block);
+            return;
+        }
+        size_t sizeClass = (size + kGranularity - 1) / kGranularity - 1;
+        FreeBlock *freed = static_cast<FreeBlock *>(block);
+        freed->next = mFree[sizeClass];
+        mFree[sizeClass] = freed;
+    }
+
+    /*!
+     * \brief Gets the bytes held in chunks, used or free.
+     */
+    size_t GetReservedBytes() const
+    {
+        return mReservedBytes;
+    }
+
+    /*!
+     * \brief Allocates from the heap with malloc, so blocks can be released with std::free whatever their origin.
+     */
+    static void *AllocateBytes(size_t size)
+    {
+        void *block = std::malloc(size);
+        if (block == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return block;
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    FreeBlock *mFree[kMaxPooledSize / kGranularity]{};
+    std::vector<void *> mChunks;
+    size_t mReservedBytes{0};
+};
+
+/*!
+ * \struct ScriptHandle
+ * \brief Names a spawned script. Stays safe to use after the script finished or was cancelled.
+ */
+struct ScriptHandle
+{
+    Uint32 slot{0xFFFFFFFFu};
+    Uint32 generation{0};
+};
+
+/*!
+ * \class ScriptTask
+ * \brief The return type of a script coroutine. Hand it to ScriptScheduler::Spawn to start it.
+ *
+ * A script is any function returning ScriptTask that uses co_await. It must take the ScriptScheduler that will run it
+ * as its first parameter, or its second for member functions and lambdas, and its frame is allocated from that
+ * scheduler's pool. A task that is never spawned is destroyed with the ScriptTask.
+ */
+class ScriptTask
+{
+public:
+    struct promise_type
+    {
+        ScriptScheduler *scheduler{nullptr};
+        Uint32 slot{0};
+
+        ScriptTask get_return_object()
+        {
+            return ScriptTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void()
+        {
+        }
+        void unhandled_exception()
+        {
+            LOG_ERROR("Unhandled exception in a script");
+            std::terminate();
+        }
+
+        template <typename... Args>
+        static void *operator new(size_t size, ScriptScheduler &scheduler, Args &...);
+        template <typename Self, typename... Args>
+        static void *operator new(size_t size, Self &, ScriptScheduler &scheduler, Args &...);
+        static void operator delete(void *frame, size_t size);
+
+    private:
+        static void *AllocateFrame(ScriptFramePool *pool, size_t size);
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    ScriptTask(ScriptTask &&other) noexcept : mHandle(std::exchange(other.mHandle, nullptr)) {}
+    ScriptTask(const ScriptTask &) = delete;
+    ScriptTask &operator=(const ScriptTask &) = delete;
+
+    ~ScriptTask()
+    {
+        if (mHandle)
+        {
+            mHandle.destroy();
+        }
+    }
+
+    /*!
+     * \brief Gives up ownership of the coroutine, to the scheduler.
+     */
+    Handle Release()
+    {
+        return std::exchange(mHandle, nullptr);
+    }
+
+private:
+    explicit ScriptTask(Handle handle) : mHandle(handle) {}
+
+    Handle mHandle;
+};
+
+/*!
+ * \class ScriptScheduler
+ * \brief The ScriptScheduler runs script coroutines that wait for the next tick, a number of ticks or an event.
+ *
+ * Suspended scripts are not polled. A script waiting for ticks is a timer of a TimerWheel, and a script waiting for an
+ * event sits in that event's wait list; Update only visits the timers due on the tick and the scripts that Notify
+ * woke, so a tick costs as much as the scripts it wakes. Scripts live in a slot table with a generation per slot, so
+ * cancelling a script destroys its frame at once and leaves any timer or wait list entry to be skipped when reached.
+ *
+ * Scripts run on the thread calling Update and are not part of scene snapshots; a scene that restores a snapshot
+ * cancels its scripts and starts them again.
+ */
+class ScriptScheduler
+{
+public:
+    /*!
+     * \brief Awaitable that resumes a script after a number of ticks.
+     */
+    struct TicksAwaiter
+    {
+        Uint32 ticks;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(ScriptTask::Handle handle)
+        {
+            handle.promise().scheduler->WaitTicks(handle.promise().slot, ticks);
+        }
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    /*!
+     * \brief Awaitable that resumes a script at the start of the tick after an event was notified. co_await returns
+     * the value passed to Notify.
+     */
+    struct EventAwaiter
+    {
+        Uint32 key;
+        ScriptScheduler *scheduler{nullptr};
+        Uint32 slot{0};
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(ScriptTask::Handle handle)
+        {
+            scheduler = handle.promise().scheduler;
+            slot = handle.promise().slot;
+            scheduler->WaitEvent(slot, key);
+        }
+        Uint32 await_resume() const noexcept
+        {
+            return scheduler->mSlots[slot].eventValue;
+        }
+    };
+
+    /*!
+     * \brief Waits until the next tick.
+     */
+    static TicksAwaiter NextTick()
+    {
+        return TicksAwaiter{1};
+    }
+
+    /*!
+     * \brief Waits a number of ticks; zero waits until the next tick.
+     */
+    static TicksAwaiter Ticks(Uint32 ticks)
+    {
+        return TicksAwaiter{ticks};
+    }
+
+    /*!
+     * \brief Waits until Notify is called with a key, e.g. the collider id of a scripted entity.
+     */
+    static EventAwaiter Event(Uint32 key)
+    {
+        return EventAwaiter{key};
+    }
+
+    ScriptScheduler() = default;
+    ScriptScheduler(const ScriptScheduler &) = delete;
+    ScriptScheduler &operator=(const ScriptScheduler &) = delete;
+
+    ~ScriptScheduler()
+    {
+        CancelAll();
+    }
+
+    /*!
+     * \brief Starts a script. It runs right away until its first co_await.
+     * \param task The script.
+     * \return A handle for Cancel and IsRunning.
+     */
+    ScriptHandle Spawn(ScriptTask task)
+    {
+        ScriptTask::Handle handle = task.Release();
+        if (!handle)
+        {
+            return ScriptHandle{};
+        }
+        Uint32 slot;
+        if (!mFreeSlots.empty())
+        {
+            slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        }
+        else
+        {
+            slot = static_cast<Uint32>(mSlots.size());
+            mSlots.emplace_back();
+        }
+        mSlots[slot].handle = handle;
+        handle.promise().scheduler = this;
+        handle.promise().slot = slot;
+        mLiveCount++;
+
+        ScriptHandle result{slot, mSlots[slot].generation};
+        Run(slot);
+        return result;
+    }
+
+    /*!
+     * \brief Stops a script and destroys its frame. A script cancelling itself is stopped at its next co_await.
+     */
+    void Cancel(ScriptHandle script)
+    {
+        if (!IsRunning(script))
+        {
+            return;
+        }
+        if (mSlots[script.slot].running)
+        {
+            mSlots[script.slot].cancelled = true;
+            return;
+        }
+        Release(script.slot);
+    }
+
+    /*!
+     * \brief Stops every script.
+     */
+    void CancelAll()
+    {
+        for (Uint32 slot = 0; slot < mSlots.size(); slot++)
+        {
+            if (mSlots[slot].handle)
+            {
+                if (mSlots[slot].running)
+                {
+                    mSlots[slot].cancelled = true;
+                }
+                else
+                {
+                    Release(slot);
+                }
+            }
+        }
+        mTimers.Clear();
+        mEvents.clear();
+        mReady.clear();
+    }
+
+    /*!
+     * \brief Checks whether a script has neither finished nor been cancelled.
+     */
+    bool IsRunning(ScriptHandle script) const
+    {
+        return script.slot < mSlots.size() && mSlots[script.slot].generation == script.generation && mSlots[script.slot].handle;
+    }
+
+    /*!
+     * \brief Wakes every script waiting for an event. They resume at the start of the next Update, not from inside
+     * this call, so notifying from a collision handler never runs script code in the middle of the handler.
+     * \param key The event key.
+     * \param value The value co_await returns to the woken scripts.
+     */
+    void Notify(Uint32 key, Uint32 value = 0)
+    {
+        if (mEvents.empty())
+        {
+            return;
+        }
+        auto it = mEvents.find(key);
+        if (it == mEvents.end())
+        {
+            return;
+        }
+        for (const Entry &entry : it->second)
+        {
+            if (IsCurrent(entry))
+            {
+                mSlots[entry.slot].eventValue = value;
+                mReady.push_back(entry);
+            }
+        }
+        mEvents.erase(it);
+    }
+
+    /*!
+     * \brief Advances one tick: resumes the scripts woken by events, then those whose wait ends on this tick.
+     */
+    void Update()
+    {
+        mResumedLastTick = 0;
+        mReadyScratch.swap(mReady);
+        for (const Entry &entry : mReadyScratch)
+        {
+            Resume(entry);
+        }
+        mReadyScratch.clear();
+        mTimers.Advance();
+    }
+
+    /*!
+     * \brief Gets the number of ticks run.
+     */
+    Uint64 GetTick() const
+    {
+        return mTimers.GetTick();
+    }
+
+    /*!
+     * \brief Gets the number of scripts that have not finished.
+     */
+    size_t GetLiveCount() const
+    {
+        return mLiveCount;
+    }
+
+    /*!
+     * \brief Gets the number of scripts resumed by the last Update.
+     */
+    size_t GetResumedLastTick() const
+    {
+        return mResumedLastTick;
+    }
+
+    /*!
+     * \brief Gets the frame pool, for its statistics.
+     */
+    const ScriptFramePool &GetPool() const
+    {
+        return mPool;
+    }
+
+private:
+    friend struct ScriptTask::promise_type;
+
+    struct Slot
+    {
+        ScriptTask::Handle handle{};
+        Uint32 generation{0};
+        Uint32 eventValue{0};
+        bool running{false};
+        bool cancelled{false};
+    };
+
+    struct Entry
+    {
+        Uint32 slot;
+        Uint32 generation;
+    };
+
+    bool IsCurrent(const Entry &entry) const
+    {
+        return mSlots[entry.slot].generation == entry.generation && mSlots[entry.slot].handle;
+    }
+
+    void WaitTicks(Uint32 slot, Uint32 ticks)
+    {
+        // Small enough for std::function to store without allocating
+        Entry entry{slot, mSlots[slot].generation};
+        mTimers.Schedule(ticks, [this, entry]()
+                         { Resume(entry); });
+    }
+
+    void WaitEvent(Uint32 slot, Uint32 key)
+    {
+        mEvents[key].push_back(Entry{slot, mSlots[slot].generation});
+    }
+
+    void Resume(const Entry &entry)
+    {
+        if (IsCurrent(entry))
+        {
+            mResumedLastTick++;
+            Run(entry.slot);
+        }
+    }
+
+    /*!
+     * \brief Resumes a script until its next co_await, and frees it if it finished or cancelled itself.
+     */
+    void Run(Uint32 slot)
+    {
+        ScriptTask::Handle handle = mSlots[slot].handle;
+        mSlots[slot].running = true;
+        handle.resume();
+        // The slot table may have grown while the script ran
+        mSlots[slot].running = false;
+        if (handle.done() || mSlots[slot].cancelled)
+        {
+            Release(slot);
+        }
+    }
+
+    void Release(Uint32 slot)
+    {
+        Slot &entry = mSlots[slot];
+        ScriptTask::Handle handle = entry.handle;
+        entry.handle = nullptr;
+        entry.generation++;
+        entry.cancelled = false;
+        mFreeSlots.push_back(slot);
+        mLiveCount--;
+        handle.destroy();
+    }
+
+    // Declared first so it outlives every frame
+    ScriptFramePool mPool;
+    std::vector<Slot> mSlots;
+    std::vector<Uint32> mFreeSlots;
+    TimerWheel mTimers;
+    std::unordered_map<Uint32, std::vector<Entry>> mEvents;
+    std::vector<Entry> mReady;
+    std::vector<Entry> mReadyScratch;
+    size_t mLiveCount{0};
+    size_t mResumedLastTick{0};
+};
+
+/*!
+ * \brief Frames start with a header naming the pool they came from, so operator delete can find it.
+ */
+struct ScriptFrameHeader
+{
+    alignas(std::max_align_t) ScriptFramePool *pool;
+};
+
+inline void *ScriptTask::promise_type::AllocateFrame(ScriptFramePool *pool, size_t size)
+{
+    size_t total = size + sizeof(ScriptFrameHeader);
+    void *block = pool->Allocate(total);
+    ScriptFrameHeader *header = static_cast<ScriptFrameHeader *>(block);
+    header->pool = pool;
+    return header + 1;
+}
+
+template <typename... Args>
+void *ScriptTask::promise_type::operator new(size_t size, ScriptScheduler &scheduler, Args &...)
+{
+    return AllocateFrame(&scheduler.mPool, size);
+}
+
+template <typename Self, typename... Args>
+void *ScriptTask::promise_type::operator new(size_t size, Self &, ScriptScheduler &scheduler, Args &...)
+{
+    return AllocateFrame(&scheduler.mPool, size);
+}
+
+inline void ScriptTask::promise_type::operator delete(void *frame, size_t size)
+{
+    ScriptFrameHeader *header = static_cast<ScriptFrameHeader *>(frame) - 1;
+    size_t total = size + sizeof(ScriptFrameHeader);
+    header->pool->Free(header, total);
+}
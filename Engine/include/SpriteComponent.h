@@ -1,11 +1,14 @@
 #pragma once
+#include "AnimationSystem.h"
 #include "Component.h"
+#include "Logger.h"
 
 /*!
  * \struct SpriteComponent
  * \brief The SpriteComponent is responsible for rendering sprites on the screen.
  *
- * Inherits from Component and manages a texture for the sprite, including its position, size, and rendering.
+ * Inherits from Component and manages a texture for the sprite, including its position, size, and rendering. A sprite
+ * attached to an AnimationSystem draws the current frame of its clip instead of the whole texture.
  */
 struct SpriteComponent : public Component
 {
@@ -17,9 +20,9 @@ public:
      *
      * This constructor initializes the sprite component by loading the texture from the specified file path.
      */
-    SpriteComponent(SDL_Renderer *renderer, const char *filepath) : mRenderer(renderer)
+    SpriteComponent(SDL_Renderer *renderer, const char *filepath) : mRenderer(renderer), mFilepath(filepath)
     {
-        SDL_Log("Creating SpriteComponent with file: %s", filepath);
+        LOG_DEBUG("Creating SpriteComponent with file: %s", filepath);
         CreateSprite(filepath);
     }
 
@@ -28,6 +31,10 @@ public:
      */
     virtual ~SpriteComponent()
     {
+        if (mAnimations != nullptr)
+        {
+            mAnimations->DestroyPlayer(mAnimation);
+        }
     }
 
     /*!
@@ -45,23 +52,70 @@ public:
             manager.LoadResource(mRenderer, filepath);
         }
         mTexture = manager.GetResource(filepath);
-        if (mTexture == nullptr)
+        if (mTexture == nullptr && mRenderer != nullptr)
         {
-            SDL_Log("Failed to load texture for file: %s", filepath);
+            LOG_WARN("Failed to load texture for file: %s", filepath);
         }
     }
 
     /*!
      * \brief Renders the sprite on the screen.
-     * \param renderer The SDL renderer to use for rendering the sprite.
+     * \param packet The frame packet to record the draw into.
      *
-     * If the sprite's texture is loaded, this method renders the sprite at its current position and size.
+     * If the sprite's texture is loaded, this method records a draw of the sprite at its current position and size.
+     */
+    void Render(FramePacket &packet) override
+    {
+        if (mTexture == nullptr)
+        {
+            return;
+        }
+        if (mAnimations != nullptr)
+        {
+            packet.DrawSprite(mTexture, mAnimations->GetSource(mAnimation), mRectangle);
+        }
+        else
+        {
+            packet.DrawSprite(mTexture, mRectangle);
+        }
+    }
+
+    /*!
+     * \brief Attaches the sprite to an animation system and loads the clips of its texture.
+     * \param animations The animation system; must outlive the sprite.
+     * \return The number of clips defined for the texture.
+     *
+     * Until a clip is played, the sprite still draws the whole texture.
+     */
+    size_t Animate(AnimationSystem &animations)
+    {
+        if (mAnimations == nullptr)
+        {
+            mAnimations = &animations;
+            mAnimation = animations.CreatePlayer();
+        }
+        return animations.LoadClips(mFilepath);
+    }
+
+    /*!
+     * \brief Looks up a clip of the sprite's texture.
+     * \param name The clip name.
+     * \return The clip index, or AnimationSystem::kNoClip if the sprite is not animated or has no such clip.
+     */
+    Uint16 FindClip(const std::string &name) const
+    {
+        return mAnimations != nullptr ? mAnimations->FindClip(mFilepath, name) : AnimationSystem::kNoClip;
+    }
+
+    /*!
+     * \brief Plays a clip found with FindClip. Playing the clip that already plays does not restart it.
+     * \param clip The clip; AnimationSystem::kNoClip goes back to drawing the whole texture.
      */
-    void Render(SDL_Renderer *renderer) override
+    void PlayClip(Uint16 clip)
     {
-        if (mTexture != nullptr)
+        if (mAnimations != nullptr)
         {
-            SDL_RenderCopyF(renderer, mTexture, NULL, &mRectangle);
+            mAnimations->Play(mAnimation, clip);
         }
     }
 
@@ -167,4 +221,7 @@ private:
     SDL_FRect mRectangle{20.0f, 20.0f, 32.0f, 32.0f};
     SDL_Texture *mTexture;
     SDL_Renderer *mRenderer;
+    std::string mFilepath;
+    AnimationSystem *mAnimations{nullptr};
+    Uint32 mAnimation{0};
 };
@@ -0,0 +1,637 @@
+#pragma once
+#include "CollisionSystem.h"
+#include "FramePacket.h"
+#include "PhysicsWorld.h"
+#include "PrototypeRegistry.h"
+#include "SceneSnapshot.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief Activity state of a sprite instance.
+ */
+enum InstanceState : Uint8
+{
+    INSTANCE_STATIC = 0, //!< Never moves on its own; rendered and collided, never synced from physics.
+    INSTANCE_ACTIVE,     //!< Has an awake body that moved during the last physics step.
+    INSTANCE_SLEEPING,   //!< Has a body that came to rest; costs nothing until something wakes it.
+    INSTANCE_DEAD        //!< Gone; skipped by every loop and reused by the next spawn.
+};
+
+/*!
+ * \struct InstanceHandle
+ * \brief Names a sprite instance. Stays safe to use after the instance was killed and its slot reused.
+ */
+struct InstanceHandle
+{
+    Uint32 index{0xFFFFFFFFu};
+    Uint32 generation{0};
+};
+
+/*!
+ * \struct InstanceStorage
+ * \brief The per-instance arrays of a SpriteInstances that Python can view. Shared, so a view keeps them alive.
+ */
+struct InstanceStorage
+{
+    std::vector<Uint16> prototypes;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<Uint8> renderable;
+    std::vector<Uint8> states;
+
+    void Reserve(size_t capacity)
+    {
+        prototypes.reserve(capacity);
+        x.reserve(capacity);
+        y.reserve(capacity);
+        renderable.reserve(capacity);
+        states.reserve(capacity);
+    }
+};
+
+/*!
+ * \class SpriteInstances
+ * \brief The SpriteInstances class stores many lightweight sprite instances as parallel arrays.
+ *
+ * Each instance is only a prototype index, a position, a renderable flag and an activity state; everything else comes
+ * from the PrototypeRegistry. Spawning instances is an array fill. Rendering and collision walk a packed list of the
+ * live instances, and only bodies awake in the PhysicsWorld set with SetPhysics are synced back, so dead and resting
+ * instances cost nothing per frame. Killed instances leave their slot on a free list for the next spawn, so an instance
+ * keeps its index for as long as it lives. Each slot has a generation that changes whenever the instance in it dies, so
+ * an InstanceHandle kept past the death of its instance does not name the next one.
+ *
+ * The arrays Python views live in an InstanceStorage of fixed capacity that is never reallocated while anything else
+ * holds it: growing past the capacity moves the instances into a new storage and leaves the old one to its holders,
+ * so a view never points at freed memory, but it stops following the instances. GetStorageGeneration tells when that
+ * happened; Reserve up front keeps it from happening.
+ */
+class SpriteInstances
+{
+public:
+    SpriteInstances() = default;
+    SpriteInstances(const SpriteInstances &) = delete;
+    SpriteInstances &operator=(const SpriteInstances &) = delete;
+
+    /*!
+     * \brief Spawns one static instance, reusing the slot of a dead instance if there is one.
+     * \param prototype The prototype index.
+     * \param x The X position.
+     * \param y The Y position.
+     * \return The index of the new instance.
+     */
+    size_t Spawn(Uint16 prototype, float x, float y)
+    {
+        size_t i;
+        if (!mFree.empty())
+        {
+            i = mFree.back();
+            mFree.pop_back();
+        }
+        else
+        {
+            i = mStorage->x.size();
+            Grow(i + 1);
+            mStorage->prototypes.push_back(prototype);
+            mStorage->x.push_back(x);
+            mStorage->y.push_back(y);
+            mStorage->renderable.push_back(1);
+            mBodies.push_back(PhysicsWorld::kNoBody);
+            mStorage->states.push_back(INSTANCE_STATIC);
+            mLivePos.push_back(kNotLive);
+            GrowGenerations();
+        }
+        mStorage->prototypes[i] = prototype;
+        mStorage->x[i] = x;
+        mStorage->y[i] = y;
+        mStorage->renderable[i] = 1;
+        mStorage->states[i] = INSTANCE_STATIC;
+        mLivePos[i] = static_cast<Uint32>(mLive.size());
+        mLive.push_back(static_cast<Uint32>(i));
+        return i;
+    }
+
+    /*!
+     * \brief Spawns many static instances of the same prototype. Dead slots are reused first, the rest is appended.
+     * \param prototype The prototype index.
+     * \param xs The X positions.
+     * \param ys The Y positions.
+     * \param count The number of instances to spawn.
+     * \param indices If not null, receives the index of each new instance.
+     */
+    void SpawnMany(Uint16 prototype, const float *xs, const float *ys, size_t count, Uint32 *indices = nullptr)
+    {
+        size_t n = 0;
+        for (; n < count && !mFree.empty(); n++)
+        {
+            size_t i = Spawn(prototype, xs[n], ys[n]);
+            if (indices)
+            {
+                indices[n] = static_cast<Uint32>(i);
+            }
+        }
+
+        size_t first = mStorage->x.size();
+        size_t rest = count - n;
+        Grow(first + rest);
+        mStorage->prototypes.resize(first + rest, prototype);
+        mStorage->renderable.resize(first + rest, 1);
+        mBodies.resize(first + rest, PhysicsWorld::kNoBody);
+        mStorage->states.resize(first + rest, INSTANCE_STATIC);
+        mStorage->x.insert(mStorage->x.end(), xs + n, xs + count);
+        mStorage->y.insert(mStorage->y.end(), ys + n, ys + count);
+        mLivePos.resize(first + rest);
+        GrowGenerations();
+        for (size_t i = first; i < first + rest; i++)
+        {
+            mLivePos[i] = static_cast<Uint32>(mLive.size());
+            mLive.push_back(static_cast<Uint32>(i));
+            if (indices)
+            {
+                indices[n++] = static_cast<Uint32>(i);
+            }
+        }
+    }
+
+    /*!
+     * \brief Kills an instance: it is hidden, loses its body and its slot is reused by a later spawn.
+     * \param i The instance; killing a dead instance does nothing.
+     */
+    void Kill(size_t i)
+    {
+        if (mStorage->states[i] == INSTANCE_DEAD)
+        {
+            return;
+        }
+        DestroyBody(i);
+        mStorage->states[i] = INSTANCE_DEAD;
+        mStorage->renderable[i] = 0;
+
+        Uint32 pos = mLivePos[i];
+        Uint32 moved = mLive.back();
+        mLive[pos] = moved;
+        mLivePos[moved] = pos;
+        mLive.pop_back();
+        mLivePos[i] = kNotLive;
+        mFree.push_back(static_cast<Uint32>(i));
+        mGenerations[i]++;
+    }
+
+    /*!
+     * \brief Gets the activity state of an instance.
+     */
+    InstanceState GetState(size_t i) const
+    {
+        return static_cast<InstanceState>(mStorage->states[i]);
+    }
+
+    /*!
+     * \brief Checks whether an instance is alive, i.e. not killed.
+     */
+    bool IsAlive(size_t i) const
+    {
+        return mStorage->states[i] != INSTANCE_DEAD;
+    }
+
+    /*!
+     * \brief Gets a handle to an instance, which stops naming it once it dies.
+     */
+    InstanceHandle GetHandle(size_t i) const
+    {
+        return InstanceHandle{static_cast<Uint32>(i), mGenerations[i]};
+    }
+
+    /*!
+     * \brief Checks whether the instance a handle names is still alive; false once its slot was removed or reused.
+     */
+    bool IsAlive(InstanceHandle instance) const
+    {
+        return instance.index < mStorage->states.size() && mGenerations[instance.index] == instance.generation &&
+               mStorage->states[instance.index] != INSTANCE_DEAD;
+    }
+
+    /*!
+     * \brief Gets the number of live instances.
+     */
+    size_t GetLiveCount() const
+    {
+        return mLive.size();
+    }
+
+    /*!
+     * \brief Kills many instances at once.
+     * \param indices The indices of the instances to kill, in any order; out-of-range indices are ignored.
+     * \param count The number of indices.
+     * \return The number of live instances left.
+     *
+     * Like Kill, no other instance changes its index, so collider ids and indices held by scripts stay valid.
+     */
+    size_t DespawnMany(const Uint32 *indices, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (indices[i] < mStorage->states.size())
+            {
+                Kill(indices[i]);
+            }
+        }
+        return mLive.size();
+    }
+
+    /*!
+     * \brief Reserves storage for a number of instances, so spawning up to it does not reallocate.
+     *
+     * If views still hold the current storage, the instances move to a new one and the storage generation changes.
+     */
+    void Reserve(size_t capacity)
+    {
+        if (capacity > mCapacity)
+        {
+            if (mStorage.use_count() > 1)
+            {
+                // Leave the arrays to the views and carry on in a copy, rather than move memory under them
+                auto storage = std::make_shared<InstanceStorage>();
+                storage->Reserve(capacity);
+                storage->prototypes.insert(storage->prototypes.end(), mStorage->prototypes.begin(), mStorage->prototypes.end());
+                storage->x.insert(storage->x.end(), mStorage->x.begin(), mStorage->x.end());
+                storage->y.insert(storage->y.end(), mStorage->y.begin(), mStorage->y.end());
+                storage->renderable.insert(storage->renderable.end(), mStorage->renderable.begin(), mStorage->renderable.end());
+                storage->states.insert(storage->states.end(), mStorage->states.begin(), mStorage->states.end());
+                mStorage = std::move(storage);
+            }
+            else
+            {
+                mStorage->Reserve(capacity);
+            }
+            mCapacity = capacity;
+            mStorageGeneration++;
+        }
+        mBodies.reserve(capacity);
+        mLivePos.reserve(capacity);
+        mLive.reserve(capacity);
+        mGenerations.reserve(capacity);
+    }
+
+    /*!
+     * \brief Gets the arrays of the instances, for zero-copy views. They hold Size() instances, never reallocate and
+     * stay alive while the returned pointer is held; once the storage generation changes, they are no longer updated.
+     */
+    std::shared_ptr<InstanceStorage> GetStorage() const
+    {
+        return mStorage;
+    }
+
+    /*!
+     * \brief Gets a number that changes whenever the instances move to a new storage.
+     */
+    Uint32 GetStorageGeneration() const
+    {
+        return mStorageGeneration;
+    }
+
+    /*!
+     * \brief Removes all instances and their bodies, keeping the allocated storage.
+     */
+    void Clear()
+    {
+        for (size_t i = 0; i < mBodies.size(); i++)
+        {
+            DestroyBody(i);
+        }
+        mStorage->prototypes.clear();
+        mStorage->x.clear();
+        mStorage->y.clear();
+        mStorage->renderable.clear();
+        mBodies.clear();
+        mStorage->states.clear();
+        mLivePos.clear();
+        mLive.clear();
+        mFree.clear();
+        RetireGenerations();
+    }
+
+    /*!
+     * \brief Gets the number of instance slots, dead ones included.
+     */
+    size_t Size() const
+    {
+        return mStorage->x.size();
+    }
+
+    /*!
+     * \brief Gets the prototype index of an instance.
+     */
+    Uint16 GetPrototype(size_t i) const
+    {
+        return mStorage->prototypes[i];
+    }
+
+    /*!
+     * \brief Gets the X position of an instance.
+     */
+    float GetX(size_t i) const
+    {
+        return mStorage->x[i];
+    }
+
+    /*!
+     * \brief Gets the Y position of an instance.
+     */
+    float GetY(size_t i) const
+    {
+        return mStorage->y[i];
+    }
+
+    /*!
+     * \brief Moves an instance.
+     */
+    void Move(size_t i, float x, float y)
+    {
+        mStorage->x[i] = x;
+        mStorage->y[i] = y;
+        if (mBodies[i] != PhysicsWorld::kNoBody)
+        {
+            mPhysics->SetPosition(mBodies[i], x, y);
+            mStorage->states[i] = INSTANCE_ACTIVE;
+        }
+    }
+
+    /*!
+     * \brief Sets the physics world that bodies of these instances are created in. Must outlive the instances.
+     * \param physics The physics world.
+     * \param group Identifies these instances among the bodies of the world; unique per world.
+     */
+    void SetPhysics(PhysicsWorld *physics, Uint32 group)
+    {
+        mPhysics = physics;
+        mGroup = group;
+    }
+
+    /*!
+     * \brief Gives an instance a body, so the physics world moves it.
+     * \param i The instance.
+     * \param gravityScale Multiplier applied to the world gravity.
+     * \return The body handle, or PhysicsWorld::kNoBody if no physics world is set.
+     */
+    Uint32 EnablePhysics(size_t i, float gravityScale = 1.0f)
+    {
+        if (mPhysics == nullptr)
+        {
+            return PhysicsWorld::kNoBody;
+        }
+        if (mBodies[i] == PhysicsWorld::kNoBody)
+        {
+            mBodies[i] = mPhysics->CreateBody(GetRectangle(i), gravityScale, CollisionSystem::MakeId(mGroup, static_cast<Uint32>(i)));
+        }
+        else
+        {
+            mPhysics->SetGravityScale(mBodies[i], gravityScale);
+        }
+        mStorage->states[i] = INSTANCE_ACTIVE;
+        return mBodies[i];
+    }
+
+    /*!
+     * \brief Gets the body handle of an instance, or PhysicsWorld::kNoBody if it is static.
+     */
+    Uint32 GetBody(size_t i) const
+    {
+        return mBodies[i];
+    }
+
+    /*!
+     * \brief Copies the positions of the instances whose bodies moved in the last physics step.
+     *
+     * Only the world's awake bodies are visited. Instances whose body fell asleep become INSTANCE_SLEEPING.
+     */
+    void SyncBodies()
+    {
+        if (mPhysics == nullptr)
+        {
+            return;
+        }
+        mPhysics->ForEachMoved([this](Uint32 owner, float x, float y)
+                               {
+            if (CollisionSystem::GetGroup(owner) != mGroup)
+            {
+                return;
+            }
+            size_t i = CollisionSystem::GetIndex(owner);
+            mStorage->x[i] = x;
+            mStorage->y[i] = y;
+            mStorage->states[i] = mPhysics->IsAwake(mBodies[i]) ? INSTANCE_ACTIVE : INSTANCE_SLEEPING; });
+    }
+
+    /*!
+     * \brief Checks if an instance is renderable.
+     */
+    bool IsRenderable(size_t i) const
+    {
+        return mStorage->renderable[i] != 0;
+    }
+
+    /*!
+     * \brief Sets the renderable state of an instance.
+     */
+    void SetRenderable(size_t i, bool value)
+    {
+        mStorage->renderable[i] = value ? 1 : 0;
+    }
+
+    /*!
+     * \brief Gets the rectangle covered by an instance's sprite.
+     */
+    SDL_FRect GetRectangle(size_t i) const
+    {
+        const SpritePrototype &prototype = PrototypeRegistry::GetInstance().Get(mStorage->prototypes[i]);
+        return SDL_FRect{mStorage->x[i], mStorage->y[i], prototype.width, prototype.height};
+    }
+
+    /*!
+     * \brief Gets the collision box of an instance, in world coordinates.
+     */
+    SDL_FRect GetCollisionBox(size_t i) const
+    {
+        const SpritePrototype &prototype = PrototypeRegistry::GetInstance().Get(mStorage->prototypes[i]);
+        const SDL_FRect &box = prototype.collisionBox;
+        return SDL_FRect{mStorage->x[i] + box.x, mStorage->y[i] + box.y, box.w, box.h};
+    }
+
+    /*!
+     * \brief Submits a collider for every live, renderable instance whose prototype has a collision layer.
+     * \param collisions The collision system to submit to.
+     * \param group The group part of the collider ids; the index part is the instance index.
+     */
+    void AddColliders(CollisionSystem &collisions, Uint32 group) const
+    {
+        const PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+        for (Uint32 i : mLive)
+        {
+            const SpritePrototype &prototype = registry.Get(mStorage->prototypes[i]);
+            if (!mStorage->renderable[i] || prototype.collisionLayer == COLLISION_LAYER_NONE)
+            {
+                continue;
+            }
+            const SDL_FRect &box = prototype.collisionBox;
+            collisions.AddCollider(SDL_FRect{mStorage->x[i] + box.x, mStorage->y[i] + box.y, box.w, box.h}, prototype.collisionLayer,
+                                   prototype.collisionMask, CollisionSystem::MakeId(group, i));
+        }
+    }
+
+    /*!
+     * \brief Records a draw for every live, renderable instance.
+     * \param packet The frame packet to record into.
+     */
+    void Render(FramePacket &packet) const
+    {
+        const PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+        for (Uint32 i : mLive)
+        {
+            if (!mStorage->renderable[i])
+            {
+                continue;
+            }
+            const SpritePrototype &prototype = registry.Get(mStorage->prototypes[i]);
+            if (prototype.texture != nullptr)
+            {
+                packet.DrawSprite(prototype.texture, SDL_FRect{mStorage->x[i], mStorage->y[i], prototype.width, prototype.height});
+            }
+        }
+    }
+
+    /*!
+     * \brief Appends the state of every instance to a snapshot.
+     */
+    void Save(SceneSnapshot &snapshot) const
+    {
+        snapshot.WriteArray(mStorage->prototypes);
+        snapshot.WriteArray(mStorage->x);
+        snapshot.WriteArray(mStorage->y);
+        snapshot.WriteArray(mStorage->renderable);
+        snapshot.WriteArray(mBodies);
+        snapshot.WriteArray(mStorage->states);
+    }
+
+    /*!
+     * \brief Restores the state saved by Save.
+     * \return False if the snapshot is malformed.
+     *
+     * Instance i of the snapshot becomes instance i again, so indices held elsewhere stay valid. Body handles are
+     * restored as saved; the physics world must be restored from the same snapshot. The live and free lists are
+     * rebuilt from the states.
+     */
+    bool Restore(SnapshotReader &reader)
+    {
+        bool ok = ReadColumn(reader, &InstanceStorage::prototypes) && ReadColumn(reader, &InstanceStorage::x) &&
+                  ReadColumn(reader, &InstanceStorage::y) && ReadColumn(reader, &InstanceStorage::renderable) &&
+                  reader.ReadArray(mBodies) && ReadColumn(reader, &InstanceStorage::states) && mStorage->x.size() == mStorage->prototypes.size() &&
+                  mStorage->y.size() == mStorage->prototypes.size() && mStorage->renderable.size() == mStorage->prototypes.size() &&
+                  mBodies.size() == mStorage->prototypes.size() && mStorage->states.size() == mStorage->prototypes.size();
+        if (ok)
+        {
+            RetireGenerations();
+            GrowGenerations();
+            RebuildLists();
+        }
+        return ok;
+    }
+
+private:
+    static constexpr Uint32 kNotLive = 0xFFFFFFFFu;
+
+    /*!
+     * \brief Rebuilds the live and free lists from the states, in index order.
+     */
+    void RebuildLists()
+    {
+        mLive.clear();
+        mFree.clear();
+        mLivePos.assign(mStorage->states.size(), kNotLive);
+        for (size_t i = 0; i < mStorage->states.size(); i++)
+        {
+            if (mStorage->states[i] == INSTANCE_DEAD)
+            {
+                mFree.push_back(static_cast<Uint32>(i));
+            }
+            else
+            {
+                mLivePos[i] = static_cast<Uint32>(mLive.size());
+                mLive.push_back(static_cast<Uint32>(i));
+            }
+        }
+    }
+
+    /*!
+     * \brief Reserves room for at least count instances, growing geometrically.
+     */
+    void Grow(size_t count)
+    {
+        if (count > mCapacity)
+        {
+            Reserve(std::max({count, mCapacity * 2, size_t{16}}));
+        }
+    }
+
+    /*!
+     * \brief Reads one array of the storage from a snapshot, growing the storage first so the read does not reallocate.
+     */
+    template <typename T>
+    bool ReadColumn(SnapshotReader &reader, std::vector<T> InstanceStorage::*column)
+    {
+        Uint64 count = 0;
+        if (!reader.PeekArraySize<T>(count))
+        {
+            return false;
+        }
+        Grow(static_cast<size_t>(count));
+        return reader.ReadArray((*mStorage).*column);
+    }
+
+    /*!
+     * \brief Gives every slot a generation. Generations are kept when the arrays shrink, so handles to removed slots
+     * stay dead if the slots come back.
+     */
+    void GrowGenerations()
+    {
+        if (mGenerations.size() < mStorage->states.size())
+        {
+            mGenerations.resize(mStorage->states.size(), 0);
+        }
+    }
+
+    /*!
+     * \brief Makes every handle handed out so far dead, e.g. when every slot gets a new instance.
+     */
+    void RetireGenerations()
+    {
+        for (Uint32 &generation : mGenerations)
+        {
+            generation++;
+        }
+    }
+
+    /*!
+     * \brief Destroys the body of an instance, if it has one.
+     */
+    void DestroyBody(size_t i)
+    {
+        if (mBodies[i] != PhysicsWorld::kNoBody && mPhysics != nullptr)
+        {
+            mPhysics->DestroyBody(mBodies[i]);
+        }
+        mBodies[i] = PhysicsWorld::kNoBody;
+    }
+
+    std::shared_ptr<InstanceStorage> mStorage{std::make_shared<InstanceStorage>()};
+    size_t mCapacity{0};          //!< Instances the storage holds without reallocating.
+    Uint32 mStorageGeneration{0};
+    std::vector<Uint32> mBodies;
+    std::vector<Uint32> mLivePos;     //!< Position of each instance in mLive, or kNotLive.
+    std::vector<Uint32> mLive;        //!< Indices of all instances that are not dead.
+    std::vector<Uint32> mFree;        //!< Indices of dead instances, reused by Spawn.
+    std::vector<Uint32> mGenerations; //!< Per slot; changes when its instance dies. Never shrinks.
+    PhysicsWorld *mPhysics{nullptr};
+    Uint32 mGroup{0};
+};
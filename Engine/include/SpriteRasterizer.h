@@ -0,0 +1,150 @@
+#pragma once
+#ifndef SPRITE_RASTERIZER_H
+#define SPRITE_RASTERIZER_H
+
+#include "FramePacket.h"
+#include "ThreadPool.h"
+#include <SDL2/SDL.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \class SpriteRasterizer
+ * \brief Draws frame packets into a plain ARGB8888 framebuffer on the CPU, for machines without a GPU and for capture.
+ *
+ * Each texture is copied once to ARGB8888 and classified by its alpha channel: opaque textures are copied, textures
+ * whose alpha is only 0 or 255 (including converted color keys) are masked, and all others are alpha blended. Sprites
+ * are sampled nearest-neighbor like SDL's software renderer; quads of geometry batches must be axis-aligned, as all
+ * quads the engine records are, and are modulated by the color of their first vertex.
+ *
+ * The row kernels are picked once at startup from what the CPU supports: AVX2 or SSE4.1 on x86, NEON on ARM, and
+ * portable C++ otherwise. The framebuffer is cut into bands of kBandRows rows and the bands are rasterized in parallel,
+ * each band running every draw clipped to its rows, so the result does not depend on the thread count.
+ */
+class SpriteRasterizer
+{
+public:
+    static constexpr int kBandRows = 16;
+
+    /*!
+     * \brief Finds the pixels of a texture; by default asks the ResourceManager for the image it was created from.
+     */
+    using TextureResolver = std::function<const SDL_Surface *(SDL_Texture *)>;
+
+    /*!
+     * \brief Creates the rasterizer.
+     * \param threads The number of threads rasterizing a frame, including the caller; 0 uses one per core.
+     * \param resolver Finds the pixels of the textures in the packets; null uses ResourceManager::GetTextureImage.
+     */
+    explicit SpriteRasterizer(size_t threads = 0, TextureResolver resolver = nullptr);
+
+    /*!
+     * \brief Draws a packet into the framebuffer.
+     * \param packet The frame to draw.
+     * \param width The width of the framebuffer.
+     * \param height The height of the framebuffer.
+     * \param scale Factor from packet coordinates to framebuffer pixels, e.g. the packet's render scale.
+     * \param overlay Whether to draw the overlay layer too, on top of the scene and at the same scale.
+     */
+    void Render(const FramePacket &packet, int width, int height, float scale = 1.0f, bool overlay = false);
+
+    /*!
+     * \brief Gets the pixels of the last frame: GetHeight rows of GetWidth ARGB8888 pixels, without padding.
+     */
+    const Uint32 *GetPixels() const
+    {
+        return mPixels.data();
+    }
+
+    /*!
+     * \brief Exchanges the framebuffer with another buffer, to keep the last frame without copying it.
+     *
+     * The next Render resizes whatever buffer it was given.
+     */
+    void SwapPixels(std::vector<Uint32> &pixels)
+    {
+        mPixels.swap(pixels);
+    }
+
+    int GetWidth() const
+    {
+        return mWidth;
+    }
+
+    int GetHeight() const
+    {
+        return mHeight;
+    }
+
+    /*!
+     * \brief Gets the number of threads rasterizing a frame.
+     */
+    size_t GetThreadCount() const
+    {
+        return mPool.GetThreadCount();
+    }
+
+    /*!
+     * \brief Forgets every converted texture, e.g. after the textures were destroyed.
+     */
+    void ClearTextures();
+
+    /*!
+     * \brief Gets the name of the row kernels in use: "avx2", "sse4.1", "neon" or "scalar".
+     */
+    static const char *GetKernelName();
+
+    /*!
+     * \brief Switches the row kernels of every rasterizer, e.g. to compare them.
+     * \param name "avx2", "sse4.1", "neon", "scalar", or "auto" for the best the CPU supports.
+     * \return False if the CPU or the build does not support them; the kernels are then left as they were.
+     */
+    static bool SelectKernels(const std::string &name);
+
+private:
+    enum class TextureKind
+    {
+        Opaque, //!< Every alpha is 255.
+        Masked, //!< Every alpha is 0 or 255.
+        Blended
+    };
+
+    struct Texture
+    {
+        std::vector<Uint32> pixels;
+        int width{0};
+        int height{0};
+        TextureKind kind{TextureKind::Opaque};
+    };
+
+    /*!
+     * \brief A draw, resolved and in framebuffer pixels.
+     */
+    struct Draw
+    {
+        const Texture *texture; //!< Null fills the rectangle with color.
+        SDL_Rect source;
+        int x0, y0, x1, y1;     //!< Destination, half-open; not clipped.
+        SDL_Color color;
+        bool modulated;         //!< Whether color is not opaque white.
+    };
+
+    const Texture *Resolve(SDL_Texture *texture);
+    void AddSprites(const FramePacket &packet, size_t first, size_t end, float scale);
+    void AddBatches(const FramePacket &packet, size_t first, size_t end, float scale);
+    void RasterizeBand(int top, int bottom) const;
+
+    ThreadPool mPool;
+    TextureResolver mResolver;
+    std::unordered_map<SDL_Texture *, std::unique_ptr<Texture>> mTextures;
+    std::vector<Draw> mDraws;
+    std::vector<Uint32> mPixels;
+    int mWidth{0};
+    int mHeight{0};
+    Uint32 mClear{0xFF000000u};
+};
+
+#endif // SPRITE_RASTERIZER_H
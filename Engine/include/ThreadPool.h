@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * \class ThreadPool
+ * \brief The ThreadPool class keeps a set of worker threads alive and splits index ranges across them.
+ *
+ * ParallelFor cuts [0, count) into one contiguous chunk per thread, including the calling thread, and returns once
+ * every chunk is done. Workers sleep on a condition variable between calls, so an idle pool costs nothing.
+ */
+class ThreadPool
+{
+public:
+    /*!
+     * \brief Creates the pool.
+     * \param threads The total number of threads working on a ParallelFor, including the caller. 0 uses one per core.
+     */
+    explicit ThreadPool(size_t threads = 0)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 1; i < threads; i++)
+        {
+            mWorkers.emplace_back(&ThreadPool::Run, this, i);
+        }
+    }
+
+    /*!
+     * \brief Stops and joins all workers.
+     */
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mWake.notify_all();
+        for (auto &worker : mWorkers)
+        {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /*!
+     * \brief Gets the number of threads that share a ParallelFor, including the caller.
+     */
+    size_t GetThreadCount() const
+    {
+        return mWorkers.size() + 1;
+    }
+
+    /*!
+     * \brief Runs body over [0, count) in parallel.
+     * \param count The size of the index range.
+     * \param body Called once per chunk with the half-open range [begin, end). Must be safe to call concurrently.
+     *
+     * Must not be called from inside body.
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)> &body)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        size_t threads = GetThreadCount();
+        if (threads == 1 || count == 1)
+        {
+            body(0, count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mBody = &body;
+            mCount = count;
+            mPending = mWorkers.size();
+            mGeneration++;
+        }
+        mWake.notify_all();
+
+        RunChunk(0);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]()
+                   { return mPending == 0; });
+        mBody = nullptr;
+    }
+
+private:
+    /*!
+     * \brief Runs the chunk belonging to the given thread slot.
+     */
+    void RunChunk(size_t slot)
+    {
+        size_t threads = GetThreadCount();
+        size_t begin = mCount * slot / threads;
+        size_t end = mCount * (slot + 1) / threads;
+        if (begin < end)
+        {
+            (*mBody)(begin, end);
+        }
+    }
+
+    /*!
+     * \brief Body of a worker thread.
+     */
+    void Run(size_t slot)
+    {
+        size_t seenGeneration = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWake.wait(lock, [this, seenGeneration]()
+                           { return mStopping || mGeneration != seenGeneration; });
+                if (mStopping)
+                {
+                    return;
+                }
+                seenGeneration = mGeneration;
+            }
+
+            RunChunk(slot);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (--mPending == 0)
+            {
+                mDone.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    const std::function<void(size_t, size_t)> *mBody{nullptr};
+    size_t mCount{0};
+    size_t mPending{0};
+    size_t mGeneration{0};
+    bool mStopping{false};
+};
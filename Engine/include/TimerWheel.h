@@ -0,0 +1,336 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*!
+ * \struct TimerHandle
+ * \brief Names a scheduled timer. Stays safe to use after the timer fired or was cancelled.
+ */
+struct TimerHandle
+{
+    Uint32 index{0xFFFFFFFFu};
+    Uint32 generation{0};
+};
+
+/*!
+ * \class TimerWheel
+ * \brief The TimerWheel calls functions after a number of simulation ticks, without polling every pending timer.
+ *
+ * It is a hierarchical timing wheel: kLevels wheels of kSlots slots, where a slot of level L spans kSlots^L ticks. A
+ * timer is linked into the slot of the coarsest level that still tells its expiry apart, so scheduling and cancelling
+ * are a list insert and unlink. Whenever the finest wheel wraps, the next slot of the coarser wheel is emptied and its
+ * timers are spread over the finer wheels; each timer moves at most kLevels - 1 times before it fires. Timers further
+ * out than the wheels reach are parked in the last slot that fits and placed again when it is reached.
+ *
+ * Timers are kept in a pool of nodes with a generation per node, so handles of fired or cancelled timers simply stop
+ * matching. Advance collects every timer expiring on a tick before calling any of them, then calls them in the order
+ * they were scheduled; a callback may schedule or cancel timers, including itself.
+ */
+class TimerWheel
+{
+public:
+    using Callback = std::function<void()>;
+
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr Uint32 kSlots = 1u << kSlotBits;
+    static constexpr Uint64 kRange = 1ull << (kSlotBits * kLevels); //!< Ticks the wheels reach; about 3 days at 60 Hz.
+
+    TimerWheel()
+    {
+        std::fill(std::begin(mHeads), std::end(mHeads), kNone);
+    }
+
+    /*!
+     * \brief Schedules a function.
+     * \param delayTicks Ticks until it is called; 0 calls it on the next tick like 1.
+     * \param callback The function.
+     * \param periodTicks If not 0, the timer repeats with this period until cancelled.
+     * \return A handle for Cancel.
+     */
+    TimerHandle Schedule(Uint32 delayTicks, Callback callback, Uint32 periodTicks = 0)
+    {
+        Uint32 index;
+        if (!mFree.empty())
+        {
+            index = mFree.back();
+            mFree.pop_back();
+        }
+        else
+        {
+            index = static_cast<Uint32>(mTimers.size());
+            mTimers.emplace_back();
+        }
+        Timer &timer = mTimers[index];
+        timer.callback = std::move(callback);
+        timer.expires = mNow + (delayTicks == 0 ? 1 : delayTicks);
+        timer.period = periodTicks;
+        timer.pending = true;
+        Place(index);
+        mPendingCount++;
+        return TimerHandle{index, timer.generation};
+    }
+
+    /*!
+     * \brief Cancels a timer. Cancelling a timer that fired or was cancelled already does nothing.
+     * \return True if the timer was pending.
+     */
+    bool Cancel(TimerHandle handle)
+    {
+        if (!IsPending(handle))
+        {
+            return false;
+        }
+        Timer &timer = mTimers[handle.index];
+        if (timer.list == kFiring)
+        {
+            // Its callback is running or about to; it is released once the batch gets to it
+            timer.pending = false;
+            return true;
+        }
+        Unlink(handle.index);
+        Release(handle.index);
+        return true;
+    }
+
+    /*!
+     * \brief Checks whether a timer is still waiting to fire, or repeating.
+     */
+    bool IsPending(TimerHandle handle) const
+    {
+        return handle.index < mTimers.size() && mTimers[handle.index].generation == handle.generation && mTimers[handle.index].pending;
+    }
+
+    /*!
+     * \brief Gets the ticks left until a pending timer fires, or 0 if it is not pending.
+     */
+    Uint64 GetRemaining(TimerHandle handle) const
+    {
+        return IsPending(handle) ? mTimers[handle.index].expires - mNow : 0;
+    }
+
+    /*!
+     * \brief Advances the wheels and calls every timer that expires on the way.
+     * \param ticks The number of ticks to advance.
+     */
+    void Advance(Uint32 ticks = 1)
+    {
+        for (Uint32 t = 0; t < ticks; t++)
+        {
+            mNow++;
+            mFiredLastAdvance = 0;
+
+            // Spread the next slot of each coarser wheel that starts on this tick over the finer wheels
+            for (int level = 1; level < kLevels; level++)
+            {
+                if ((mNow & ((1ull << (kSlotBits * level)) - 1)) != 0)
+                {
+                    break;
+                }
+                Cascade(level, static_cast<Uint32>((mNow >> (kSlotBits * level)) & (kSlots - 1)));
+            }
+
+            // Collect the whole batch before calling anything, so callbacks can reschedule freely
+            Uint32 &head = mHeads[mNow & (kSlots - 1)];
+            while (head != kNone)
+            {
+                Uint32 index = head;
+                Unlink(index);
+                if (mTimers[index].expires > mNow)
+                {
+                    Place(index); // A parked timer that is not due yet
+                    continue;
+                }
+                mTimers[index].list = kFiring;
+                mBatch.push_back(TimerHandle{index, mTimers[index].generation});
+            }
+            // Slot lists are last in, first out; fire in scheduling order
+            std::reverse(mBatch.begin(), mBatch.end());
+            Fire();
+        }
+    }
+
+    /*!
+     * \brief Cancels every timer.
+     */
+    void Clear()
+    {
+        for (Uint32 index = 0; index < mTimers.size(); index++)
+        {
+            Timer &timer = mTimers[index];
+            if (!timer.pending)
+            {
+                continue;
+            }
+            if (timer.list == kFiring)
+            {
+                timer.pending = false;
+                continue;
+            }
+            timer.list = kNone;
+            Release(index);
+        }
+        std::fill(std::begin(mHeads), std::end(mHeads), kNone);
+    }
+
+    /*!
+     * \brief Gets the number of ticks advanced since the wheel was created.
+     */
+    Uint64 GetTick() const
+    {
+        return mNow;
+    }
+
+    /*!
+     * \brief Gets the number of pending timers.
+     */
+    size_t GetPendingCount() const
+    {
+        return mPendingCount;
+    }
+
+    /*!
+     * \brief Gets the number of callbacks called by the last tick of Advance.
+     */
+    size_t GetFiredLastAdvance() const
+    {
+        return mFiredLastAdvance;
+    }
+
+private:
+    static constexpr Uint32 kNone = 0xFFFFFFFFu;
+    static constexpr Uint32 kFiring = 0xFFFFFFFEu; //!< List id of timers taken out of the wheel to be called.
+
+    struct Timer
+    {
+        Callback callback;
+        Uint64 expires{0};
+        Uint32 period{0};
+        Uint32 generation{0};
+        Uint32 prev{kNone};
+        Uint32 next{kNone};
+        Uint32 list{kNone}; //!< Slot list the timer is linked into: level * kSlots + slot.
+        bool pending{false};
+    };
+
+    /*!
+     * \brief Links a timer into the slot its expiry falls in.
+     */
+    void Place(Uint32 index)
+    {
+        Timer &timer = mTimers[index];
+        Uint64 expires = timer.expires;
+        Uint64 delta = expires - mNow;
+        if (delta >= kRange)
+        {
+            // Beyond the wheels: park in the furthest slot and place it again from there
+            expires = mNow + kRange - 1;
+            delta = kRange - 1;
+        }
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (1ull << (kSlotBits * (level + 1))))
+        {
+            level++;
+        }
+        Uint32 list = static_cast<Uint32>(level) * kSlots + static_cast<Uint32>((expires >> (kSlotBits * level)) & (kSlots - 1));
+
+        timer.list = list;
+        timer.prev = kNone;
+        timer.next = mHeads[list];
+        if (timer.next != kNone)
+        {
+            mTimers[timer.next].prev = index;
+        }
+        mHeads[list] = index;
+    }
+
+    void Unlink(Uint32 index)
+    {
+        Timer &timer = mTimers[index];
+        if (timer.prev != kNone)
+        {
+            mTimers[timer.prev].next = timer.next;
+        }
+        else
+        {
+            mHeads[timer.list] = timer.next;
+        }
+        if (timer.next != kNone)
+        {
+            mTimers[timer.next].prev = timer.prev;
+        }
+        timer.prev = timer.next = kNone;
+        timer.list = kNone;
+    }
+
+    /*!
+     * \brief Moves every timer of a coarse slot down to the wheel that now tells its expiry apart.
+     */
+    void Cascade(int level, Uint32 slot)
+    {
+        Uint32 &head = mHeads[static_cast<Uint32>(level) * kSlots + slot];
+        Uint32 index = head;
+        head = kNone;
+        while (index != kNone)
+        {
+            Uint32 next = mTimers[index].next;
+            Place(index);
+            index = next;
+        }
+    }
+
+    /*!
+     * \brief Calls the collected batch. The callback is moved out while it runs, because it may schedule timers and
+     * grow the node pool.
+     */
+    void Fire()
+    {
+        mFiring.swap(mBatch);
+        for (const TimerHandle &handle : mFiring)
+        {
+            if (handle.index >= mTimers.size() || mTimers[handle.index].generation != handle.generation)
+            {
+                continue;
+            }
+            if (mTimers[handle.index].pending)
+            {
+                Callback callback = std::move(mTimers[handle.index].callback);
+                mFiredLastAdvance++;
+                callback();
+                Timer &timer = mTimers[handle.index];
+                if (timer.pending && timer.period != 0)
+                {
+                    timer.callback = std::move(callback);
+                    timer.expires = mNow + timer.period;
+                    Place(handle.index);
+                    continue;
+                }
+            }
+            mTimers[handle.index].list = kNone;
+            Release(handle.index);
+        }
+        mFiring.clear();
+    }
+
+    void Release(Uint32 index)
+    {
+        Timer &timer = mTimers[index];
+        timer.callback = nullptr;
+        timer.generation++;
+        timer.pending = false;
+        mPendingCount--;
+        mFree.push_back(index);
+    }
+
+    std::vector<Timer> mTimers;
+    std::vector<Uint32> mFree;
+    Uint32 mHeads[kLevels * kSlots];
+    std::vector<TimerHandle> mBatch;
+    std::vector<TimerHandle> mFiring;
+    Uint64 mNow{0};
+    size_t mPendingCount{0};
+    size_t mFiredLastAdvance{0};
+};
@@ -0,0 +1,234 @@
+#pragma once
+#include "Application.hpp"
+#include "PlayerGameEntity.h"
+#include "ThreadPool.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*!
+ * \class VectorEnv
+ * \brief The VectorEnv class runs many independent, headless copies of a level side by side.
+ *
+ * Each environment is its own BaseScene created without a renderer or window, so no textures are loaded and nothing
+ * touches SDL while stepping. Step splits the environments across a ThreadPool; every environment is only ever
+ * touched by the thread that owns its chunk. Observations are written into contiguous arrays indexed by environment,
+ * so a batch can be read without gathering. Environments that finish are restarted from their initial snapshot on
+ * the same tick.
+ */
+class VectorEnv
+{
+public:
+    /*!
+     * \brief Creates the environments.
+     * \param envCount The number of independent environments.
+     * \param levelIndex The zero-based level every environment plays.
+     * \param threads The number of threads stepping environments, including the caller. 0 uses one per core.
+     *
+     * \throws std::invalid_argument If there is no level with that index.
+     *
+     * Scenes are created and started on the calling thread, since starting a scene registers prototypes.
+     */
+    VectorEnv(size_t envCount, int levelIndex = 0, size_t threads = 0) : mPool(threads)
+    {
+        if (levelIndex < 0 || levelIndex >= SceneManager::kLevelCount)
+        {
+            throw std::invalid_argument("VectorEnv: no level with index " + std::to_string(levelIndex));
+        }
+        mScenes.reserve(envCount);
+        for (size_t i = 0; i < envCount; i++)
+        {
+            std::unique_ptr<BaseScene> scene = SceneManager::CreateLevel(levelIndex, nullptr, nullptr);
+            scene->Init();
+            mScenes.push_back(std::move(scene));
+        }
+
+        size_t count = mScenes.size();
+        mPlayer.assign(2 * count, 0.0f);
+        mScore.assign(count, 0.0f);
+        mReward.assign(count, 0.0f);
+        mDone.assign(count, 0);
+        mWin.assign(count, 0);
+        mLose.assign(count, 0);
+        mEpisodeTicks.assign(count, 0);
+        mEpisodes.assign(count, 0);
+        WriteObservations(0, count);
+    }
+
+    /*!
+     * \brief Restarts every environment and clears the episode counters.
+     */
+    void Reset()
+    {
+        mPool.ParallelFor(mScenes.size(), [this](size_t begin, size_t end)
+                          {
+            for (size_t i = begin; i < end; i++)
+            {
+                mScenes[i]->Restart();
+                mReward[i] = 0.0f;
+                mDone[i] = 0;
+                mWin[i] = 0;
+                mLose[i] = 0;
+                mEpisodeTicks[i] = 0;
+                mEpisodes[i] = 0;
+            }
+            WriteObservations(begin, end); });
+    }
+
+    /*!
+     * \brief Advances every environment in parallel.
+     * \param actions One PlayerActionFlags combination per environment, held for all ticks; nullptr for no input.
+     * \param ticks The number of ticks to simulate per environment.
+     * \param deltaTime The length of a tick in seconds.
+     *
+     * An environment that wins or loses stops early, has done, win and lose set for this step and its reward
+     * covers the final tick; it is then restarted, so the player position and score already belong to the next episode.
+     */
+    void Step(const Uint8 *actions, int ticks, float deltaTime)
+    {
+        mPool.ParallelFor(mScenes.size(), [this, actions, ticks, deltaTime](size_t begin, size_t end)
+                          {
+            for (size_t i = begin; i < end; i++)
+            {
+                StepEnv(i, actions ? actions[i] : PLAYER_ACTION_NONE, ticks, deltaTime);
+            }
+            WriteObservations(begin, end); });
+    }
+
+    /*!
+     * \brief Gets the number of environments.
+     */
+    size_t GetEnvCount() const
+    {
+        return mScenes.size();
+    }
+
+    /*!
+     * \brief Gets the number of threads stepping environments, including the caller.
+     */
+    size_t GetThreadCount() const
+    {
+        return mPool.GetThreadCount();
+    }
+
+    /*!
+     * \brief Player positions, x and y interleaved, two floats per environment.
+     */
+    const float *GetPlayerData() const
+    {
+        return mPlayer.data();
+    }
+
+    /*!
+     * \brief Current score of each environment's episode.
+     */
+    const float *GetScoreData() const
+    {
+        return mScore.data();
+    }
+
+    /*!
+     * \brief Score gained by each environment during the last Step.
+     */
+    const float *GetRewardData() const
+    {
+        return mReward.data();
+    }
+
+    /*!
+     * \brief 1 for environments whose episode ended during the last Step.
+     */
+    const Uint8 *GetDoneData() const
+    {
+        return mDone.data();
+    }
+
+    /*!
+     * \brief 1 for environments whose episode was won during the last Step.
+     */
+    const Uint8 *GetWinData() const
+    {
+        return mWin.data();
+    }
+
+    /*!
+     * \brief 1 for environments whose episode was lost during the last Step.
+     */
+    const Uint8 *GetLoseData() const
+    {
+        return mLose.data();
+    }
+
+    /*!
+     * \brief Ticks simulated in each environment's current episode.
+     */
+    const Uint32 *GetEpisodeTicksData() const
+    {
+        return mEpisodeTicks.data();
+    }
+
+    /*!
+     * \brief Number of finished episodes per environment since creation or the last Reset.
+     */
+    const Uint32 *GetEpisodesData() const
+    {
+        return mEpisodes.data();
+    }
+
+private:
+    /*!
+     * \brief Steps a single environment, restarting it if its episode ends.
+     */
+    void StepEnv(size_t i, Uint8 action, int ticks, float deltaTime)
+    {
+        BaseScene &scene = *mScenes[i];
+        float scoreBefore = scene.GetScore();
+        mDone[i] = 0;
+        mWin[i] = 0;
+        mLose[i] = 0;
+
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            scene.Step(deltaTime, action);
+            mEpisodeTicks[i]++;
+            if (scene.IsCompleted())
+            {
+                mReward[i] = scene.GetScore() - scoreBefore;
+                mDone[i] = 1;
+                mWin[i] = scene.IsWin() ? 1 : 0;
+                mLose[i] = scene.IsLost() ? 1 : 0;
+                mEpisodes[i]++;
+                mEpisodeTicks[i] = 0;
+                scene.Restart();
+                return;
+            }
+        }
+        mReward[i] = scene.GetScore() - scoreBefore;
+    }
+
+    /*!
+     * \brief Copies player position and score of a range of environments into the batched arrays.
+     */
+    void WriteObservations(size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            SDL_FRect player = mScenes[i]->GetPlayerRectangle();
+            mPlayer[2 * i] = player.x;
+            mPlayer[2 * i + 1] = player.y;
+            mScore[i] = mScenes[i]->GetScore();
+        }
+    }
+
+    std::vector<std::unique_ptr<BaseScene>> mScenes;
+    ThreadPool mPool;
+    std::vector<float> mPlayer;
+    std::vector<float> mScore;
+    std::vector<float> mReward;
+    std::vector<Uint8> mDone;
+    std::vector<Uint8> mWin;
+    std::vector<Uint8> mLose;
+    std::vector<Uint32> mEpisodeTicks;
+    std::vector<Uint32> mEpisodes;
+};
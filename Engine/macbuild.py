@@ -15,7 +15,7 @@ SOURCE = "./src/*.cpp"
 
 # You can can add other arguments as you see fit.
 # What does the "-D MAC" command do?
-ARGUMENTS = "-D MAC -std=c++17 -shared -undefined dynamic_lookup"
+ARGUMENTS = "-D MAC -std=c++20 -O2 -shared -undefined dynamic_lookup"
 
 # Which directories do we want to include.
 INCLUDE_DIR = "-I ./include/ -I./pybind11/include/ -I/Library/Frameworks/SDL2.framework/Headers `python3.12 -m pybind11 --includes`"
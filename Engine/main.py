@@ -39,7 +39,7 @@ class MapEditor:
                                 width=self.canvas_width,
                                 height=self.canvas_height)
         self.canvas.pack(fill=tk.BOTH, expand=True)
-        self.background_image = tk.PhotoImage(file="assets/scene.png")
+        self.background_image = tk.PhotoImage(file="Assets/scene.png")
         self.canvas.create_image(0,
                                  0,
                                  anchor=tk.NW,
@@ -116,7 +116,7 @@ class MapEditor:
         \param tag An optional unique identifier for the enemy. If none is provided, an id is generated.
         """
         self.enemy_id += 1
-        enemy_image = tk.PhotoImage(file="assets/enemy.png")
+        enemy_image = tk.PhotoImage(file="Assets/enemy.png")
         if tag is None:
             tag = "enemy" + str(self.enemy_id)
         item = self.canvas.create_image(x,
@@ -139,7 +139,7 @@ class MapEditor:
         \param tag An optional unique identifier for the food. If none is provided, an id is generated.
         """
         self.food_id += 1
-        food_image = tk.PhotoImage(file="assets/food.png")
+        food_image = tk.PhotoImage(file="Assets/food.png")
         if tag is None:
             tag = "food" + str(self.food_id)
         item = self.canvas.create_image(x,
@@ -0,0 +1,259 @@
+import argparse
+import os
+import struct
+import zlib
+
+MAGIC = b"GEPK"
+VERSION = 1
+ALIGNMENT = 64
+FLAG_LZ4 = 1
+HEADER = struct.Struct("<4sIIIQQ")
+ENTRY = struct.Struct("<QQIIIHH")
+
+# File types the engine loads; PNGs are converted to BMP because SDL_LoadBMP is all the engine decodes
+PACKED_EXTENSIONS = (".bmp", ".wav", ".anim")
+
+
+def normalize(name):
+    """
+    \brief Normalizes a file name the way AssetPack does: lowercase with forward slashes.
+    """
+    return name.replace("\\", "/").lower()
+
+
+def fnv1a(name):
+    """
+    \brief 64-bit FNV-1a of a normalized name; 0 marks empty slots, so it is never returned.
+    """
+    h = 14695981039346656037
+    for byte in name.encode("utf-8"):
+        h ^= byte
+        h = (h * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return h or 1
+
+
+def lz4_compress(data):
+    """
+    \brief Compresses data into a single LZ4 block with a greedy hash-chain-free matcher.
+    \param data The bytes to compress.
+    \return The block, which AssetPack::DecompressLZ4 expands again.
+
+    Follows the end-of-block rules of the format: the last 5 bytes are always literals and no match starts in the
+    last 12 bytes.
+    """
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+    match_limit = n - 12
+
+    def write_length(length):
+        while length >= 255:
+            out.append(255)
+            length -= 255
+        out.append(length)
+
+    def emit(literal_end, offset, match_length):
+        literals = literal_end - anchor
+        token_match = 0 if match_length is None else min(match_length - 4, 15)
+        out.append((min(literals, 15) << 4) | token_match)
+        if literals >= 15:
+            write_length(literals - 15)
+        out.extend(data[anchor:literal_end])
+        if match_length is not None:
+            out.extend(struct.pack("<H", offset))
+            if match_length - 4 >= 15:
+                write_length(match_length - 4 - 15)
+
+    while i < match_limit:
+        key = data[i:i + 4]
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is None or i - candidate > 65535:
+            i += 1
+            continue
+        # Extend the match 64 bytes at a time, then byte by byte, stopping 5 bytes before the end
+        length = 4
+        max_length = n - 5 - i
+        while length + 64 <= max_length and data[candidate + length:candidate + length + 64] == data[i + length:i + length + 64]:
+            length += 64
+        while length < max_length and data[candidate + length] == data[i + length]:
+            length += 1
+        emit(i, i - candidate, length)
+        i += length
+        anchor = i
+    emit(n, 0, None)
+    return bytes(out)
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def png_to_bmp(png):
+    """
+    \brief Converts an 8-bit RGB or RGBA, non-interlaced PNG to a 32-bit BMP with an alpha mask.
+    \param png The bytes of the PNG file.
+    \return The bytes of the BMP file, which SDL_LoadBMP loads with its alpha channel.
+    """
+    if png[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG file")
+    pos = 8
+    idat = bytearray()
+    width = height = 0
+    while pos < len(png):
+        length, kind = struct.unpack(">I4s", png[pos:pos + 8])
+        body = png[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", body)
+            if depth != 8 or color not in (2, 6) or interlace != 0:
+                raise ValueError("only 8-bit RGB/RGBA non-interlaced PNGs are supported")
+            channels = 4 if color == 6 else 3
+        elif kind == b"IDAT":
+            idat.extend(body)
+        elif kind == b"IEND":
+            break
+
+    raw = zlib.decompress(bytes(idat))
+    stride = width * channels
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        kind = raw[start]
+        row = bytearray(raw[start + 1:start + 1 + stride])
+        for x in range(stride):
+            left = row[x - channels] if x >= channels else 0
+            up = previous[x]
+            upper_left = previous[x - channels] if x >= channels else 0
+            if kind == 1:
+                row[x] = (row[x] + left) & 255
+            elif kind == 2:
+                row[x] = (row[x] + up) & 255
+            elif kind == 3:
+                row[x] = (row[x] + ((left + up) >> 1)) & 255
+            elif kind == 4:
+                row[x] = (row[x] + paeth(left, up, upper_left)) & 255
+        rows.append(row)
+        previous = row
+
+    # Bottom-up BGRA rows behind a BITMAPV4HEADER carrying the channel masks
+    pixels = bytearray()
+    for row in reversed(rows):
+        for x in range(width):
+            r, g, b = row[x * channels:x * channels + 3]
+            a = row[x * channels + 3] if channels == 4 else 255
+            pixels.extend((b, g, r, a))
+    info = struct.pack("<IiiHHIIiiII", 108, width, height, 1, 32, 3, len(pixels), 2835, 2835, 0, 0)
+    info += struct.pack("<IIII", 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000)
+    info += struct.pack("<I", 0x73524742) + bytes(36) + bytes(12)
+    offset = 14 + len(info)
+    return struct.pack("<2sIHHI", b"BM", offset + len(pixels), 0, 0, offset) + info + bytes(pixels)
+
+
+def collect(source_dir, prefix, exclude):
+    """
+    \brief Gathers the files to pack as (name, bytes), named the way the engine asks for them.
+    """
+    files = {}
+    for file_name in sorted(os.listdir(source_dir)):
+        path = os.path.join(source_dir, file_name)
+        if not os.path.isfile(path) or file_name.lower() in exclude:
+            continue
+        stem, extension = os.path.splitext(file_name)
+        extension = extension.lower()
+        with open(path, "rb") as f:
+            data = f.read()
+        if extension in PACKED_EXTENSIONS:
+            files[normalize(prefix + file_name)] = data
+        elif extension == ".png":
+            name = normalize(prefix + stem + ".bmp")
+            # A BMP of the same name takes precedence over a converted PNG
+            files.setdefault(name, png_to_bmp(data))
+    return sorted(files.items())
+
+
+def write_pack(path, files, compress):
+    """
+    \brief Writes the header, the entry table, the names and the 64-byte aligned blobs.
+    \return The pack size and the total size of the original files.
+    """
+    slot_count = 8
+    while slot_count < len(files) * 2:
+        slot_count *= 2
+    names = bytearray()
+    slots = [None] * slot_count
+    blobs = []
+    names_offset = HEADER.size + slot_count * ENTRY.size
+    for name, _ in files:
+        names.extend(name.encode("utf-8"))
+    offset = names_offset + len(names)
+
+    name_offset = 0
+    for name, data in files:
+        stored, flags = data, 0
+        if compress:
+            packed = lz4_compress(data)
+            if len(packed) < len(data):
+                stored, flags = packed, FLAG_LZ4
+        offset = (offset + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+        blobs.append((offset, stored))
+        h = fnv1a(name)
+        slot = h & (slot_count - 1)
+        while slots[slot] is not None:
+            slot = (slot + 1) & (slot_count - 1)
+        encoded = name.encode("utf-8")
+        slots[slot] = ENTRY.pack(h, offset, len(data), len(stored), name_offset, len(encoded), flags)
+        name_offset += len(encoded)
+        offset += len(stored)
+
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, slot_count, len(files), names_offset, len(names)))
+        for slot in slots:
+            f.write(slot if slot is not None else bytes(ENTRY.size))
+        f.write(names)
+        for blob_offset, stored in blobs:
+            f.write(bytes(blob_offset - f.tell()))
+            f.write(stored)
+        size = f.tell()
+    return size, sum(len(data) for _, data in files)
+
+
+def main():
+    """
+    \brief Packs the engine's assets into a single file that AssetPack maps at startup.
+    """
+    parser = argparse.ArgumentParser(description="Build the memory-mapped asset pack")
+    parser.add_argument("--source", default="Assets", help="directory holding the loose assets")
+    parser.add_argument("--prefix", default="assets/", help="path the engine refers to the directory by")
+    parser.add_argument("--output", default="assets.pack")
+    parser.add_argument("--exclude", nargs="*", default=["scene.png"],
+                        help="files the engine never loads, e.g. the level editor's background")
+    parser.add_argument("--compress", action="store_true",
+                        help="store entries as LZ4 blocks where that makes them smaller")
+    parser.add_argument("--export-bmp", action="store_true",
+                        help="also write the BMPs converted from PNGs next to the sources")
+    args = parser.parse_args()
+
+    files = collect(args.source, args.prefix, {name.lower() for name in args.exclude})
+    if args.export_bmp:
+        for name, data in files:
+            target = os.path.join(args.source, os.path.basename(name))
+            if name.endswith(".bmp") and not any(os.path.basename(name) == f.lower() for f in os.listdir(args.source)):
+                with open(target, "wb") as f:
+                    f.write(data)
+                print("wrote", target)
+    size, original = write_pack(args.output, files, args.compress)
+    for name, data in files:
+        print(f"  {name:28} {len(data):9} bytes")
+    print(f"{args.output}: {len(files)} files, {size} bytes ({original} bytes loose)")
+
+
+if __name__ == "__main__":
+    main()
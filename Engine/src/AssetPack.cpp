@@ -0,0 +1,300 @@
+#include "AssetPack.h"
+#include "Logger.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool AssetPack::Mount(const std::string &path)
+{
+    Unmount();
+
+    // Map the whole file read-only; pages are only read from disk when an entry is first touched
+    const Uint8 *base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    base = static_cast<const Uint8 *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (base == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    mFile = file;
+    mMapping = mapping;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive on its own
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+    base = static_cast<const Uint8 *>(mapped);
+#endif
+    mBase = base;
+    mSize = size;
+
+    // Check everything lookups rely on once, so Open only has to trust the table
+    Header header;
+    if (size < sizeof(Header))
+    {
+        LOG_ERROR("Asset pack %s is truncated", path);
+        Unmount();
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(Header));
+    Uint64 tableEnd = sizeof(Header) + static_cast<Uint64>(header.slotCount) * sizeof(Entry);
+    if (std::memcmp(header.magic, "GEPK", 4) != 0 || header.version != kVersion || header.slotCount == 0 ||
+        (header.slotCount & (header.slotCount - 1)) != 0 || header.entryCount >= header.slotCount || tableEnd > size ||
+        header.namesOffset < tableEnd || header.namesOffset > size || header.namesSize > size - header.namesOffset)
+    {
+        LOG_ERROR("Asset pack %s has a bad header", path);
+        Unmount();
+        return false;
+    }
+    mEntries = reinterpret_cast<const Entry *>(base + sizeof(Header));
+    mNames = reinterpret_cast<const char *>(base + header.namesOffset);
+    mSlotCount = header.slotCount;
+    mEntryCount = header.entryCount;
+    Uint32 used = 0;
+    for (Uint32 i = 0; i < mSlotCount; i++)
+    {
+        const Entry &entry = mEntries[i];
+        if (entry.hash == 0)
+        {
+            continue;
+        }
+        used++;
+        bool compressed = (entry.flags & kFlagLZ4) != 0;
+        if (entry.offset > size || entry.storedSize > size - entry.offset || entry.nameOffset > header.namesSize ||
+            entry.nameLength > header.namesSize - entry.nameOffset || (!compressed && entry.storedSize != entry.size))
+        {
+            LOG_ERROR("Asset pack %s has a bad entry in slot %u", path, i);
+            Unmount();
+            return false;
+        }
+    }
+    // Find stops at the first empty slot, so a full table would make it probe forever
+    if (used != mEntryCount || used >= mSlotCount)
+    {
+        LOG_ERROR("Asset pack %s has %u used slots but claims %u files", path, used, mEntryCount);
+        Unmount();
+        return false;
+    }
+
+    LOG_INFO("Mounted asset pack %s: %u files, %zu bytes", path, mEntryCount, mSize);
+    return true;
+}
+
+void AssetPack::Unmount()
+{
+    if (mBase == nullptr)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(mBase);
+    CloseHandle(static_cast<HANDLE>(mMapping));
+    CloseHandle(static_cast<HANDLE>(mFile));
+    mMapping = nullptr;
+    mFile = nullptr;
+#else
+    munmap(const_cast<Uint8 *>(mBase), mSize);
+#endif
+    mBase = nullptr;
+    mSize = 0;
+    mEntries = nullptr;
+    mNames = nullptr;
+    mSlotCount = 0;
+    mEntryCount = 0;
+}
+
+bool AssetPack::Contains(const std::string &name) const
+{
+    return Find(name) != nullptr;
+}
+
+SDL_RWops *AssetPack::Open(const std::string &name, std::vector<Uint8> &scratch) const
+{
+    const Entry *entry = Find(name);
+    if (entry == nullptr)
+    {
+        return nullptr;
+    }
+    const Uint8 *stored = mBase + entry->offset;
+    if ((entry->flags & kFlagLZ4) == 0)
+    {
+        return SDL_RWFromConstMem(stored, static_cast<int>(entry->size));
+    }
+
+    scratch.resize(entry->size);
+    if (!DecompressLZ4(stored, entry->storedSize, scratch.data(), scratch.size()))
+    {
+        LOG_ERROR("Asset pack entry %s is corrupt", name);
+        return nullptr;
+    }
+    return SDL_RWFromConstMem(scratch.data(), static_cast<int>(scratch.size()));
+}
+
+Uint64 AssetPack::Hash(const std::string &name)
+{
+    // 64-bit FNV-1a; 0 marks empty slots, so it is never returned
+    Uint64 hash = 14695981039346656037ull;
+    for (char c : Normalize(name))
+    {
+        hash ^= static_cast<Uint8>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+bool AssetPack::DecompressLZ4(const Uint8 *source, size_t sourceSize, Uint8 *destination, size_t destinationSize)
+{
+    const Uint8 *in = source;
+    const Uint8 *inEnd = source + sourceSize;
+    Uint8 *out = destination;
+    Uint8 *outEnd = destination + destinationSize;
+
+    // Lengths of 15 continue in the following bytes, 255 at a time
+    auto readLength = [&](size_t length) -> size_t
+    {
+        if (length != 15)
+        {
+            return length;
+        }
+        Uint8 byte;
+        do
+        {
+            if (in >= inEnd)
+            {
+                return SIZE_MAX;
+            }
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return length;
+    };
+
+    while (in < inEnd)
+    {
+        Uint8 token = *in++;
+
+        size_t literals = readLength(token >> 4);
+        if (literals == SIZE_MAX || literals > static_cast<size_t>(inEnd - in) || literals > static_cast<size_t>(outEnd - out))
+        {
+            return false;
+        }
+        std::memcpy(out, in, literals);
+        in += literals;
+        out += literals;
+
+        // The last sequence has literals only
+        if (in == inEnd)
+        {
+            break;
+        }
+
+        if (inEnd - in < 2)
+        {
+            return false;
+        }
+        size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t match = readLength(token & 15);
+        if (match == SIZE_MAX || offset == 0 || offset > static_cast<size_t>(out - destination))
+        {
+            return false;
+        }
+        match += 4;
+        if (match > static_cast<size_t>(outEnd - out))
+        {
+            return false;
+        }
+        // Matches may overlap their own output, e.g. a run of one byte, so copy forward byte by byte
+        const Uint8 *from = out - offset;
+        for (size_t i = 0; i < match; i++)
+        {
+            out[i] = from[i];
+        }
+        out += match;
+    }
+    return out == outEnd;
+}
+
+std::string AssetPack::Normalize(const std::string &name)
+{
+    std::string normalized(name);
+    for (char &c : normalized)
+    {
+        if (c == '\\')
+        {
+            c = '/';
+        }
+        else if (c >= 'A' && c <= 'Z')
+        {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return normalized;
+}
+
+const AssetPack::Entry *AssetPack::Find(const std::string &name) const
+{
+    if (mBase == nullptr)
+    {
+        return nullptr;
+    }
+    std::string normalized = Normalize(name);
+    Uint64 hash = Hash(normalized);
+    // Linear probing; the table always has an empty slot, so the walk ends
+    for (Uint32 slot = static_cast<Uint32>(hash) & (mSlotCount - 1);; slot = (slot + 1) & (mSlotCount - 1))
+    {
+        const Entry &entry = mEntries[slot];
+        if (entry.hash == 0)
+        {
+            return nullptr;
+        }
+        if (entry.hash == hash && entry.nameLength == normalized.size() &&
+            std::memcmp(mNames + entry.nameOffset, normalized.data(), normalized.size()) == 0)
+        {
+            return &entry;
+        }
+    }
+}
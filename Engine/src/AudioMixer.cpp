@@ -0,0 +1,293 @@
+#include "AudioMixer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+
+AudioMixer::AudioMixer()
+{
+    for (size_t i = 0; i < kQueueCapacity; i++)
+    {
+        mCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+AudioMixer &AudioMixer::GetInstance()
+{
+    static AudioMixer instance;
+    return instance;
+}
+
+int AudioMixer::StartUp(int frequency, int bufferFrames)
+{
+    if (mDevice != 0)
+    {
+        return 0;
+    }
+
+    SDL_AudioSpec desired;
+    SDL_zero(desired);
+    desired.freq = frequency;
+    desired.format = AUDIO_F32SYS;
+    desired.channels = 2;
+    desired.samples = static_cast<Uint16>(bufferFrames);
+    desired.callback = &AudioMixer::Callback;
+    desired.userdata = this;
+
+    // No allowed changes: SDL converts to whatever the device wants, so the callback always mixes stereo floats
+    SDL_AudioSpec obtained;
+    mDevice = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, 0);
+    if (mDevice == 0)
+    {
+        LOG_ERROR("Unable to open audio device: %s", SDL_GetError());
+        return -1;
+    }
+
+    mFrequency = obtained.freq;
+    mBufferMicros = 1000000.0f * obtained.samples / obtained.freq;
+    for (Voice &voice : mVoices)
+    {
+        voice = Voice{};
+    }
+    mMasterVolume = 1.0f;
+    mLastCallbackCounter = 0;
+    mCallbacks = 0;
+    mUnderruns = 0;
+    mDroppedCommands = 0;
+    mTotalMixCounter = 0;
+    mLastMixCounter = 0;
+    mMaxMixCounter = 0;
+
+    SDL_PauseAudioDevice(mDevice, 0);
+    LOG_INFO("AudioMixer started on %s: %d Hz, %d frames per buffer", SDL_GetCurrentAudioDriver(), obtained.freq,
+             static_cast<int>(obtained.samples));
+    return 0;
+}
+
+int AudioMixer::ShutDown()
+{
+    if (mDevice == 0)
+    {
+        return 0;
+    }
+
+    // Closing waits for a running callback to return
+    SDL_CloseAudioDevice(mDevice);
+    mDevice = 0;
+
+    AudioStats stats = GetStats();
+    LOG_INFO("AudioMixer shut down: %llu buffers, %llu underruns, mix %.1f us avg / %.1f us max of %.1f us",
+             static_cast<unsigned long long>(stats.callbacks), static_cast<unsigned long long>(stats.underruns),
+             stats.averageMixMicros, stats.maxMixMicros, stats.bufferMicros);
+
+    // Forget commands nobody will mix
+    Command command;
+    while (Pop(command))
+    {
+    }
+    return 0;
+}
+
+const SoundBuffer *AudioMixer::LoadSound(const std::string &filename)
+{
+    if (mDevice == 0)
+    {
+        return nullptr;
+    }
+    ResourceManager &manager = ResourceManager::GetInstance();
+    manager.LoadSound(filename, mFrequency);
+    return manager.GetSound(filename);
+}
+
+bool AudioMixer::Play(const SoundBuffer *sound, float volume, float pan)
+{
+    if (mDevice == 0 || sound == nullptr)
+    {
+        return false;
+    }
+    pan = std::max(-1.0f, std::min(1.0f, pan));
+    return Push(Command{CommandType::Play, sound, volume * std::min(1.0f, 1.0f - pan), volume * std::min(1.0f, 1.0f + pan)});
+}
+
+bool AudioMixer::StopAll()
+{
+    return mDevice != 0 && Push(Command{CommandType::StopAll, nullptr, 0.0f, 0.0f});
+}
+
+bool AudioMixer::SetMasterVolume(float volume)
+{
+    return mDevice != 0 && Push(Command{CommandType::SetMasterVolume, nullptr, volume, volume});
+}
+
+AudioStats AudioMixer::GetStats() const
+{
+    AudioStats stats;
+    double microsPerCount = 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    stats.callbacks = mCallbacks.load(std::memory_order_relaxed);
+    stats.underruns = mUnderruns.load(std::memory_order_relaxed);
+    stats.droppedCommands = mDroppedCommands.load(std::memory_order_relaxed);
+    stats.lastMixMicros = static_cast<float>(mLastMixCounter.load(std::memory_order_relaxed) * microsPerCount);
+    stats.maxMixMicros = static_cast<float>(mMaxMixCounter.load(std::memory_order_relaxed) * microsPerCount);
+    if (stats.callbacks > 0)
+    {
+        stats.averageMixMicros = static_cast<float>(mTotalMixCounter.load(std::memory_order_relaxed) * microsPerCount / stats.callbacks);
+    }
+    stats.bufferMicros = mBufferMicros;
+    stats.activeVoices = mActiveVoices.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioMixer::Callback(void *userdata, Uint8 *stream, int length)
+{
+    AudioMixer *mixer = static_cast<AudioMixer *>(userdata);
+    Uint64 start = SDL_GetPerformanceCounter();
+    double countsPerMicro = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000000.0;
+    Uint64 deadline = static_cast<Uint64>(mixer->mBufferMicros * countsPerMicro);
+
+    // A callback arriving much later than one buffer after the previous one means the device ran dry in between
+    if (mixer->mLastCallbackCounter != 0 && start - mixer->mLastCallbackCounter > deadline + deadline / 2)
+    {
+        mixer->mUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    mixer->mLastCallbackCounter = start;
+
+    mixer->Mix(reinterpret_cast<float *>(stream), length / static_cast<int>(2 * sizeof(float)));
+
+    Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+    if (elapsed > deadline)
+    {
+        mixer->mUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    mixer->mCallbacks.fetch_add(1, std::memory_order_relaxed);
+    mixer->mTotalMixCounter.fetch_add(elapsed, std::memory_order_relaxed);
+    mixer->mLastMixCounter.store(elapsed, std::memory_order_relaxed);
+    if (elapsed > mixer->mMaxMixCounter.load(std::memory_order_relaxed))
+    {
+        mixer->mMaxMixCounter.store(elapsed, std::memory_order_relaxed);
+    }
+}
+
+void AudioMixer::Mix(float *out, int frames)
+{
+    Command command;
+    while (Pop(command))
+    {
+        Apply(command);
+    }
+
+    std::memset(out, 0, static_cast<size_t>(frames) * 2 * sizeof(float));
+    int active = 0;
+    for (Voice &voice : mVoices)
+    {
+        if (voice.sound == nullptr)
+        {
+            continue;
+        }
+        const float *samples = voice.sound->samples.data() + voice.position * 2;
+        size_t count = std::min(static_cast<size_t>(frames), voice.sound->GetFrameCount() - voice.position);
+        float left = voice.left * mMasterVolume;
+        float right = voice.right * mMasterVolume;
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i * 2] += samples[i * 2] * left;
+            out[i * 2 + 1] += samples[i * 2 + 1] * right;
+        }
+        voice.position += count;
+        if (voice.position >= voice.sound->GetFrameCount())
+        {
+            voice.sound = nullptr;
+        }
+        else
+        {
+            active++;
+        }
+    }
+
+    for (int i = 0; i < frames * 2; i++)
+    {
+        out[i] = std::max(-1.0f, std::min(1.0f, out[i]));
+    }
+    mActiveVoices.store(active, std::memory_order_relaxed);
+}
+
+void AudioMixer::Apply(const Command &command)
+{
+    switch (command.type)
+    {
+    case CommandType::Play:
+    {
+        // Take a free voice, or steal the one with the least left to play
+        Voice *target = &mVoices[0];
+        size_t leastLeft = static_cast<size_t>(-1);
+        for (Voice &voice : mVoices)
+        {
+            if (voice.sound == nullptr)
+            {
+                target = &voice;
+                break;
+            }
+            size_t left = voice.sound->GetFrameCount() - voice.position;
+            if (left < leastLeft)
+            {
+                leastLeft = left;
+                target = &voice;
+            }
+        }
+        *target = Voice{command.sound, 0, command.left, command.right};
+        break;
+    }
+    case CommandType::StopAll:
+        for (Voice &voice : mVoices)
+        {
+            voice.sound = nullptr;
+        }
+        break;
+    case CommandType::SetMasterVolume:
+        mMasterVolume = command.left;
+        break;
+    }
+}
+
+bool AudioMixer::Push(const Command &command)
+{
+    size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+        cell = &mCells[position & (kQueueCapacity - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0)
+        {
+            if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            mDroppedCommands.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+    cell->command = command;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool AudioMixer::Pop(Command &command)
+{
+    Cell *cell = &mCells[mDequeuePosition & (kQueueCapacity - 1)];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if (sequence != mDequeuePosition + 1)
+    {
+        return false;
+    }
+    command = cell->command;
+    cell->sequence.store(mDequeuePosition + kQueueCapacity, std::memory_order_release);
+    mDequeuePosition++;
+    return true;
+}
@@ -0,0 +1,196 @@
+#include "Logger.h"
+
+Logger::Logger()
+{
+    for (size_t i = 0; i < kCapacity; i++)
+    {
+        mRecords[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger &Logger::GetInstance()
+{
+    static Logger instance;
+    return instance;
+}
+
+Uint64 Logger::Now()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return static_cast<Uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+LogRecord *Logger::Acquire(size_t &pos)
+{
+    pos = mEnqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        LogRecord *record = &mRecords[pos & kMask];
+        size_t sequence = record->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0)
+        {
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                return record;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The consumer has not freed this slot yet: the ring is full
+            return nullptr;
+        }
+        else
+        {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::Publish(LogRecord *record, size_t pos)
+{
+    record->sequence.store(pos + 1, std::memory_order_release);
+}
+
+size_t Logger::Drain()
+{
+    size_t written = 0;
+    char message[512];
+    for (;;)
+    {
+        LogRecord &record = mRecords[mDequeuePos & kMask];
+        if (record.sequence.load(std::memory_order_acquire) != mDequeuePos + 1)
+        {
+            break;
+        }
+        record.formatter(record, message, sizeof(message));
+        Write(record.level, record.timestampNs, message);
+        record.sequence.store(mDequeuePos + kCapacity, std::memory_order_release);
+        mDequeuePos++;
+        written++;
+    }
+
+    static Uint64 reportedDrops = 0;
+    Uint64 dropped = mDropped.load(std::memory_order_relaxed);
+    if (dropped != reportedDrops)
+    {
+        std::snprintf(message, sizeof(message), "Logger ring full, %llu message(s) dropped", static_cast<unsigned long long>(dropped - reportedDrops));
+        Write(LogLevel::Warn, Now(), message);
+        reportedDrops = dropped;
+        written++;
+    }
+
+    if (written > 0)
+    {
+        std::fflush(stderr);
+    }
+    return written;
+}
+
+void Logger::Write(LogLevel level, Uint64 timestampNs, const char *message)
+{
+    static const char *const names[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+    std::fprintf(stderr, "[%10.4f] %-5s %s\n", timestampNs / 1e9, names[static_cast<int>(level)], message);
+}
+
+void Logger::FormatMessage(const LogRecord &record, char *out, size_t size)
+{
+    std::snprintf(out, size, "%s", reinterpret_cast<const char *>(record.payload));
+}
+
+void Logger::SDLOutput(void *userdata, int /*category*/, SDL_LogPriority priority, const char *message)
+{
+    Logger *logger = static_cast<Logger *>(userdata);
+    LogLevel level = LogLevel::Info;
+    if (priority <= SDL_LOG_PRIORITY_DEBUG)
+    {
+        level = LogLevel::Debug;
+    }
+    else if (priority == SDL_LOG_PRIORITY_WARN)
+    {
+        level = LogLevel::Warn;
+    }
+    else if (priority >= SDL_LOG_PRIORITY_ERROR)
+    {
+        level = LogLevel::Error;
+    }
+
+    // SDL may still call in while ShutDown restores its previous output, so count the call like Log does
+    logger->mProducers.fetch_add(1, std::memory_order_seq_cst);
+    if (!logger->mRunning.load(std::memory_order_seq_cst))
+    {
+        logger->mProducers.fetch_sub(1, std::memory_order_release);
+        Write(level, Now(), message);
+        return;
+    }
+
+    size_t pos;
+    LogRecord *record = logger->Acquire(pos);
+    if (record == nullptr)
+    {
+        logger->mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        // SDL has already formatted the text, so the record carries a plain copy of it
+        record->level = level;
+        record->timestampNs = Now();
+        record->format = nullptr;
+        record->formatter = &Logger::FormatMessage;
+        char *text = reinterpret_cast<char *>(record->payload);
+        std::strncpy(text, message, LogRecord::kPayloadSize - 1);
+        text[LogRecord::kPayloadSize - 1] = '\0';
+        logger->Publish(record, pos);
+    }
+    logger->mProducers.fetch_sub(1, std::memory_order_release);
+}
+
+void Logger::Run()
+{
+    while (mRunning.load(std::memory_order_acquire))
+    {
+        if (Drain() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    Drain();
+}
+
+int Logger::StartUp()
+{
+    if (mRunning.load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+
+    SDL_LogGetOutputFunction(&mPreviousOutput, &mPreviousUserdata);
+    SDL_LogSetOutputFunction(&Logger::SDLOutput, this);
+
+    mRunning.store(true, std::memory_order_release);
+    mThread = std::thread(&Logger::Run, this);
+    return 0;
+}
+
+int Logger::ShutDown()
+{
+    if (!mRunning.load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+
+    SDL_LogSetOutputFunction(mPreviousOutput, mPreviousUserdata);
+    mRunning.store(false, std::memory_order_seq_cst);
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    // Calls that saw mRunning before the store may still be filling their slot, where the thread's last Drain stopped;
+    // later calls write synchronously, so once these are done nothing is left behind for the next StartUp
+    while (mProducers.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+    Drain();
+    return 0;
+}
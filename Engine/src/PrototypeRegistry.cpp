@@ -0,0 +1,66 @@
+#include "PrototypeRegistry.h"
+#include "ResourceManager.h"
+#include "Logger.h"
+
+PrototypeRegistry::PrototypeRegistry() {}
+
+PrototypeRegistry &PrototypeRegistry::GetInstance()
+{
+    static PrototypeRegistry instance;
+    return instance;
+}
+
+Uint16 PrototypeRegistry::Register(const std::string &name, SDL_Renderer *renderer, const std::string &image_filename, float width, float height, Uint32 flags)
+{
+    ResourceManager &manager = ResourceManager::GetInstance();
+    auto it = indices.find(name);
+    if (it != indices.end())
+    {
+        // A prototype registered by a headless scene has no texture yet; resolve it now that there is a renderer
+        SpritePrototype &existing = prototypes[it->second];
+        if (existing.texture == nullptr && renderer != nullptr)
+        {
+            manager.LoadResource(renderer, image_filename);
+            existing.texture = manager.GetResource(image_filename);
+        }
+        return it->second;
+    }
+
+    if (manager.GetResource(image_filename) == nullptr)
+    {
+        manager.LoadResource(renderer, image_filename);
+    }
+
+    SpritePrototype prototype;
+    prototype.name = name;
+    prototype.texture = manager.GetResource(image_filename);
+    prototype.width = width;
+    prototype.height = height;
+    prototype.collisionBox = SDL_FRect{0.0f, 0.0f, width, height};
+    prototype.flags = flags;
+    if (prototype.texture == nullptr && renderer != nullptr)
+    {
+        LOG_WARN("Failed to load texture for prototype %s: %s", name, image_filename);
+    }
+
+    Uint16 index = static_cast<Uint16>(prototypes.size());
+    prototypes.push_back(prototype);
+    indices[name] = index;
+    return index;
+}
+
+int PrototypeRegistry::Find(const std::string &name) const
+{
+    auto it = indices.find(name);
+    if (it != indices.end())
+    {
+        return it->second;
+    }
+    return -1;
+}
+
+void PrototypeRegistry::Clear()
+{
+    prototypes.clear();
+    indices.clear();
+}
@@ -1,6 +1,7 @@
 #include "ResourceManager.h"
+#include "Logger.h"
+#include "RenderThread.h"
 #include <SDL2/SDL.h>
-#include <iostream>
 
 ResourceManager::ResourceManager() {}
 
@@ -13,60 +14,239 @@ ResourceManager &ResourceManager::GetInstance()
 void ResourceManager::LoadResource(SDL_Renderer *renderer, const std::string &image_filename)
 {
     // Check if the resource is already loaded
-    if (resources.find(image_filename) != resources.end())
+    if (resources.Find(image_filename) != nullptr)
     {
         return;
     }
 
-    // Load the image as a surface
-    SDL_Surface *surface = SDL_LoadBMP(image_filename.c_str());
+    // Headless scenes have no renderer to create textures for, so don't decode anything
+    if (renderer == nullptr && mRenderThread == nullptr)
+    {
+        return;
+    }
+
+    // Decode on this thread; only the upload goes to the render thread
+    const SDL_Surface *image = LoadImage(image_filename);
+    if (image)
+    {
+        LoadSurface(renderer, image_filename, const_cast<SDL_Surface *>(image));
+    }
+}
+
+const SDL_Surface *ResourceManager::LoadImage(const std::string &image_filename)
+{
+    if (SDL_Surface **image = images.Find(image_filename))
+    {
+        return *image;
+    }
+
+    // Load the image as a surface, straight from the mapped pack if it has it
+    std::vector<Uint8> scratch;
+    SDL_RWops *stream = OpenAsset(image_filename, scratch);
+    SDL_Surface *surface = stream ? SDL_LoadBMP_RW(stream, 1) : nullptr;
     if (!surface)
     {
-        std::cerr << "Failed to load image: " << SDL_GetError() << std::endl;
+        LOG_ERROR("Failed to load image %s: %s", image_filename, SDL_GetError());
+        return nullptr;
+    }
+
+    auto inserted = images.Insert(image_filename, std::move(surface));
+    if (!inserted.second)
+    {
+        // Another thread decoded it first
+        SDL_FreeSurface(surface);
+    }
+    return *inserted.first;
+}
+
+const SDL_Surface *ResourceManager::GetImage(const std::string &key) const
+{
+    SDL_Surface *const *image = images.Find(key);
+    return image ? *image : nullptr;
+}
+
+void ResourceManager::LoadSurface(SDL_Renderer *renderer, const std::string &key, SDL_Surface *surface)
+{
+    if (resources.Find(key) != nullptr)
+    {
         return;
     }
 
-    // Convert the surface to a texture
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+    // Convert the surface to a texture, on the thread that owns the renderer
+    SDL_Texture *texture = nullptr;
+    if (mRenderThread)
+    {
+        mRenderThread->Execute([&](SDL_Renderer *owner)
+                               { texture = SDL_CreateTextureFromSurface(owner, surface); });
+    }
+    else if (renderer)
+    {
+        texture = SDL_CreateTextureFromSurface(renderer, surface);
+    }
 
     if (!texture)
     {
         return;
     }
 
-    // Store the texture in the resource map
-    resources[image_filename] = texture;
+    // Store the texture in the resource map, unless another thread created one for the key meanwhile
+    SDL_Texture *created = texture;
+    if (resources.Insert(key, std::move(texture)).second)
+    {
+        // Keep the pixels on the CPU side too; textures from files already have theirs in images
+        const SDL_Surface *image = GetImage(key);
+        if (image == nullptr)
+        {
+            SDL_Surface *copy = SDL_DuplicateSurface(surface);
+            if (copy && !images.Insert(key, std::move(copy)).second)
+            {
+                SDL_FreeSurface(copy);
+            }
+            image = GetImage(key);
+        }
+        textureImages.Insert(created, std::move(image));
+    }
+    else
+    {
+        if (mRenderThread)
+        {
+            mRenderThread->Execute([texture](SDL_Renderer *)
+                                   { SDL_DestroyTexture(texture); });
+        }
+        else
+        {
+            SDL_DestroyTexture(texture);
+        }
+    }
 }
 
-SDL_Texture *ResourceManager::GetResource(const std::string &key)
+const SDL_Surface *ResourceManager::GetTextureImage(SDL_Texture *texture) const
 {
-    auto it = resources.find(key);
-    if (it != resources.end())
+    const SDL_Surface *const *image = textureImages.Find(texture);
+    return image ? *image : nullptr;
+}
+
+SDL_Texture *ResourceManager::GetResource(const std::string &key) const
+{
+    SDL_Texture *const *texture = resources.Find(key);
+    return texture ? *texture : nullptr;
+}
+
+void ResourceManager::LoadSound(const std::string &sound_filename, int frequency)
+{
+    if (sounds.Find(sound_filename) != nullptr)
     {
-        return it->second;
+        return;
     }
-    else
+
+    SDL_AudioSpec spec;
+    Uint8 *data = nullptr;
+    Uint32 length = 0;
+    std::vector<Uint8> scratch;
+    SDL_RWops *stream = OpenAsset(sound_filename, scratch);
+    if (stream == nullptr || SDL_LoadWAV_RW(stream, 1, &spec, &data, &length) == nullptr)
     {
-        return nullptr;
+        LOG_ERROR("Failed to load sound %s: %s", sound_filename, SDL_GetError());
+        return;
+    }
+
+    // Convert to the mixer's format here, so the audio callback only ever adds floats
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, AUDIO_F32SYS, 2, frequency) < 0)
+    {
+        LOG_ERROR("Cannot convert sound %s: %s", sound_filename, SDL_GetError());
+        SDL_FreeWAV(data);
+        return;
     }
+    std::vector<Uint8> converted(static_cast<size_t>(length) * (cvt.len_mult > 0 ? cvt.len_mult : 1));
+    SDL_memcpy(converted.data(), data, length);
+    SDL_FreeWAV(data);
+    cvt.buf = converted.data();
+    cvt.len = static_cast<int>(length);
+    cvt.len_cvt = cvt.len;
+    if (cvt.needed && SDL_ConvertAudio(&cvt) < 0)
+    {
+        LOG_ERROR("Cannot convert sound %s: %s", sound_filename, SDL_GetError());
+        return;
+    }
+
+    // Fill the buffer before publishing it; if another thread loaded the sound meanwhile, this copy is dropped
+    SoundBuffer sound;
+    sound.frequency = frequency;
+    sound.samples.resize(static_cast<size_t>(cvt.len_cvt) / (2 * sizeof(float)) * 2);
+    SDL_memcpy(sound.samples.data(), converted.data(), sound.samples.size() * sizeof(float));
+    sounds.Insert(sound_filename, std::move(sound));
+}
+
+const SoundBuffer *ResourceManager::GetSound(const std::string &key) const
+{
+    return sounds.Find(key);
+}
+
+SDL_RWops *ResourceManager::OpenAsset(const std::string &filename, std::vector<Uint8> &scratch)
+{
+    SDL_RWops *stream = pack.Open(filename, scratch);
+    if (stream)
+    {
+        return stream;
+    }
+    stream = SDL_RWFromFile(filename.c_str(), "rb");
+    if (stream == nullptr && filename.compare(0, 7, "assets/") == 0)
+    {
+        stream = SDL_RWFromFile(("Assets/" + filename.substr(7)).c_str(), "rb");
+    }
+    return stream;
+}
+
+bool ResourceManager::MountPack(const std::string &path)
+{
+    return pack.Mount(path);
+}
+
+const AssetPack &ResourceManager::GetPack() const
+{
+    return pack;
+}
+
+void ResourceManager::SetRenderThread(RenderThread *renderThread)
+{
+    mRenderThread = renderThread;
 }
 
 int ResourceManager::StartUp()
 {
-    SDL_Log("ResourceManager started successfully");
+    LOG_INFO("ResourceManager started successfully");
     return 0;
 }
 
 int ResourceManager::ShutDown()
 {
     // Destroy all textures and clear the resource map
-    for (auto &resource : resources)
+    auto destroyAll = [this](SDL_Renderer *)
+    {
+        resources.ForEach([](const std::string &, SDL_Texture *&texture)
+                          { SDL_DestroyTexture(texture); });
+        if (mRenderThread)
+        {
+            mRenderThread->ForgetTextures();
+        }
+    };
+    if (mRenderThread)
+    {
+        mRenderThread->Execute(destroyAll);
+    }
+    else
     {
-        SDL_DestroyTexture(resource.second);
+        destroyAll(nullptr);
     }
 
-    resources.clear();
-    SDL_Log("ResourceManager shut down successfully");
+    images.ForEach([](const std::string &, SDL_Surface *&surface)
+                   { SDL_FreeSurface(surface); });
+    resources.Clear();
+    textureImages.Clear();
+    images.Clear();
+    sounds.Clear();
+    pack.Unmount();
+    LOG_INFO("ResourceManager shut down successfully");
     return 0;
 }
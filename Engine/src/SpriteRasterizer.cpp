@@ -0,0 +1,572 @@
+#include "SpriteRasterizer.h"
+#include "ResourceManager.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RASTERIZER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RASTERIZER_TARGET(isa)
+#else
+#define RASTERIZER_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+#define RASTERIZER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    // All kernels blend with t = s * a + d * (255 - a) + 128 and divide by 255 as (t + (t >> 8)) >> 8, so every
+    // instruction set produces the same pixels. The framebuffer stays opaque.
+
+    inline Uint32 BlendPixel(Uint32 d, Uint32 s, Uint32 a)
+    {
+        Uint32 result = 0xFF000000u;
+        for (int shift = 0; shift < 24; shift += 8)
+        {
+            Uint32 t = ((s >> shift) & 0xFF) * a + ((d >> shift) & 0xFF) * (255 - a) + 128;
+            result |= ((t + (t >> 8)) >> 8) << shift;
+        }
+        return result;
+    }
+
+    inline Uint32 Mul255(Uint32 x, Uint32 y)
+    {
+        Uint32 t = x * y + 128;
+        return (t + (t >> 8)) >> 8;
+    }
+
+    void MaskedRowScalar(Uint32 *dst, const Uint32 *src, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (src[i] >> 24)
+            {
+                dst[i] = src[i] | 0xFF000000u;
+            }
+        }
+    }
+
+    void BlendRowScalar(Uint32 *dst, const Uint32 *src, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            Uint32 a = src[i] >> 24;
+            if (a == 255)
+            {
+                dst[i] = src[i];
+            }
+            else if (a != 0)
+            {
+                dst[i] = BlendPixel(dst[i], src[i], a);
+            }
+        }
+    }
+
+    /*!
+     * \brief Blends a row modulated by a color, as SDL does for vertex colors. Only used for text and particles.
+     */
+    void ModulatedRow(Uint32 *dst, const Uint32 *src, int count, SDL_Color color)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            Uint32 s = src[i];
+            Uint32 a = Mul255(s >> 24, color.a);
+            if (a == 0)
+            {
+                continue;
+            }
+            Uint32 modulated = Mul255((s >> 16) & 0xFF, color.r) << 16 | Mul255((s >> 8) & 0xFF, color.g) << 8 | Mul255(s & 0xFF, color.b);
+            dst[i] = BlendPixel(dst[i], modulated, a);
+        }
+    }
+
+    void FillRow(Uint32 *dst, int count, SDL_Color color)
+    {
+        Uint32 s = static_cast<Uint32>(color.r) << 16 | static_cast<Uint32>(color.g) << 8 | color.b;
+        if (color.a == 255)
+        {
+            std::fill(dst, dst + count, s | 0xFF000000u);
+            return;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            dst[i] = BlendPixel(dst[i], s, color.a);
+        }
+    }
+
+#ifdef RASTERIZER_X86
+    RASTERIZER_TARGET("sse4.1")
+    void MaskedRowSSE41(Uint32 *dst, const Uint32 *src, int count)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), _mm_setzero_si128());
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_blendv_epi8(_mm_or_si128(s, alpha), d, transparent));
+        }
+        MaskedRowScalar(dst + i, src + i, count - i);
+    }
+
+    RASTERIZER_TARGET("sse4.1")
+    inline __m128i BlendHalfSSE41(__m128i s, __m128i d, __m128i a)
+    {
+        __m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a))), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+
+    RASTERIZER_TARGET("sse4.1")
+    void BlendRowSSE41(Uint32 *dst, const Uint32 *src, int count)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        const __m128i zero = _mm_setzero_si128();
+        // Spread each pixel's alpha over its four 16-bit channel lanes
+        const __m128i spreadLow = _mm_setr_epi8(3, -1, 3, -1, 3, -1, 3, -1, 7, -1, 7, -1, 7, -1, 7, -1);
+        const __m128i spreadHigh = _mm_setr_epi8(11, -1, 11, -1, 11, -1, 11, -1, 15, -1, 15, -1, 15, -1, 15, -1);
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alpha), alpha));
+            if (opaque == 0xFFFF)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), s);
+                continue;
+            }
+            if (_mm_testz_si128(s, alpha))
+            {
+                continue;
+            }
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            __m128i low = BlendHalfSSE41(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), _mm_shuffle_epi8(s, spreadLow));
+            __m128i high = BlendHalfSSE41(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), _mm_shuffle_epi8(s, spreadHigh));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(_mm_packus_epi16(low, high), alpha));
+        }
+        BlendRowScalar(dst + i, src + i, count - i);
+    }
+
+    RASTERIZER_TARGET("avx2")
+    void MaskedRowAVX2(Uint32 *dst, const Uint32 *src, int count)
+    {
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+            __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha), _mm256_setzero_si256());
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_blendv_epi8(_mm256_or_si256(s, alpha), d, transparent));
+        }
+        MaskedRowScalar(dst + i, src + i, count - i);
+    }
+
+    RASTERIZER_TARGET("avx2")
+    inline __m256i BlendHalfAVX2(__m256i s, __m256i d, __m256i a)
+    {
+        __m256i t = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(255), a))),
+                                     _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    }
+
+    RASTERIZER_TARGET("avx2")
+    void BlendRowAVX2(Uint32 *dst, const Uint32 *src, int count)
+    {
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        const __m256i zero = _mm256_setzero_si256();
+        // Unpack and shuffle work within 128-bit lanes, so the same pattern serves both lanes
+        const __m256i spreadLow = _mm256_setr_epi8(3, -1, 3, -1, 3, -1, 3, -1, 7, -1, 7, -1, 7, -1, 7, -1,
+                                                   3, -1, 3, -1, 3, -1, 3, -1, 7, -1, 7, -1, 7, -1, 7, -1);
+        const __m256i spreadHigh = _mm256_setr_epi8(11, -1, 11, -1, 11, -1, 11, -1, 15, -1, 15, -1, 15, -1, 15, -1,
+                                                    11, -1, 11, -1, 11, -1, 11, -1, 15, -1, 15, -1, 15, -1, 15, -1);
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            unsigned opaque = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, alpha), alpha)));
+            if (opaque == 0xFFFFFFFFu)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), s);
+                continue;
+            }
+            if (_mm256_testz_si256(s, alpha))
+            {
+                continue;
+            }
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+            __m256i low = BlendHalfAVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), _mm256_shuffle_epi8(s, spreadLow));
+            __m256i high = BlendHalfAVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), _mm256_shuffle_epi8(s, spreadHigh));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(_mm256_packus_epi16(low, high), alpha));
+        }
+        BlendRowScalar(dst + i, src + i, count - i);
+    }
+
+    bool CpuSupports(const std::string &isa)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        int leaves = info[0];
+        __cpuid(info, 1);
+        if (isa != "avx2")
+        {
+            return (info[2] & (1 << 19)) != 0;
+        }
+        // AVX2 also needs the OS to save the ymm registers
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (leaves < 7 || !osxsave || (_xgetbv(0) & 6) != 6)
+        {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return isa == "avx2" ? __builtin_cpu_supports("avx2") != 0 : __builtin_cpu_supports("sse4.1") != 0;
+#endif
+    }
+#endif
+
+#ifdef RASTERIZER_NEON
+    void MaskedRowNEON(Uint32 *dst, const Uint32 *src, int count)
+    {
+        const uint32x4_t alpha = vdupq_n_u32(0xFF000000u);
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            uint32x4_t s = vld1q_u32(src + i);
+            uint32x4_t visible = vtstq_u32(s, alpha);
+            vst1q_u32(dst + i, vbslq_u32(visible, vorrq_u32(s, alpha), vld1q_u32(dst + i)));
+        }
+        MaskedRowScalar(dst + i, src + i, count - i);
+    }
+
+    inline uint8x8_t BlendChannelNEON(uint8x8_t s, uint8x8_t d, uint8x8_t a, uint8x8_t inverse)
+    {
+        uint16x8_t t = vaddq_u16(vmlal_u8(vmull_u8(s, a), d, inverse), vdupq_n_u16(128));
+        return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+    }
+
+    void BlendRowNEON(Uint32 *dst, const Uint32 *src, int count)
+    {
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            // Planes of b, g, r, a bytes
+            uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t *>(src + i));
+            uint64_t alphas = vget_lane_u64(vreinterpret_u64_u8(s.val[3]), 0);
+            if (alphas == ~0ull)
+            {
+                vst4_u8(reinterpret_cast<uint8_t *>(dst + i), s);
+                continue;
+            }
+            if (alphas == 0)
+            {
+                continue;
+            }
+            uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t *>(dst + i));
+            uint8x8_t inverse = vmvn_u8(s.val[3]);
+            for (int c = 0; c < 3; c++)
+            {
+                d.val[c] = BlendChannelNEON(s.val[c], d.val[c], s.val[3], inverse);
+            }
+            d.val[3] = vdup_n_u8(255);
+            vst4_u8(reinterpret_cast<uint8_t *>(dst + i), d);
+        }
+        BlendRowScalar(dst + i, src + i, count - i);
+    }
+#endif
+
+    struct Kernels
+    {
+        const char *name;
+        void (*masked)(Uint32 *dst, const Uint32 *src, int count);
+        void (*blend)(Uint32 *dst, const Uint32 *src, int count);
+    };
+
+    const Kernels kScalar{"scalar", MaskedRowScalar, BlendRowScalar};
+#ifdef RASTERIZER_X86
+    const Kernels kSSE41{"sse4.1", MaskedRowSSE41, BlendRowSSE41};
+    const Kernels kAVX2{"avx2", MaskedRowAVX2, BlendRowAVX2};
+#endif
+#ifdef RASTERIZER_NEON
+    const Kernels kNEON{"neon", MaskedRowNEON, BlendRowNEON};
+#endif
+
+    /*!
+     * \brief Finds kernels by name, or nullptr if the CPU or the build lacks them.
+     */
+    const Kernels *FindKernels(const std::string &name)
+    {
+#ifdef RASTERIZER_X86
+        if (name == "auto")
+        {
+            return CpuSupports("avx2") ? &kAVX2 : CpuSupports("sse4.1") ? &kSSE41 : &kScalar;
+        }
+        if (name == "avx2" || name == "sse4.1")
+        {
+            return CpuSupports(name) ? (name == "avx2" ? &kAVX2 : &kSSE41) : nullptr;
+        }
+#endif
+#ifdef RASTERIZER_NEON
+        if (name == "auto" || name == "neon")
+        {
+            return &kNEON;
+        }
+#endif
+        return name == "auto" || name == "scalar" ? &kScalar : nullptr;
+    }
+
+    std::atomic<const Kernels *> gKernels{FindKernels("auto")};
+}
+
+SpriteRasterizer::SpriteRasterizer(size_t threads, TextureResolver resolver)
+    : mPool(threads), mResolver(std::move(resolver))
+{
+    if (!mResolver)
+    {
+        mResolver = [](SDL_Texture *texture)
+        { return ResourceManager::GetInstance().GetTextureImage(texture); };
+    }
+}
+
+void SpriteRasterizer::Render(const FramePacket &packet, int width, int height, float scale, bool overlay)
+{
+    width = std::max(width, 0);
+    height = std::max(height, 0);
+    mWidth = width;
+    mHeight = height;
+    mPixels.resize(static_cast<size_t>(width) * height);
+    SDL_Color clear = packet.GetClearColor();
+    mClear = 0xFF000000u | static_cast<Uint32>(clear.r) << 16 | static_cast<Uint32>(clear.g) << 8 | clear.b;
+
+    // Resolve and transform every draw once; the bands only clip and fill
+    mDraws.clear();
+    AddSprites(packet, 0, packet.GetSceneSpriteCount(), scale);
+    AddBatches(packet, 0, packet.GetSceneBatchCount(), scale);
+    if (overlay)
+    {
+        AddSprites(packet, packet.GetSceneSpriteCount(), packet.GetSprites().size(), scale);
+        AddBatches(packet, packet.GetSceneBatchCount(), packet.GetBatches().size(), scale);
+    }
+
+    size_t bands = static_cast<size_t>((height + kBandRows - 1) / kBandRows);
+    mPool.ParallelFor(bands, [this](size_t begin, size_t end)
+                      {
+        for (size_t band = begin; band < end; band++)
+        {
+            int top = static_cast<int>(band) * kBandRows;
+            RasterizeBand(top, std::min(top + kBandRows, mHeight));
+        } });
+}
+
+void SpriteRasterizer::ClearTextures()
+{
+    mTextures.clear();
+}
+
+const char *SpriteRasterizer::GetKernelName()
+{
+    return gKernels.load()->name;
+}
+
+bool SpriteRasterizer::SelectKernels(const std::string &name)
+{
+    const Kernels *kernels = FindKernels(name);
+    if (kernels == nullptr)
+    {
+        return false;
+    }
+    gKernels.store(kernels);
+    return true;
+}
+
+const SpriteRasterizer::Texture *SpriteRasterizer::Resolve(SDL_Texture *handle)
+{
+    auto it = mTextures.find(handle);
+    if (it != mTextures.end())
+    {
+        return it->second.get();
+    }
+
+    // Converted once; textures whose pixels cannot be found are remembered as missing and skipped
+    std::unique_ptr<Texture> texture;
+    const SDL_Surface *image = handle ? mResolver(handle) : nullptr;
+    SDL_Surface *converted = image ? SDL_ConvertSurfaceFormat(const_cast<SDL_Surface *>(image), SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+    if (converted)
+    {
+        texture = std::make_unique<Texture>();
+        texture->width = converted->w;
+        texture->height = converted->h;
+        texture->pixels.resize(static_cast<size_t>(converted->w) * converted->h);
+        bool opaque = true;
+        bool binary = true;
+        SDL_LockSurface(converted);
+        for (int y = 0; y < converted->h; y++)
+        {
+            const Uint32 *row = reinterpret_cast<const Uint32 *>(static_cast<const Uint8 *>(converted->pixels) + y * converted->pitch);
+            std::memcpy(&texture->pixels[static_cast<size_t>(y) * converted->w], row, converted->w * sizeof(Uint32));
+            for (int x = 0; x < converted->w; x++)
+            {
+                Uint32 a = row[x] >> 24;
+                opaque = opaque && a == 255;
+                binary = binary && (a == 0 || a == 255);
+            }
+        }
+        SDL_UnlockSurface(converted);
+        SDL_FreeSurface(converted);
+        texture->kind = opaque ? TextureKind::Opaque : binary ? TextureKind::Masked : TextureKind::Blended;
+    }
+    const Texture *result = texture.get();
+    mTextures.emplace(handle, std::move(texture));
+    return result;
+}
+
+void SpriteRasterizer::AddSprites(const FramePacket &packet, size_t first, size_t end, float scale)
+{
+    const std::vector<SpriteDrawCommand> &sprites = packet.GetSprites();
+    for (size_t i = first; i < end; i++)
+    {
+        const SpriteDrawCommand &command = sprites[i];
+        const Texture *texture = Resolve(command.texture);
+        if (texture == nullptr)
+        {
+            continue;
+        }
+        SDL_Rect source = command.source.w > 0 ? command.source : SDL_Rect{0, 0, texture->width, texture->height};
+        const SDL_FRect &d = command.destination;
+        mDraws.push_back(Draw{texture, source, static_cast<int>(std::lround(d.x * scale)), static_cast<int>(std::lround(d.y * scale)),
+                              static_cast<int>(std::lround((d.x + d.w) * scale)), static_cast<int>(std::lround((d.y + d.h) * scale)),
+                              SDL_Color{255, 255, 255, 255}, false});
+    }
+}
+
+void SpriteRasterizer::AddBatches(const FramePacket &packet, size_t first, size_t end, float scale)
+{
+    const std::vector<GeometryBatch> &batches = packet.GetBatches();
+    for (size_t b = first; b < end; b++)
+    {
+        const GeometryBatch &batch = batches[b];
+        const Texture *texture = nullptr;
+        if (batch.texture)
+        {
+            texture = Resolve(batch.texture);
+            if (texture == nullptr)
+            {
+                continue;
+            }
+        }
+        const SDL_Vertex *vertex = packet.GetVertices() + batch.firstVertex;
+        for (size_t q = 0; q < batch.quadCount; q++, vertex += 4)
+        {
+            // Quads are axis-aligned: the first vertex is the top-left corner, the third the bottom-right
+            const SDL_Vertex &topLeft = vertex[0];
+            const SDL_Vertex &bottomRight = vertex[2];
+            SDL_Rect source{0, 0, 0, 0};
+            if (texture)
+            {
+                source.x = static_cast<int>(std::lround(topLeft.tex_coord.x * texture->width));
+                source.y = static_cast<int>(std::lround(topLeft.tex_coord.y * texture->height));
+                source.w = static_cast<int>(std::lround(bottomRight.tex_coord.x * texture->width)) - source.x;
+                source.h = static_cast<int>(std::lround(bottomRight.tex_coord.y * texture->height)) - source.y;
+                if (source.w <= 0 || source.h <= 0)
+                {
+                    continue;
+                }
+            }
+            SDL_Color color = topLeft.color;
+            bool modulated = color.r != 255 || color.g != 255 || color.b != 255 || color.a != 255;
+            mDraws.push_back(Draw{texture, source, static_cast<int>(std::lround(topLeft.position.x * scale)),
+                                  static_cast<int>(std::lround(topLeft.position.y * scale)), static_cast<int>(std::lround(bottomRight.position.x * scale)),
+                                  static_cast<int>(std::lround(bottomRight.position.y * scale)), color, modulated});
+        }
+    }
+}
+
+void SpriteRasterizer::RasterizeBand(int top, int bottom) const
+{
+    const Kernels &kernels = *gKernels.load(std::memory_order_relaxed);
+    thread_local std::vector<Uint32> gathered;
+    if (gathered.size() < static_cast<size_t>(mWidth))
+    {
+        gathered.resize(mWidth);
+    }
+
+    Uint32 *pixels = const_cast<Uint32 *>(mPixels.data());
+    std::fill(pixels + static_cast<size_t>(top) * mWidth, pixels + static_cast<size_t>(bottom) * mWidth, mClear);
+
+    for (const Draw &draw : mDraws)
+    {
+        int x0 = std::max(draw.x0, 0);
+        int x1 = std::min(draw.x1, mWidth);
+        int y0 = std::max(draw.y0, top);
+        int y1 = std::min(draw.y1, bottom);
+        if (x0 >= x1 || y0 >= y1)
+        {
+            continue;
+        }
+        int count = x1 - x0;
+
+        if (draw.texture == nullptr)
+        {
+            for (int y = y0; y < y1; y++)
+            {
+                FillRow(pixels + static_cast<size_t>(y) * mWidth + x0, count, draw.color);
+            }
+            continue;
+        }
+
+        // Sample the center of every destination pixel; without scaling the source row is used in place
+        Sint64 width = draw.x1 - draw.x0;
+        Sint64 height = draw.y1 - draw.y0;
+        bool unscaled = width == draw.source.w;
+        const Texture &texture = *draw.texture;
+        for (int y = y0; y < y1; y++)
+        {
+            int sy = draw.source.y + static_cast<int>(((2 * (y - draw.y0) + 1) * static_cast<Sint64>(draw.source.h)) / (2 * height));
+            if (sy < 0 || sy >= texture.height)
+            {
+                continue;
+            }
+            const Uint32 *sourceRow = texture.pixels.data() + static_cast<size_t>(sy) * texture.width;
+            const Uint32 *source;
+            if (unscaled && draw.source.x >= 0 && draw.source.x + draw.source.w <= texture.width)
+            {
+                source = sourceRow + draw.source.x + (x0 - draw.x0);
+            }
+            else
+            {
+                for (int x = x0; x < x1; x++)
+                {
+                    int sx = draw.source.x + static_cast<int>(((2 * (x - draw.x0) + 1) * static_cast<Sint64>(draw.source.w)) / (2 * width));
+                    gathered[x - x0] = sourceRow[std::clamp(sx, 0, texture.width - 1)];
+                }
+                source = gathered.data();
+            }
+
+            Uint32 *destination = pixels + static_cast<size_t>(y) * mWidth + x0;
+            if (draw.modulated)
+            {
+                ModulatedRow(destination, source, count, draw.color);
+            }
+            else if (texture.kind == TextureKind::Opaque)
+            {
+                std::memcpy(destination, source, count * sizeof(Uint32));
+            }
+            else if (texture.kind == TextureKind::Masked)
+            {
+                kernels.masked(destination, source, count);
+            }
+            else
+            {
+                kernels.blend(destination, source, count);
+            }
+        }
+    }
+}
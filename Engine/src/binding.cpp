@@ -1,12 +1,733 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
 #include "Application.hpp"
+#include "ResourceIndex.h"
 #include "ResourceManager.h"
+#include "SpriteRasterizer.h"
+#include "TimerWheel.h"
+#include "VectorEnv.h"
 
 namespace py = pybind11;
 
+namespace
+{
+    /*!
+     * \brief Looks up an instance group of the current scene, raising KeyError if it does not exist.
+     */
+    SpriteInstances &GetGroup(Application &app, const std::string &group)
+    {
+        SpriteInstances *instances = app.GetInstances(group);
+        if (instances == nullptr)
+        {
+            throw py::key_error("Unknown entity group: " + group);
+        }
+        return *instances;
+    }
+
+    /*!
+     * \brief Gets the scene graph of the current scene, raising RuntimeError if there is none.
+     */
+    SceneGraph &GetGraph(Application &app)
+    {
+        SceneGraph *graph = app.GetSceneGraph();
+        if (graph == nullptr)
+        {
+            throw std::runtime_error("No scene");
+        }
+        return *graph;
+    }
+
+    /*!
+     * \brief Looks up a node of the current scene graph, raising KeyError if it does not exist.
+     */
+    Uint32 GetNode(SceneGraph &graph, Uint32 node)
+    {
+        if (!graph.IsAlive(node))
+        {
+            throw py::key_error("Unknown scene graph node: " + std::to_string(node));
+        }
+        return node;
+    }
+
+    /*!
+     * \brief Looks up a particle emitter of the current scene, raising KeyError if it does not exist.
+     */
+    size_t GetEmitter(Application &app, const std::string &emitter)
+    {
+        int index = app.GetEmitter(emitter);
+        if (index < 0 || app.GetParticles() == nullptr)
+        {
+            throw py::key_error("Unknown particle emitter: " + emitter);
+        }
+        return static_cast<size_t>(index);
+    }
+
+    /*!
+     * \brief Wraps engine memory in a 1-D NumPy array without copying. The array keeps owner alive.
+     */
+    template <typename T>
+    py::array_t<T> View(const T *data, size_t count, py::handle owner)
+    {
+        return py::array_t<T>({count}, {sizeof(T)}, data, owner);
+    }
+
+    /*!
+     * \brief Wraps engine memory in a read-only NumPy array without copying. The array keeps owner alive.
+     */
+    template <typename T>
+    py::array_t<T> ReadOnlyView(const T *data, std::vector<size_t> shape, py::handle owner)
+    {
+        py::array_t<T> view(shape, data, owner);
+        view.attr("setflags")(py::arg("write") = false);
+        return view;
+    }
+
+    /*!
+     * \brief Returns views of the batched state of a VectorEnv, one row per environment.
+     */
+    py::dict VectorEnvState(py::object self)
+    {
+        VectorEnv &env = self.cast<VectorEnv &>();
+        size_t n = env.GetEnvCount();
+        py::dict state;
+        state["player"] = ReadOnlyView(env.GetPlayerData(), {n, static_cast<size_t>(2)}, self);
+        state["score"] = ReadOnlyView(env.GetScoreData(), {n}, self);
+        state["reward"] = ReadOnlyView(env.GetRewardData(), {n}, self);
+        state["done"] = ReadOnlyView(env.GetDoneData(), {n}, self);
+        state["win"] = ReadOnlyView(env.GetWinData(), {n}, self);
+        state["lose"] = ReadOnlyView(env.GetLoseData(), {n}, self);
+        state["episode_ticks"] = ReadOnlyView(env.GetEpisodeTicksData(), {n}, self);
+        state["episodes"] = ReadOnlyView(env.GetEpisodesData(), {n}, self);
+        return state;
+    }
+
+    /*!
+     * \brief Times repeating timers kept in a TimerWheel against per-entity countdowns polled every tick.
+     *
+     * Both sides keep count timers with the same pseudo-random periods of 1 to 20 seconds and call the same
+     * std::function when one runs out, so the difference is only in finding the expired timers.
+     */
+    py::dict BenchmarkTimers(int count, int ticks)
+    {
+        using Clock = std::chrono::steady_clock;
+        size_t n = static_cast<size_t>(count);
+        std::vector<Uint32> periods(n);
+        Uint32 seed = 12345u;
+        for (Uint32 &period : periods)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            period = 60u + (seed >> 8) % 1141u;
+        }
+
+        Uint64 polledFires = 0;
+        std::vector<Uint32> countdowns(periods);
+        std::vector<std::function<void()>> callbacks(n, [&polledFires]()
+                                                     { polledFires++; });
+        Clock::time_point start = Clock::now();
+        for (int t = 0; t < ticks; t++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                if (--countdowns[i] == 0)
+                {
+                    countdowns[i] = periods[i];
+                    callbacks[i]();
+                }
+            }
+        }
+        double pollingMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        Uint64 wheelFires = 0;
+        TimerWheel wheel;
+        start = Clock::now();
+        for (size_t i = 0; i < n; i++)
+        {
+            wheel.Schedule(periods[i], [&wheelFires]()
+                           { wheelFires++; },
+                           periods[i]);
+        }
+        double scheduleMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        start = Clock::now();
+        wheel.Advance(static_cast<Uint32>(ticks));
+        double wheelMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        py::dict result;
+        result["polling_ms"] = pollingMs;
+        result["wheel_ms"] = wheelMs;
+        result["schedule_ms"] = scheduleMs;
+        result["polling_fires"] = polledFires;
+        result["wheel_fires"] = wheelFires;
+        return result;
+    }
+
+    /*!
+     * \brief Runs lookup threads against a writer thread and measures the lookup throughput.
+     * \param threads The number of lookup threads.
+     * \param lookups The number of lookups per thread.
+     * \param names The keys; the first half is present from the start, the writer inserts the rest while lookups run.
+     * \param find Looks a key up and returns whether it was found.
+     * \param insert Inserts a key.
+     * \return Lookups per second over all threads.
+     */
+    template <typename Find, typename Insert>
+    double TimeLookups(int threads, int lookups, const std::vector<std::string> &names, Find find, Insert insert)
+    {
+        using Clock = std::chrono::steady_clock;
+        size_t half = names.size() / 2;
+        for (size_t i = 0; i < half; i++)
+        {
+            insert(names[i]);
+        }
+
+        std::atomic<bool> go{false};
+        std::atomic<int> running{threads};
+        std::atomic<size_t> found{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads; t++)
+        {
+            readers.emplace_back([&, t]()
+                                 {
+                Uint32 seed = 977u * static_cast<Uint32>(t) + 1u;
+                size_t hits = 0;
+                while (!go.load(std::memory_order_acquire))
+                {
+                }
+                for (int i = 0; i < lookups; i++)
+                {
+                    seed = seed * 1664525u + 1013904223u;
+                    hits += find(names[(seed >> 8) % names.size()]) ? 1 : 0;
+                }
+                found.fetch_add(hits);
+                running.fetch_sub(1); });
+        }
+        // Keep inserting while the readers run, like a loader thread streaming assets in
+        std::thread writer([&]()
+                           {
+            while (!go.load(std::memory_order_acquire))
+            {
+            }
+            for (size_t i = half; i < names.size() && running.load() > 0; i++)
+            {
+                insert(names[i]);
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            } });
+
+        Clock::time_point start = Clock::now();
+        go.store(true, std::memory_order_release);
+        for (std::thread &reader : readers)
+        {
+            reader.join();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        writer.join();
+        return static_cast<double>(threads) * lookups / seconds;
+    }
+
+    /*!
+     * \brief Compares lookups in the sharded ResourceIndex with a map behind a mutex and behind a shared mutex, while
+     * a writer keeps inserting.
+     */
+    py::dict BenchmarkResourceLookups(int threads, int lookups, int keys)
+    {
+        std::vector<std::string> names;
+        for (int i = 0; i < keys; i++)
+        {
+            names.push_back("assets/sprite_" + std::to_string(i) + ".bmp");
+        }
+        int value = 0;
+
+        ResourceIndex<int *> index;
+        double indexRate = TimeLookups(
+            threads, lookups, names, [&](const std::string &key)
+            { return index.Find(key) != nullptr; },
+            [&](const std::string &key)
+            { index.Insert(key, &value); });
+
+        std::mutex mutex;
+        std::unordered_map<std::string, int *> locked;
+        double mutexRate = TimeLookups(
+            threads, lookups, names, [&](const std::string &key)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return locked.find(key) != locked.end(); },
+            [&](const std::string &key)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                locked.emplace(key, &value); });
+
+        std::shared_mutex sharedMutex;
+        std::unordered_map<std::string, int *> shared;
+        double sharedRate = TimeLookups(
+            threads, lookups, names, [&](const std::string &key)
+            {
+                std::shared_lock<std::shared_mutex> lock(sharedMutex);
+                return shared.find(key) != shared.end(); },
+            [&](const std::string &key)
+            {
+                std::unique_lock<std::shared_mutex> lock(sharedMutex);
+                shared.emplace(key, &value); });
+
+        py::dict result;
+        result["index_lookups_per_s"] = indexRate;
+        result["mutex_lookups_per_s"] = mutexRate;
+        result["shared_mutex_lookups_per_s"] = sharedRate;
+        return result;
+    }
+
+    /*!
+     * \brief Times the SpriteRasterizer against SDL's software renderer on the same frame of opaque, color-keyed and
+     * alpha-blended sprites, and measures how far their pixels differ.
+     */
+    py::dict BenchmarkBlitter(int sprites, int frames, int threads, int width, int height, int size)
+    {
+        using Clock = std::chrono::steady_clock;
+        if (sprites < 0 || frames <= 0 || width <= 0 || height <= 0 || size <= 0)
+        {
+            throw py::value_error("sprites must not be negative; frames, width, height and size must be positive");
+        }
+
+        // One image of each kind the rasterizer tells apart
+        Uint32 seed = 12345u;
+        auto random = [&seed]()
+        {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 8;
+        };
+        SDL_Surface *images[3];
+        for (int kind = 0; kind < 3; kind++)
+        {
+            images[kind] = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+            for (int y = 0; y < size; y++)
+            {
+                Uint32 *row = reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(images[kind]->pixels) + y * images[kind]->pitch);
+                for (int x = 0; x < size; x++)
+                {
+                    bool inside = (x - size / 2) * (x - size / 2) + (y - size / 2) * (y - size / 2) < size * size / 4;
+                    Uint32 alpha = kind == 0 ? 255 : kind == 1 ? (inside ? 255 : 0) : (inside ? 64 + random() % 192 : 0);
+                    row[x] = alpha << 24 | (random() & 0xFFFFFF);
+                }
+            }
+        }
+
+        SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDL_Renderer *software = SDL_CreateSoftwareRenderer(target);
+        if (software == nullptr)
+        {
+            SDL_FreeSurface(target);
+            for (SDL_Surface *image : images)
+            {
+                SDL_FreeSurface(image);
+            }
+            throw std::runtime_error(std::string("Cannot create the software renderer: ") + SDL_GetError());
+        }
+        SDL_Texture *textures[3];
+        for (int kind = 0; kind < 3; kind++)
+        {
+            textures[kind] = SDL_CreateTextureFromSurface(software, images[kind]);
+            SDL_SetTextureBlendMode(textures[kind], kind == 0 ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+        }
+
+        FramePacket packet;
+        packet.SetClearColor(40, 40, 48, 255);
+        for (int i = 0; i < sprites; i++)
+        {
+            float x = static_cast<float>(static_cast<int>(random() % (width + size)) - size);
+            float y = static_cast<float>(static_cast<int>(random() % (height + size)) - size);
+            packet.DrawSprite(textures[i % 3], SDL_FRect{x, y, static_cast<float>(size), static_cast<float>(size)});
+        }
+
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            SDL_SetRenderDrawColor(software, 40, 40, 48, 255);
+            SDL_RenderClear(software);
+            for (const SpriteDrawCommand &command : packet.GetSprites())
+            {
+                SDL_RenderCopyF(software, command.texture, nullptr, &command.destination);
+            }
+            SDL_RenderFlush(software);
+        }
+        double softwareMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+
+        auto resolve = [&](SDL_Texture *texture) -> const SDL_Surface *
+        {
+            for (int kind = 0; kind < 3; kind++)
+            {
+                if (textures[kind] == texture)
+                {
+                    return images[kind];
+                }
+            }
+            return nullptr;
+        };
+        std::string kernels = SpriteRasterizer::GetKernelName();
+        struct Run
+        {
+            const char *key;
+            const char *kernels;
+            size_t threads;
+        };
+        const Run runs[] = {{"scalar_ms", "scalar", 1}, {"simd_ms", "auto", 1}, {"simd_threaded_ms", "auto", static_cast<size_t>(std::max(threads, 0))}};
+        py::dict result;
+        result["software_ms"] = softwareMs;
+        double difference = 0.0;
+        for (const Run &run : runs)
+        {
+            SpriteRasterizer::SelectKernels(run.kernels);
+            SpriteRasterizer rasterizer(run.threads, resolve);
+            rasterizer.Render(packet, width, height);
+            start = Clock::now();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                rasterizer.Render(packet, width, height);
+            }
+            result[run.key] = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+            result["kernels"] = SpriteRasterizer::GetKernelName();
+            result["threads"] = rasterizer.GetThreadCount();
+
+            // Mean absolute difference per color channel to what SDL drew
+            Uint64 total = 0;
+            for (int y = 0; y < height; y++)
+            {
+                const Uint32 *expected = reinterpret_cast<const Uint32 *>(static_cast<const Uint8 *>(target->pixels) + y * target->pitch);
+                const Uint32 *actual = rasterizer.GetPixels() + static_cast<size_t>(y) * width;
+                for (int x = 0; x < width; x++)
+                {
+                    for (int shift = 0; shift < 24; shift += 8)
+                    {
+                        total += static_cast<Uint32>(std::abs(static_cast<int>((expected[x] >> shift) & 0xFF) - static_cast<int>((actual[x] >> shift) & 0xFF)));
+                    }
+                }
+            }
+            difference = std::max(difference, static_cast<double>(total) / (3.0 * width * height));
+        }
+        SpriteRasterizer::SelectKernels(kernels);
+        result["mean_abs_difference"] = difference;
+
+        for (SDL_Texture *texture : textures)
+        {
+            SDL_DestroyTexture(texture);
+        }
+        SDL_DestroyRenderer(software);
+        SDL_FreeSurface(target);
+        for (SDL_Surface *image : images)
+        {
+            SDL_FreeSurface(image);
+        }
+        return result;
+    }
+}
+
 PYBIND11_MODULE(mygameengine, m)
 {
+    m.def("benchmark_timers", &BenchmarkTimers, py::arg("count") = 100000, py::arg("ticks") = 3600,
+          "Times a TimerWheel against polled countdowns; see bench_timers.py");
+
+    m.def("benchmark_resource_lookups", &BenchmarkResourceLookups, py::arg("threads") = 4, py::arg("lookups") = 1000000,
+          py::arg("keys") = 256, "Lookups per second under a concurrent writer: ResourceIndex vs mutex vs shared_mutex");
+
+    m.def("benchmark_blitter", &BenchmarkBlitter, py::arg("sprites") = 2000, py::arg("frames") = 60, py::arg("threads") = 0,
+          py::arg("width") = 640, py::arg("height") = 480, py::arg("size") = 32,
+          "Milliseconds per frame: SDL's software renderer vs the SpriteRasterizer; see bench_blitter.py");
+
     py::class_<Application>(m, "Application")
         .def(py::init<int, int>(), py::arg("w"), py::arg("h"))
-        .def("loop", &Application::Loop);
-}
\ No newline at end of file
+        .def("loop", &Application::Loop)
+        .def("restart", &Application::Restart)
+        .def_property("perf_overlay", &Application::IsPerfOverlayVisible, &Application::SetPerfOverlay)
+        .def_property_readonly("startup_ms", &Application::GetStartupMs)
+        .def_property("dynamic_resolution", &Application::IsDynamicResolution, &Application::SetDynamicResolution)
+        .def_property("render_budget_ms", &Application::GetRenderBudget, &Application::SetRenderBudget)
+        .def_property_readonly("render_scale", &Application::GetRenderScale)
+        .def_property_readonly("render_ms", &Application::GetRenderMs)
+        .def("set_render_scale_limits", &Application::SetRenderScaleLimits, py::arg("min_scale"), py::arg("max_scale"))
+        .def_property_readonly("cpu_rasterizer", &Application::IsCpuRasterizer)
+        .def("set_cpu_rasterizer", &Application::SetCpuRasterizer, py::arg("enabled"), py::arg("threads") = 0)
+        .def_property("frame_capture", &Application::IsFrameCapture, &Application::SetFrameCapture)
+        .def_property("offscreen", &Application::IsOffscreen, &Application::SetOffscreen)
+        .def(
+            "capture", [](Application &app, bool wait) -> py::object
+            {
+                std::shared_ptr<const CapturedFrame> frame;
+                {
+                    py::gil_scoped_release release;
+                    frame = app.CaptureFrame(wait);
+                }
+                if (frame == nullptr)
+                {
+                    return py::none();
+                }
+                // The array holds the frame, which the render thread then never reuses
+                auto *holder = new std::shared_ptr<const CapturedFrame>(frame);
+                py::capsule owner(holder, [](void *p)
+                                  { delete static_cast<std::shared_ptr<const CapturedFrame> *>(p); });
+                py::dict result;
+                result["pixels"] = ReadOnlyView(reinterpret_cast<const Uint8 *>(frame->pixels.data()),
+                                                {static_cast<size_t>(frame->height), static_cast<size_t>(frame->width), static_cast<size_t>(4)}, owner);
+                result["index"] = frame->index;
+                return std::move(result); },
+            py::arg("wait") = true,
+            "The last captured frame as {'pixels': read-only (height, width, 4) uint8 BGRA view, 'index': frame number}, or None")
+        .def(
+            "step", [](Application &app, int ticks, bool render, std::optional<py::array_t<Uint8, py::array::c_style | py::array::forcecast>> actions, float dt)
+            {
+                if (ticks < 0)
+                {
+                    throw py::value_error("ticks must not be negative");
+                }
+                size_t actionCount = actions ? static_cast<size_t>(actions->size()) : 0;
+                if (actionCount > 1 && actionCount != static_cast<size_t>(ticks))
+                {
+                    throw py::value_error("actions must hold one action or one per tick");
+                }
+                const Uint8 *actionData = actions ? actions->data() : nullptr;
+
+                size_t n = static_cast<size_t>(ticks);
+                py::array_t<float> player({n, static_cast<size_t>(2)});
+                py::array_t<float> score(n);
+                py::array_t<float> reward(n);
+                py::array_t<Uint8> win(n);
+                py::array_t<Uint8> lose(n);
+                StepOutputs outputs;
+                outputs.player = player.mutable_data();
+                outputs.score = score.mutable_data();
+                outputs.reward = reward.mutable_data();
+                outputs.win = win.mutable_data();
+                outputs.lose = lose.mutable_data();
+
+                int stepped;
+                {
+                    py::gil_scoped_release release;
+                    stepped = app.Step(ticks, render, dt, actionData, actionCount, outputs);
+                }
+
+                py::slice done(0, stepped, 1);
+                py::dict result;
+                result["ticks"] = stepped;
+                result["player"] = player[done];
+                result["score"] = score[done];
+                result["reward"] = reward[done];
+                result["win"] = win[done].attr("astype")("bool");
+                result["lose"] = lose[done].attr("astype")("bool");
+                return result; },
+            py::arg("n_ticks"), py::arg("render") = false, py::arg("actions") = py::none(), py::arg("dt") = 1.0f / 60.0f)
+        // Views share memory with the engine and keep it alive. They follow the group until it grows past its
+        // reserved capacity, is restored to more instances or the level changes; entities_generation tells when.
+        .def(
+            "entities", [](Application &app, const std::string &group)
+            {
+                std::shared_ptr<InstanceStorage> storage = GetGroup(app, group).GetStorage();
+                auto *holder = new std::shared_ptr<InstanceStorage>(storage);
+                py::capsule owner(holder, [](void *p)
+                                  { delete static_cast<std::shared_ptr<InstanceStorage> *>(p); });
+                size_t count = storage->x.size();
+                py::dict views;
+                views["x"] = View(storage->x.data(), count, owner);
+                views["y"] = View(storage->y.data(), count, owner);
+                views["renderable"] = View(storage->renderable.data(), count, owner);
+                // The engine trusts both: kinds index the prototype registry and states mirror the live and free lists
+                views["kind"] = ReadOnlyView(storage->prototypes.data(), {count}, owner);
+                views["state"] = ReadOnlyView(storage->states.data(), {count}, owner);
+                return views; },
+            py::arg("group"))
+        .def(
+            "entities_generation", [](Application &app, const std::string &group)
+            { return GetGroup(app, group).GetStorageGeneration(); },
+            py::arg("group"), "Changes whenever views returned by entities stop following the group; fetch them again then")
+        .def(
+            "prototype_sizes", [](Application &)
+            {
+                // A copy: registering prototypes for a later level reallocates the registry
+                const PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+                py::array_t<float> sizes({registry.Size(), static_cast<size_t>(2)});
+                auto out = sizes.mutable_unchecked<2>();
+                for (size_t i = 0; i < registry.Size(); i++)
+                {
+                    const SpritePrototype &prototype = registry.Get(static_cast<Uint16>(i));
+                    out(i, 0) = prototype.width;
+                    out(i, 1) = prototype.height;
+                }
+                return sizes; })
+        .def("prototype_names", [](Application &)
+             {
+                const PrototypeRegistry &registry = PrototypeRegistry::GetInstance();
+                std::vector<std::string> names;
+                for (size_t i = 0; i < registry.Size(); i++)
+                {
+                    names.push_back(registry.Get(static_cast<Uint16>(i)).name);
+                }
+                return names; })
+        .def(
+            "spawn", [](Application &app, const std::string &group, py::array_t<float, py::array::c_style | py::array::forcecast> xs, py::array_t<float, py::array::c_style | py::array::forcecast> ys, int kind, std::optional<float> gravityScale)
+            {
+                SpriteInstances &instances = GetGroup(app, group);
+                if (xs.size() != ys.size())
+                {
+                    throw py::value_error("xs and ys must have the same length");
+                }
+                if (kind < 0)
+                {
+                    kind = app.GetGroupPrototype(group);
+                }
+                if (kind < 0 || static_cast<size_t>(kind) >= PrototypeRegistry::GetInstance().Size())
+                {
+                    throw py::value_error("Unknown prototype index");
+                }
+                // Dead slots are reused, so the new instances are not necessarily at the end
+                py::array_t<Uint32> indices(xs.size());
+                instances.SpawnMany(static_cast<Uint16>(kind), xs.data(), ys.data(), static_cast<size_t>(xs.size()), indices.mutable_data());
+                if (gravityScale)
+                {
+                    // Give the new instances bodies so the scene's physics moves them
+                    const Uint32 *spawned = indices.data();
+                    for (py::ssize_t i = 0; i < indices.size(); i++)
+                    {
+                        instances.EnablePhysics(spawned[i], *gravityScale);
+                    }
+                }
+                return indices; },
+            py::arg("group"), py::arg("xs"), py::arg("ys"), py::arg("kind") = -1, py::arg("gravity_scale") = py::none())
+        // Scene graph nodes are handles; world positions are brought up to date by the next tick
+        .def(
+            "add_node", [](Application &app, std::optional<Uint32> parent, float x, float y, int kind)
+            {
+                SceneGraph &graph = GetGraph(app);
+                if (kind >= 0 && static_cast<size_t>(kind) >= PrototypeRegistry::GetInstance().Size())
+                {
+                    throw py::value_error("Unknown prototype index");
+                }
+                Uint32 node = graph.Add(parent ? GetNode(graph, *parent) : SceneGraph::kNoNode, x, y,
+                                        kind < 0 ? SceneGraph::kNoPrototype : static_cast<Uint16>(kind));
+                return node; },
+            py::arg("parent") = py::none(), py::arg("x") = 0.0f, py::arg("y") = 0.0f, py::arg("kind") = -1,
+            "Adds a scene graph node; kind is a prototype index, or -1 for a node that only groups its children")
+        .def(
+            "remove_node", [](Application &app, Uint32 node)
+            {
+                SceneGraph &graph = GetGraph(app);
+                graph.Remove(GetNode(graph, node)); },
+            py::arg("node"))
+        .def(
+            "set_node_parent", [](Application &app, Uint32 node, std::optional<Uint32> parent)
+            {
+                SceneGraph &graph = GetGraph(app);
+                if (!graph.SetParent(GetNode(graph, node), parent ? GetNode(graph, *parent) : SceneGraph::kNoNode))
+                {
+                    throw py::value_error("A node cannot become a child of its own subtree");
+                } },
+            py::arg("node"), py::arg("parent") = py::none())
+        .def(
+            "move_node", [](Application &app, Uint32 node, float x, float y)
+            {
+                SceneGraph &graph = GetGraph(app);
+                graph.SetPosition(GetNode(graph, node), x, y); },
+            py::arg("node"), py::arg("x"), py::arg("y"))
+        .def(
+            "scale_node", [](Application &app, Uint32 node, float scaleX, float scaleY)
+            {
+                SceneGraph &graph = GetGraph(app);
+                graph.SetScale(GetNode(graph, node), scaleX, scaleY); },
+            py::arg("node"), py::arg("scale_x"), py::arg("scale_y"))
+        .def(
+            "set_node_visible", [](Application &app, Uint32 node, bool visible)
+            {
+                SceneGraph &graph = GetGraph(app);
+                graph.SetVisible(GetNode(graph, node), visible); },
+            py::arg("node"), py::arg("visible"))
+        .def(
+            "node_rectangle", [](Application &app, Uint32 node)
+            {
+                SceneGraph &graph = GetGraph(app);
+                SDL_FRect rectangle = graph.GetRectangle(GetNode(graph, node));
+                return py::make_tuple(rectangle.x, rectangle.y, rectangle.w, rectangle.h); },
+            py::arg("node"), "The node's world rectangle (x, y, w, h) as of the last tick")
+        .def(
+            "despawn", [](Application &app, const std::string &group, py::array_t<Uint32, py::array::c_style | py::array::forcecast> indices)
+            {
+                SpriteInstances &instances = GetGroup(app, group);
+                return instances.DespawnMany(indices.data(), static_cast<size_t>(indices.size())); },
+            py::arg("group"), py::arg("indices"), "Kills instances; the others keep their indices. Returns the live count")
+        .def(
+            "reserve", [](Application &app, const std::string &group, size_t capacity)
+            { GetGroup(app, group).Reserve(capacity); },
+            py::arg("group"), py::arg("capacity"))
+        .def(
+            "emit_particles", [](Application &app, const std::string &emitter, float x, float y, size_t count)
+            {
+                size_t index = GetEmitter(app, emitter);
+                return app.GetParticles()->Emit(index, x, y, count); },
+            py::arg("emitter"), py::arg("x"), py::arg("y"), py::arg("count"))
+        .def(
+            "reserve_particles", [](Application &app, const std::string &emitter, size_t capacity)
+            {
+                size_t index = GetEmitter(app, emitter);
+                app.GetParticles()->SetCapacity(index, capacity); },
+            py::arg("emitter"), py::arg("capacity"))
+        .def("audio_stats", [](Application &)
+             {
+                AudioStats stats = AudioMixer::GetInstance().GetStats();
+                py::dict result;
+                result["running"] = AudioMixer::GetInstance().IsRunning();
+                result["callbacks"] = stats.callbacks;
+                result["underruns"] = stats.underruns;
+                result["dropped_commands"] = stats.droppedCommands;
+                result["last_mix_us"] = stats.lastMixMicros;
+                result["max_mix_us"] = stats.maxMixMicros;
+                result["avg_mix_us"] = stats.averageMixMicros;
+                result["buffer_us"] = stats.bufferMicros;
+                result["active_voices"] = stats.activeVoices;
+                return result; })
+        .def(
+            "play_sound", [](Application &, const std::string &filename, float volume, float pan)
+            {
+                AudioMixer &mixer = AudioMixer::GetInstance();
+                return mixer.Play(mixer.LoadSound(filename), volume, pan); },
+            py::arg("filename"), py::arg("volume") = 1.0f, py::arg("pan") = 0.0f)
+        .def_property_readonly("particle_count", [](Application &app)
+                               {
+                ParticleSystem *particles = app.GetParticles();
+                return particles ? particles->GetLiveCount() : static_cast<size_t>(0); });
+
+    // Independent headless copies of a level, stepped in parallel. The state views are allocated once and
+    // overwritten in place by every step and reset, so they can be fetched once and kept.
+    py::class_<VectorEnv>(m, "VectorEnv")
+        .def(py::init<size_t, int, size_t>(), py::arg("num_envs"), py::arg("level") = 0, py::arg("num_threads") = 0)
+        .def_property_readonly("num_envs", &VectorEnv::GetEnvCount)
+        .def_property_readonly("num_threads", &VectorEnv::GetThreadCount)
+        .def(
+            "reset", [](py::object self)
+            {
+                VectorEnv &env = self.cast<VectorEnv &>();
+                {
+                    py::gil_scoped_release release;
+                    env.Reset();
+                }
+                return VectorEnvState(self); })
+        .def(
+            "step", [](py::object self, std::optional<py::array_t<Uint8, py::array::c_style | py::array::forcecast>> actions, int ticks, float dt)
+            {
+                VectorEnv &env = self.cast<VectorEnv &>();
+                if (ticks < 0)
+                {
+                    throw py::value_error("n_ticks must not be negative");
+                }
+                if (actions && static_cast<size_t>(actions->size()) != env.GetEnvCount())
+                {
+                    throw py::value_error("actions must hold one action per environment");
+                }
+                const Uint8 *actionData = actions ? actions->data() : nullptr;
+                {
+                    py::gil_scoped_release release;
+                    env.Step(actionData, ticks, dt);
+                }
+                return VectorEnvState(self); },
+            py::arg("actions") = py::none(), py::arg("n_ticks") = 1, py::arg("dt") = 1.0f / 60.0f)
+        .def("state", &VectorEnvState);
+}